@@ -0,0 +1,146 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#include "bench.hpp"
+
+#include <crossguid/batch.hpp>
+#include <crossguid/guid.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bench {
+    namespace {
+        const std::size_t rows = std::size_t{1} << 20;
+
+        const std::vector<xg::guid>& column()
+        {
+            static const std::vector<xg::guid> v = [] {
+                std::vector<xg::guid> guids(rows);
+                xg::make_guids(guids.data(), guids.size());
+                return guids;
+            }();
+            return v;
+        }
+
+        const std::string& column_text()
+        {
+            static const std::string s = [] {
+                std::string text(rows * 36, ' ');
+                xg::format_batch(column().data(), rows, &text[0], 36);
+                return text;
+            }();
+            return s;
+        }
+
+        std::string threads_suffix(unsigned threads)
+        {
+            return ", " + std::to_string(threads) +
+                   (threads == 1 ? " thread" : " threads");
+        }
+    }  // namespace
+
+    void register_batch(registry& r)
+    {
+        r.add("per-row guid(const char*) 1M rows", [](std::size_t n) {
+            const auto& text = column_text();
+            std::string row(36, ' ');
+            std::vector<xg::guid> out(rows);
+            for (std::size_t i = 0; i < n; ++i) {
+                for (std::size_t j = 0; j < rows; ++j) {
+                    row.assign(text, j * 36, 36);
+                    out[j] = xg::guid{row.c_str()};
+                }
+                do_not_optimize(out.back());
+            }
+        });
+        r.add("per-row str() 1M rows", [](std::size_t n) {
+            const auto& in = column();
+            std::string text(rows * 36, ' ');
+            for (std::size_t i = 0; i < n; ++i) {
+                for (std::size_t j = 0; j < rows; ++j) {
+                    text.replace(j * 36, 36, in[j].str());
+                }
+                do_not_optimize(text[0]);
+            }
+        });
+        r.add("per-row to_ms_bytes 1M rows", [](std::size_t n) {
+            const auto& in = column();
+            std::vector<unsigned char> out(rows * 16);
+            for (std::size_t i = 0; i < n; ++i) {
+                for (std::size_t j = 0; j < rows; ++j) {
+                    const auto b = xg::to_ms_bytes(in[j]);
+                    std::copy(b.begin(), b.end(), &out[16 * j]);
+                }
+                do_not_optimize(out[0]);
+            }
+        });
+        r.add("to_ms_bytes 1M rows", [](std::size_t n) {
+            const auto& in = column();
+            std::vector<unsigned char> out(rows * 16);
+            for (std::size_t i = 0; i < n; ++i) {
+                xg::to_ms_bytes(in.data(), rows, out.data());
+                do_not_optimize(out[0]);
+            }
+        });
+        r.add("from_ms_bytes 1M rows, in place", [](std::size_t n) {
+            auto guids = column();
+            auto* bytes = static_cast<const unsigned char*>(
+                static_cast<const void*>(guids.data()));
+            for (std::size_t i = 0; i < n; ++i) {
+                xg::from_ms_bytes(bytes, rows, guids.data());
+                do_not_optimize(guids[0]);
+            }
+        });
+
+        for (auto threads : thread_counts()) {
+            xg::batch_options options;
+            options.threads = threads;
+
+            r.add("parse_batch 1M rows" + threads_suffix(threads),
+                  [options](std::size_t n) {
+                      const auto& text = column_text();
+                      std::vector<xg::guid> out(rows);
+                      std::vector<std::uint8_t> valid(rows / 8);
+                      for (std::size_t i = 0; i < n; ++i) {
+                          do_not_optimize(xg::parse_batch(
+                              text.data(), 36, rows, out.data(), valid.data(),
+                              options));
+                      }
+                  });
+            r.add("format_batch 1M rows" + threads_suffix(threads),
+                  [options](std::size_t n) {
+                      const auto& in = column();
+                      std::string text(rows * 36, ' ');
+                      for (std::size_t i = 0; i < n; ++i) {
+                          xg::format_batch(in.data(), rows, &text[0], 36,
+                                           xg::format_flags::none, options);
+                          do_not_optimize(text[0]);
+                      }
+                  });
+        }
+    }
+}  // namespace bench
@@ -0,0 +1,111 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+// A minimal benchmark harness, so that crossguid_bench has no dependencies
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace bench {
+    /// Keeps the compiler from optimizing away the computation of `value`.
+    template <typename T>
+    inline void do_not_optimize(const T& value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        const volatile char sink =
+            *reinterpret_cast<const volatile char*>(&value);
+        static_cast<void>(sink);
+#endif
+    }
+
+    /// Performs the measured operation `n` times.
+    /// Multi-threaded benchmarks call it from every thread at once.
+    using function = std::function<void(std::size_t n)>;
+
+    struct benchmark {
+        std::string name;
+        function fn;
+        unsigned threads;
+    };
+
+    /// A quantity that isn't a time, like memory usage, measured once.
+    struct metric {
+        std::string name;
+        std::function<double()> measure;
+        std::string unit;
+    };
+
+    class registry {
+    public:
+        void add(std::string name, function fn, unsigned threads = 1)
+        {
+            _benchmarks.push_back(
+                benchmark{std::move(name), std::move(fn), threads});
+        }
+
+        void add_metric(std::string name,
+                        std::function<double()> measure,
+                        std::string unit)
+        {
+            _metrics.push_back(
+                metric{std::move(name), std::move(measure), std::move(unit)});
+        }
+
+        const std::vector<benchmark>& all() const
+        {
+            return _benchmarks;
+        }
+
+        const std::vector<metric>& metrics() const
+        {
+            return _metrics;
+        }
+
+    private:
+        std::vector<benchmark> _benchmarks;
+        std::vector<metric> _metrics;
+    };
+
+    /// 1, 2, 4, ... up to and including the number of hardware threads.
+    std::vector<unsigned> thread_counts();
+
+    void register_generate(registry& r);
+    void register_parse(registry& r);
+    void register_format(registry& r);
+    void register_compare(registry& r);
+    void register_containers(registry& r);
+    void register_scan(registry& r);
+    void register_batch(registry& r);
+    void register_encoding(registry& r);
+    void register_sort(registry& r);
+    void register_index(registry& r);
+    void register_column(registry& r);
+    void register_filter(registry& r);
+    void register_concurrent(registry& r);
+}  // namespace bench
@@ -0,0 +1,92 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#include "bench.hpp"
+
+#include <crossguid/guid.hpp>
+#include <crossguid/guid_column.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace bench {
+    namespace {
+        const char* path = "crossguid_bench_column.bin";
+        const std::size_t entries = std::size_t{1} << 22;
+
+        // Written on first use, so that filtered out benchmarks cost nothing
+        const std::vector<xg::guid>& written()
+        {
+            static const std::vector<xg::guid> v = [] {
+                std::vector<xg::guid> tmp(entries);
+                xg::make_guids(tmp.data(), tmp.size());
+                xg::guid_column_writer writer{path};
+                writer.append(tmp.data(), tmp.data() + tmp.size());
+                writer.close();
+                std::atexit([] { std::remove(path); });
+                return tmp;
+            }();
+            return v;
+        }
+    }  // namespace
+
+    void register_column(registry& r)
+    {
+        // Per GUID, in batches of 4096, starting a new file after every
+        // 4M GUIDs so that the file stays in the page cache
+        r.add("xg::guid_column_writer append", [](std::size_t n) {
+            const auto& v = written();
+            const std::string tmp = std::string{path} + ".tmp";
+            for (std::size_t i = 0; i < n; i += v.size()) {
+                xg::guid_column_writer writer{tmp.c_str()};
+                const auto count = std::min(v.size(), n - i);
+                for (std::size_t j = 0; j < count; j += 4096) {
+                    writer.append(v.data() + j,
+                                  v.data() + std::min(j + 4096, count));
+                }
+                writer.close();
+            }
+            std::remove(tmp.c_str());
+        });
+        // Opening a file of 4M GUIDs, and reading one
+        r.add("xg::guid_column open", [](std::size_t n) {
+            written();
+            for (std::size_t i = 0; i < n; ++i) {
+                const xg::guid_column column{path};
+                do_not_optimize(column[i % column.size()]);
+            }
+        });
+        // Per GUID
+        r.add("xg::guid_column verify", [](std::size_t n) {
+            written();
+            const xg::guid_column column{path};
+            for (std::size_t i = 0; i < n; i += column.size()) {
+                do_not_optimize(column.verify());
+            }
+        });
+    }
+}  // namespace bench
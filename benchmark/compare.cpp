@@ -0,0 +1,125 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#include "bench.hpp"
+
+#include <crossguid/batch.hpp>
+#include <crossguid/guid.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <string>
+
+namespace bench {
+    namespace {
+        std::vector<xg::guid> random_guids()
+        {
+            std::vector<xg::guid> v(1024);
+            xg::make_guids(v.data(), v.size());
+            return v;
+        }
+    }  // namespace
+
+    void register_compare(registry& r)
+    {
+        const auto guids = random_guids();
+        // Equal except for the last byte, so that comparisons can't exit
+        // early
+        auto near = guids;
+        for (auto& g : near) {
+            auto bytes = g.bytes();
+            bytes[15] = static_cast<unsigned char>(bytes[15] ^ 1);
+            g = xg::guid{bytes};
+        }
+
+        r.add("std::hash<xg::guid>", [guids](std::size_t n) {
+            std::hash<xg::guid> hash;
+            for (std::size_t i = 0; i < n; ++i) {
+                do_not_optimize(hash(guids[i % guids.size()]));
+            }
+        });
+        r.add("xg::fold_hash", [guids](std::size_t n) {
+            xg::fold_hash hash;
+            for (std::size_t i = 0; i < n; ++i) {
+                do_not_optimize(hash(guids[i % guids.size()]));
+            }
+        });
+        r.add("xg::mix_hash", [guids](std::size_t n) {
+            xg::mix_hash hash;
+            for (std::size_t i = 0; i < n; ++i) {
+                do_not_optimize(hash(guids[i % guids.size()]));
+            }
+        });
+        r.add("operator==", [guids, near](std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i) {
+                const auto j = i % guids.size();
+                do_not_optimize(guids[j] == near[j]);
+            }
+        });
+        r.add("std::less<xg::guid>", [guids, near](std::size_t n) {
+            std::less<xg::guid> less;
+            for (std::size_t i = 0; i < n; ++i) {
+                const auto j = i % guids.size();
+                do_not_optimize(less(guids[j], near[j]));
+            }
+        });
+        r.add("operator<", [guids, near](std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i) {
+                const auto j = i % guids.size();
+                do_not_optimize(guids[j] < near[j]);
+            }
+        });
+        r.add("operator bool", [guids](std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i) {
+                do_not_optimize(static_cast<bool>(guids[i % guids.size()]));
+            }
+        });
+
+        // Membership in small sets, the key at the end
+        for (std::size_t size : {8u, 64u, 1024u}) {
+            const std::vector<xg::guid> set(
+                near.begin(),
+                near.begin() + static_cast<std::ptrdiff_t>(size));
+            const auto key = set.back();
+            const auto suffix = " " + std::to_string(size) + " GUIDs";
+            r.add("xg::find" + suffix, [set, key](std::size_t n) {
+                for (std::size_t i = 0; i < n; ++i) {
+                    do_not_optimize(
+                        xg::find(set.data(), set.data() + set.size(), key));
+                }
+            });
+            r.add("xg::count" + suffix, [set, key](std::size_t n) {
+                for (std::size_t i = 0; i < n; ++i) {
+                    do_not_optimize(
+                        xg::count(set.data(), set.data() + set.size(), key));
+                }
+            });
+            r.add("std::find" + suffix, [set, key](std::size_t n) {
+                for (std::size_t i = 0; i < n; ++i) {
+                    do_not_optimize(std::find(set.begin(), set.end(), key));
+                }
+            });
+        }
+    }
+}  // namespace bench
@@ -0,0 +1,247 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#include "bench.hpp"
+
+#include <crossguid/concurrent_guid_map.hpp>
+#include <crossguid/guid.hpp>
+#include <crossguid/guid_interner.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace bench {
+    namespace {
+        const std::size_t entries = std::size_t{1} << 20;
+
+        // The value of a registry of sessions
+        using value_type = std::uintptr_t;
+
+        const std::vector<xg::guid>& keys()
+        {
+            static const std::vector<xg::guid> k = [] {
+                std::vector<xg::guid> v(entries);
+                xg::make_guids(v.data(), v.size());
+                return v;
+            }();
+            return k;
+        }
+
+        // The map being replaced: std::unordered_map behind one mutex
+        struct locked_map {
+            std::mutex mutex;
+            std::unordered_map<xg::guid, value_type> map;
+
+            bool find(const xg::guid& key, value_type& out)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                const auto it = map.find(key);
+                if (it == map.end()) {
+                    return false;
+                }
+                out = it->second;
+                return true;
+            }
+
+            void toggle(const xg::guid& key, value_type value)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (map.erase(key) == 0) {
+                    map.emplace(key, value);
+                }
+            }
+        };
+
+        struct concurrent_map {
+            xg::concurrent_guid_map<value_type> map;
+
+            bool find(const xg::guid& key, value_type& out)
+            {
+                return map.find(key, out);
+            }
+
+            void toggle(const xg::guid& key, value_type value)
+            {
+                if (!map.erase(key)) {
+                    map.insert(key, value);
+                }
+            }
+        };
+
+        // Both maps start with every key, built on first use, so that
+        // filtered out benchmarks cost nothing
+        template <typename Map>
+        Map& preloaded()
+        {
+            static Map m;
+            static std::once_flag once;
+            std::call_once(once, [] {
+                const auto& k = keys();
+                for (std::size_t i = 0; i < k.size(); ++i) {
+                    m.toggle(k[i], i);
+                }
+            });
+            return m;
+        }
+
+        // `n` operations on random keys, `write_percent` percent of which
+        // erase the key if it's present and insert it otherwise
+        template <typename Map>
+        void mix(std::size_t n, unsigned write_percent)
+        {
+            auto& m = preloaded<Map>();
+            const auto& k = keys();
+            thread_local std::uint64_t state =
+                0x9e3779b97f4a7c15 *
+                (1 + std::hash<std::thread::id>{}(std::this_thread::get_id()));
+            std::size_t found = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                // xorshift64
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                const auto& key = k[state & (entries - 1)];
+                if ((state >> 32) % 100 < write_percent) {
+                    m.toggle(key, i);
+                }
+                else {
+                    value_type v;
+                    found += m.find(key, v);
+                }
+            }
+            do_not_optimize(found);
+        }
+
+        // A different GUID for every `i`, faster to make than a random one
+        xg::guid distinct_guid(std::uint64_t i)
+        {
+            std::array<unsigned char, 16> b;
+            const auto hi = i * 0x9e3779b97f4a7c15;
+            for (unsigned j = 0; j < 8; ++j) {
+                b[j] = static_cast<unsigned char>(hi >> (8 * j));
+                b[8 + j] = static_cast<unsigned char>(i >> (8 * j));
+            }
+            return xg::guid{b};
+        }
+
+        // Every key interned, in order
+        xg::guid_interner& interner()
+        {
+            static xg::guid_interner in(entries);
+            static std::once_flag once;
+            std::call_once(once, [] {
+                for (const auto& g : keys()) {
+                    in.intern(g);
+                }
+            });
+            return in;
+        }
+
+        // Past the hardware threads too: how both degrade when threads are
+        // preempted, holding the lock or not, matters for a server
+        std::vector<unsigned> mix_thread_counts()
+        {
+            std::vector<unsigned> counts;
+            for (unsigned n = 1; n <= 64; n *= 2) {
+                counts.push_back(n);
+            }
+            for (auto n : thread_counts()) {
+                if (n > 64) {
+                    counts.push_back(n);
+                }
+            }
+            return counts;
+        }
+    }  // namespace
+
+    void register_concurrent(registry& r)
+    {
+        const unsigned write_percents[] = {0, 10, 50};
+        for (auto w : write_percents) {
+            const auto suffix = " " + std::to_string(100 - w) + "/" +
+                                std::to_string(w) + " r/w";
+            for (auto threads : mix_thread_counts()) {
+                r.add("unordered_map + mutex" + suffix,
+                      [w](std::size_t n) { mix<locked_map>(n, w); }, threads);
+            }
+            for (auto threads : mix_thread_counts()) {
+                r.add("xg::concurrent_guid_map" + suffix,
+                      [w](std::size_t n) { mix<concurrent_map>(n, w); },
+                      threads);
+            }
+        }
+
+        for (auto threads : thread_counts()) {
+            r.add("xg::guid_interner::intern, interned", [](std::size_t n) {
+                auto& in = interner();
+                const auto& k = keys();
+                for (std::size_t i = 0; i < n; ++i) {
+                    do_not_optimize(in.intern(k[(i * 7919) & (entries - 1)]));
+                }
+            }, threads);
+        }
+        r.add("xg::guid_interner::intern, new", [](std::size_t n) {
+            // One interner growing over the runs, rather than one per run
+            // that would mostly measure its construction
+            static xg::guid_interner in;
+            static std::uint64_t next = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                do_not_optimize(in.intern(distinct_guid(next++)));
+            }
+        });
+        for (auto threads : thread_counts()) {
+            r.add("xg::guid_interner::operator[]", [](std::size_t n) {
+                auto& in = interner();
+                for (std::size_t i = 0; i < n; ++i) {
+                    const auto h = static_cast<std::uint32_t>(
+                        (i * 7919) & (entries - 1));
+                    do_not_optimize(in[h]);
+                }
+            }, threads);
+        }
+        r.add("xg::guid_interner::resolve, per handle",
+              [](std::size_t n) {
+                  auto& in = interner();
+                  std::vector<std::uint32_t> handles(4096);
+                  for (std::size_t i = 0; i < handles.size(); ++i) {
+                      handles[i] = static_cast<std::uint32_t>(
+                          (i * 7919) & (entries - 1));
+                  }
+                  std::vector<xg::guid> out(handles.size());
+                  while (n > 0) {
+                      const auto len = std::min(n, handles.size());
+                      in.resolve(handles.data(), len, out.data());
+                      do_not_optimize(out.front());
+                      n -= len;
+                  }
+              });
+    }
+}  // namespace bench
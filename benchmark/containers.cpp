@@ -0,0 +1,237 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#include "bench.hpp"
+
+#include <crossguid/guid.hpp>
+#include <crossguid/guid_map.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace bench {
+    namespace {
+        // Bytes currently allocated through counting_allocator
+        std::size_t allocated_bytes = 0;
+
+        template <typename T>
+        struct counting_allocator {
+            using value_type = T;
+
+            counting_allocator() = default;
+            template <typename U>
+            counting_allocator(const counting_allocator<U>&) noexcept
+            {
+            }
+
+            T* allocate(std::size_t n)
+            {
+                allocated_bytes += n * sizeof(T);
+                return std::allocator<T>{}.allocate(n);
+            }
+            void deallocate(T* p, std::size_t n) noexcept
+            {
+                allocated_bytes -= n * sizeof(T);
+                std::allocator<T>{}.deallocate(p, n);
+            }
+
+            friend bool operator==(const counting_allocator&,
+                                   const counting_allocator&) noexcept
+            {
+                return true;
+            }
+            friend bool operator!=(const counting_allocator&,
+                                   const counting_allocator&) noexcept
+            {
+                return false;
+            }
+        };
+
+        using value_type = std::pair<const xg::guid, std::size_t>;
+        using std_map = std::unordered_map<xg::guid,
+                                           std::size_t,
+                                           std::hash<xg::guid>,
+                                           std::equal_to<xg::guid>,
+                                           counting_allocator<value_type>>;
+        using fold_map = xg::guid_map<std::size_t,
+                                      xg::fold_hash,
+                                      counting_allocator<value_type>>;
+        using mix_map = xg::guid_map<std::size_t,
+                                     xg::mix_hash,
+                                     counting_allocator<value_type>>;
+
+        // Large enough that the tables don't fit in the cache
+        const std::size_t entries = std::size_t{1} << 20;
+
+        struct key_sets {
+            std::vector<xg::guid> present;
+            // The same keys in another order, so that lookups don't walk
+            // the memory in the order the elements were allocated
+            std::vector<xg::guid> shuffled;
+            std::vector<xg::guid> absent;
+            std::vector<std::string> strings;
+        };
+
+        // Built on first use, so that filtered out benchmarks cost nothing
+        const key_sets& keys()
+        {
+            static const key_sets k = [] {
+                key_sets s;
+                s.present.resize(entries);
+                s.absent.resize(entries);
+                xg::make_guids(s.present.data(), entries);
+                xg::make_guids(s.absent.data(), entries);
+                s.shuffled = s.present;
+                std::shuffle(s.shuffled.begin(), s.shuffled.end(),
+                             std::mt19937{42});
+                for (std::size_t i = 0; i < entries / 16; ++i) {
+                    s.strings.push_back(s.present[i * 16].str());
+                }
+                return s;
+            }();
+            return k;
+        }
+
+        template <typename Map>
+        void fill(Map& m)
+        {
+            const auto& k = keys().present;
+            for (std::size_t i = 0; i < k.size(); ++i) {
+                m.insert(value_type{k[i], i});
+            }
+        }
+
+        template <typename Map>
+        const Map& filled()
+        {
+            static const Map m = [] {
+                Map tmp;
+                fill(tmp);
+                return tmp;
+            }();
+            return m;
+        }
+
+        // A map reserved once for all of the keys, which inserts continue
+        // filling across calls, and which is cleared once they're all in
+        template <typename Map>
+        struct reserved_map {
+            reserved_map()
+            {
+                map.reserve(entries);
+            }
+
+            Map map;
+            std::size_t next{0};
+        };
+
+        template <typename Map>
+        reserved_map<Map>& reserved()
+        {
+            static reserved_map<Map> m;
+            return m;
+        }
+
+        template <typename Map>
+        void register_map(registry& r, const std::string& name)
+        {
+            // Includes growing the table from empty
+            r.add(name + " insert", [](std::size_t n) {
+                const auto& k = keys().present;
+                Map m;
+                for (std::size_t i = 0; i < n; ++i) {
+                    const auto j = i % k.size();
+                    if (j == 0 && i != 0) {
+                        m = Map{};
+                    }
+                    m.insert(value_type{k[j], i});
+                }
+                do_not_optimize(m.size());
+            });
+            // Without growing, so it's just the probing and the stores
+            r.add(name + " insert reserved", [](std::size_t n) {
+                const auto& k = keys().present;
+                auto& m = reserved<Map>();
+                for (std::size_t i = 0; i < n; ++i) {
+                    if (m.next == k.size()) {
+                        m.map.clear();
+                        m.next = 0;
+                    }
+                    m.map.insert(value_type{k[m.next], i});
+                    ++m.next;
+                }
+                do_not_optimize(m.map.size());
+            });
+            r.add(name + " find hit", [](std::size_t n) {
+                const auto& k = keys().shuffled;
+                const auto& m = filled<Map>();
+                for (std::size_t i = 0; i < n; ++i) {
+                    do_not_optimize(m.find(k[i % k.size()])->second);
+                }
+            });
+            r.add(name + " find miss", [](std::size_t n) {
+                const auto& k = keys().absent;
+                const auto& m = filled<Map>();
+                for (std::size_t i = 0; i < n; ++i) {
+                    do_not_optimize(m.find(k[i % k.size()]) == m.end());
+                }
+            });
+            r.add_metric(name + " memory per entry", [] {
+                const auto before = allocated_bytes;
+                Map m;
+                fill(m);
+                return static_cast<double>(allocated_bytes - before) /
+                       static_cast<double>(m.size());
+            }, "bytes");
+        }
+    }  // namespace
+
+    void register_containers(registry& r)
+    {
+        register_map<std_map>(r, "std::unordered_map");
+        register_map<fold_map>(r, "xg::guid_map");
+        register_map<mix_map>(r, "xg::guid_map<mix_hash>");
+
+        r.add("std::unordered_map find string", [](std::size_t n) {
+            const auto& s = keys().strings;
+            const auto& m = filled<std_map>();
+            for (std::size_t i = 0; i < n; ++i) {
+                const xg::guid g{s[i % s.size()].c_str()};
+                do_not_optimize(m.find(g)->second);
+            }
+        });
+        r.add("xg::guid_map find string", [](std::size_t n) {
+            const auto& s = keys().strings;
+            const auto& m = filled<fold_map>();
+            for (std::size_t i = 0; i < n; ++i) {
+                do_not_optimize(m.find(s[i % s.size()])->second);
+            }
+        });
+    }
+}  // namespace bench
@@ -0,0 +1,70 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#include "bench.hpp"
+
+#include <crossguid/encoding.hpp>
+#include <crossguid/guid.hpp>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench {
+    void register_encoding(registry& r)
+    {
+        std::vector<xg::guid> guids(1024);
+        xg::make_guids(guids.data(), guids.size());
+
+        const std::pair<const char*, xg::encoding> encodings[] = {
+            {"base64url", xg::encoding::base64url},
+            {"base32", xg::encoding::base32},
+            {"base58", xg::encoding::base58}};
+
+        for (const auto& e : encodings) {
+            const auto encoding = e.second;
+            r.add(std::string{"encode_to(char*) "} + e.first,
+                  [guids, encoding](std::size_t n) {
+                      char buf[26];
+                      for (std::size_t i = 0; i < n; ++i) {
+                          xg::encode_to(guids[i % guids.size()], encoding, buf);
+                          do_not_optimize(buf);
+                      }
+                  });
+
+            std::vector<std::string> encoded;
+            for (const auto& g : guids) {
+                encoded.push_back(xg::encode(g, encoding));
+            }
+            r.add(std::string{"decode "} + e.first,
+                  [encoded, encoding](std::size_t n) {
+                      for (std::size_t i = 0; i < n; ++i) {
+                          do_not_optimize(
+                              xg::decode(encoded[i % encoded.size()], encoding)
+                                  .value);
+                      }
+                  });
+        }
+    }
+}  // namespace bench
@@ -0,0 +1,212 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#include "bench.hpp"
+
+#include <crossguid/guid.hpp>
+#include <crossguid/guid_filter.hpp>
+#include <crossguid/guid_index.hpp>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace bench {
+    namespace {
+        // Large enough that none of the filters fit in the cache
+        const std::size_t entries = std::size_t{1} << 23;
+
+        struct filter_data {
+            std::vector<xg::guid> present;
+            std::vector<xg::guid> absent;
+            // Time-ordered, for the hashed rather than folded keys
+            std::vector<xg::guid> present_v7;
+            std::vector<xg::guid> absent_v7;
+        };
+
+        // Built on first use, so that filtered out benchmarks cost nothing
+        const filter_data& data()
+        {
+            static const filter_data d = [] {
+                filter_data s;
+                s.present.resize(entries);
+                s.absent.resize(entries);
+                xg::make_guids(s.present.data(), entries);
+                xg::make_guids(s.absent.data(), entries);
+                s.present_v7.resize(entries);
+                s.absent_v7.resize(entries);
+                for (std::size_t i = 0; i < entries; ++i) {
+                    s.present_v7[i] = xg::make_guid_v7();
+                }
+                for (std::size_t i = 0; i < entries; ++i) {
+                    s.absent_v7[i] = xg::make_guid_v7();
+                }
+                return s;
+            }();
+            return d;
+        }
+
+        const xg::guid_bloom_filter& bloom()
+        {
+            static const xg::guid_bloom_filter f = [] {
+                xg::guid_bloom_filter filter{entries};
+                const auto& k = data().present;
+                filter.insert(k.data(), k.data() + k.size());
+                return filter;
+            }();
+            return f;
+        }
+
+        // The filter the insertion benchmarks insert into, allocated once
+        xg::guid_bloom_filter& insert_target()
+        {
+            static xg::guid_bloom_filter f{entries};
+            return f;
+        }
+
+        const xg::guid_bloom_filter& bloom_v7()
+        {
+            static const xg::guid_bloom_filter f = [] {
+                xg::guid_bloom_filter filter{entries};
+                const auto& k = data().present_v7;
+                filter.insert(k.data(), k.data() + k.size());
+                return filter;
+            }();
+            return f;
+        }
+
+        const xg::guid_xor_filter& xor_filter()
+        {
+            static const xg::guid_xor_filter f(data().present);
+            return f;
+        }
+
+        const xg::guid_xor_filter& xor_filter_v7()
+        {
+            static const xg::guid_xor_filter f(data().present_v7);
+            return f;
+        }
+
+        const xg::guid_index& index()
+        {
+            static const xg::guid_index i(data().present);
+            return i;
+        }
+
+        template <typename Filter>
+        double false_positive_percent(const Filter& filter,
+                                      const std::vector<xg::guid>& absent)
+        {
+            std::size_t n = 0;
+            for (const auto& g : absent) {
+                n += filter.may_contain(g);
+            }
+            return 100.0 * static_cast<double>(n) /
+                   static_cast<double>(absent.size());
+        }
+
+        template <typename Contains>
+        void register_lookups(registry& r,
+                              const std::string& name,
+                              Contains contains)
+        {
+            r.add(name + " hit", [contains](std::size_t n) {
+                const auto& k = data().present;
+                for (std::size_t i = 0; i < n; ++i) {
+                    do_not_optimize(contains(k[i % k.size()]));
+                }
+            });
+            r.add(name + " miss", [contains](std::size_t n) {
+                const auto& k = data().absent;
+                for (std::size_t i = 0; i < n; ++i) {
+                    do_not_optimize(contains(k[i % k.size()]));
+                }
+            });
+        }
+    }  // namespace
+
+    void register_filter(registry& r)
+    {
+        register_lookups(r, "xg::guid_index contains, 8M",
+                         [](const xg::guid& g) {
+                             return index().contains(g);
+                         });
+        register_lookups(r, "xg::guid_bloom_filter may_contain",
+                         [](const xg::guid& g) {
+                             return bloom().may_contain(g);
+                         });
+        register_lookups(r, "xg::guid_xor_filter may_contain",
+                         [](const xg::guid& g) {
+                             return xor_filter().may_contain(g);
+                         });
+
+        r.add("xg::guid_bloom_filter insert", [](std::size_t n) {
+            auto& filter = insert_target();
+            const auto& k = data().present;
+            for (std::size_t i = 0; i < n; ++i) {
+                filter.insert(k[i % k.size()]);
+            }
+            do_not_optimize(filter);
+        });
+        r.add("xg::guid_bloom_filter insert range", [](std::size_t n) {
+            auto& filter = insert_target();
+            const auto& k = data().present;
+            while (n > 0) {
+                const auto len = std::min(n, k.size());
+                filter.insert(k.data(), k.data() + len);
+                n -= len;
+            }
+            do_not_optimize(filter);
+        });
+        r.add("xg::guid_xor_filter build 1M", [](std::size_t n) {
+            const std::vector<xg::guid> k(data().present.begin(),
+                                          data().present.begin() + (1 << 20));
+            for (std::size_t i = 0; i < n; ++i) {
+                xg::guid_xor_filter built(k);
+                do_not_optimize(built.size());
+            }
+        });
+
+        r.add_metric("guid_bloom_filter bits per key", [] {
+            return 8.0 * static_cast<double>(bloom().size_in_bytes()) /
+                   static_cast<double>(entries);
+        }, "bits");
+        r.add_metric("guid_bloom_filter false positives", [] {
+            return false_positive_percent(bloom(), data().absent);
+        }, "%");
+        r.add_metric("guid_bloom_filter false positives (v7)", [] {
+            return false_positive_percent(bloom_v7(), data().absent_v7);
+        }, "%");
+        r.add_metric("guid_xor_filter bits per key", [] {
+            return 8.0 * static_cast<double>(xor_filter().size_in_bytes()) /
+                   static_cast<double>(entries);
+        }, "bits");
+        r.add_metric("guid_xor_filter false positives", [] {
+            return false_positive_percent(xor_filter(), data().absent);
+        }, "%");
+        r.add_metric("guid_xor_filter false positives (v7)", [] {
+            return false_positive_percent(xor_filter_v7(), data().absent_v7);
+        }, "%");
+    }
+}  // namespace bench
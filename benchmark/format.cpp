@@ -0,0 +1,143 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#include "bench.hpp"
+
+#ifdef CROSSGUID_BENCH_FMT
+#include <fmt/format.h>
+#endif
+
+#include <crossguid/format.hpp>
+#include <crossguid/guid.hpp>
+
+#include <iterator>
+#include <sstream>
+
+namespace bench {
+    namespace {
+        std::vector<xg::guid> random_guids()
+        {
+            std::vector<xg::guid> v(1024);
+            xg::make_guids(v.data(), v.size());
+            return v;
+        }
+    }  // namespace
+
+    void register_format(registry& r)
+    {
+        const auto guids = random_guids();
+
+        r.add("str()", [guids](std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i) {
+                do_not_optimize(guids[i % guids.size()].str());
+            }
+        });
+        r.add("str(std::string&)", [guids](std::size_t n) {
+            std::string s;
+            for (std::size_t i = 0; i < n; ++i) {
+                guids[i % guids.size()].str(s);
+                do_not_optimize(s);
+            }
+        });
+        r.add("str_to(char*)", [guids](std::size_t n) {
+            char buf[36];
+            for (std::size_t i = 0; i < n; ++i) {
+                guids[i % guids.size()].str_to(buf);
+                do_not_optimize(buf);
+            }
+        });
+        r.add("str_to(char*, uppercase | no_hyphens)", [guids](std::size_t n) {
+            char buf[32];
+            const auto flags =
+                xg::format_flags::uppercase | xg::format_flags::no_hyphens;
+            for (std::size_t i = 0; i < n; ++i) {
+                guids[i % guids.size()].str_to(buf, flags);
+                do_not_optimize(buf);
+            }
+        });
+        r.add("operator<<", [guids](std::size_t n) {
+            std::ostringstream os;
+            for (std::size_t i = 0; i < n; ++i) {
+                if (i % 1024 == 0) {
+                    os.str(std::string{});
+                }
+                os << guids[i % guids.size()];
+            }
+            do_not_optimize(os);
+        });
+        r.add("operator<< (std::uppercase, std::setw(40))",
+              [guids](std::size_t n) {
+                  std::ostringstream os;
+                  os << std::uppercase;
+                  for (std::size_t i = 0; i < n; ++i) {
+                      if (i % 1024 == 0) {
+                          os.str(std::string{});
+                      }
+                      os.width(40);
+                      os << guids[i % guids.size()];
+                  }
+                  do_not_optimize(os);
+              });
+        r.add("operator>>", [guids](std::size_t n) {
+            std::ostringstream text;
+            for (const auto& g : guids) {
+                text << g << '\n';
+            }
+            std::istringstream is(text.str());
+            xg::guid g;
+            for (std::size_t i = 0; i < n; ++i) {
+                if (i % guids.size() == 0) {
+                    is.clear();
+                    is.seekg(0);
+                }
+                is >> g;
+                do_not_optimize(g);
+            }
+        });
+#ifdef CROSSGUID_BENCH_FMT
+        r.add("fmt::format_to", [guids](std::size_t n) {
+            fmt::memory_buffer buf;
+            for (std::size_t i = 0; i < n; ++i) {
+                if (i % 1024 == 0) {
+                    buf.clear();
+                }
+                fmt::format_to(std::back_inserter(buf), "{}",
+                               guids[i % guids.size()]);
+            }
+            do_not_optimize(buf);
+        });
+        r.add("fmt::format_to (\"{:Xnb}\")", [guids](std::size_t n) {
+            fmt::memory_buffer buf;
+            for (std::size_t i = 0; i < n; ++i) {
+                if (i % 1024 == 0) {
+                    buf.clear();
+                }
+                fmt::format_to(std::back_inserter(buf), "{:Xnb}",
+                               guids[i % guids.size()]);
+            }
+            do_not_optimize(buf);
+        });
+#endif
+    }
+}  // namespace bench
@@ -0,0 +1,150 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#include "bench.hpp"
+
+#include <crossguid/guid.hpp>
+#include <crossguid/guid_pool.hpp>
+#include <crossguid/sharded_generator.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bench {
+    namespace {
+        xg::guid_pool& pool()
+        {
+            static xg::guid_pool p;
+            return p;
+        }
+
+        // The 99.9th percentile latency of `make` in nanoseconds, called in
+        // bursts of 1000 a millisecond apart, which a pool keeps up with
+        template <typename Make>
+        double tail_latency(Make make)
+        {
+            using clock = std::chrono::steady_clock;
+            std::vector<double> latencies;
+            for (int burst = 0; burst < 200; ++burst) {
+                for (int i = 0; i < 1000; ++i) {
+                    const auto start = clock::now();
+                    do_not_optimize(make());
+                    latencies.push_back(
+                        std::chrono::duration<double, std::nano>(clock::now() -
+                                                                 start)
+                            .count());
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            const auto p999 = latencies.begin() +
+                              static_cast<long>(latencies.size() * 999 / 1000);
+            std::nth_element(latencies.begin(), p999, latencies.end());
+            return *p999;
+        }
+    }  // namespace
+
+    void register_generate(registry& r)
+    {
+        for (auto threads : thread_counts()) {
+            r.add("make_guid", [](std::size_t n) {
+                for (std::size_t i = 0; i < n; ++i) {
+                    do_not_optimize(xg::make_guid());
+                }
+            }, threads);
+        }
+        for (auto threads : thread_counts()) {
+            r.add("make_guid_v7", [](std::size_t n) {
+                for (std::size_t i = 0; i < n; ++i) {
+                    do_not_optimize(xg::make_guid_v7());
+                }
+            }, threads);
+        }
+
+        for (auto threads : thread_counts()) {
+            r.add("xg::sharded_generator", [](std::size_t n) {
+                static xg::sharded_generator gen{1};
+                for (std::size_t i = 0; i < n; ++i) {
+                    do_not_optimize(gen());
+                }
+            }, threads);
+        }
+        r.add("xg::sharded_generator::generate (per guid, batches of 4096)",
+              [](std::size_t n) {
+                  static xg::sharded_generator gen{1};
+                  std::vector<xg::guid> buf(4096);
+                  while (n > 0) {
+                      const auto len = std::min(n, buf.size());
+                      gen.generate(buf.data(), len);
+                      do_not_optimize(buf.front());
+                      n -= len;
+                  }
+              });
+        for (auto threads : thread_counts()) {
+            r.add("xg::guid_pool::get", [](std::size_t n) {
+                auto& p = pool();
+                for (std::size_t i = 0; i < n; ++i) {
+                    do_not_optimize(p.get());
+                }
+            }, threads);
+        }
+        r.add_metric("make_guid p99.9 latency", [] {
+            return tail_latency([] { return xg::make_guid(); });
+        }, "ns");
+        r.add_metric("xg::guid_pool::get p99.9 latency", [] {
+            return tail_latency([] { return pool().get(); });
+        }, "ns");
+
+        r.add("make_guids (per guid, batches of 4096)", [](std::size_t n) {
+            std::vector<xg::guid> buf(4096);
+            while (n > 0) {
+                const auto len = std::min(n, buf.size());
+                xg::make_guids(buf.data(), len);
+                do_not_optimize(buf.front());
+                n -= len;
+            }
+        });
+
+        const std::string name = "https://example.com/objects/1234567";
+        r.add("make_guid_v5", [name](std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i) {
+                do_not_optimize(xg::make_guid_v5(xg::namespace_url, name));
+            }
+        });
+        r.add("make_guids_v5 (per guid, batches of 64)", [name](std::size_t n) {
+            const std::vector<std::string> names(64, name);
+            std::vector<xg::guid> out(64);
+            while (n > 0) {
+                const auto len = std::min(n, names.size());
+                xg::make_guids_v5(xg::namespace_url, names.begin(),
+                                  names.begin() + static_cast<long>(len),
+                                  out.begin());
+                do_not_optimize(out.front());
+                n -= len;
+            }
+        });
+    }
+}  // namespace bench
@@ -0,0 +1,120 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#include "bench.hpp"
+
+#include <crossguid/guid.hpp>
+#include <crossguid/guid_index.hpp>
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace bench {
+    namespace {
+        // Large enough that none of the containers fit in the cache
+        const std::size_t entries = std::size_t{1} << 22;
+
+        struct index_data {
+            std::vector<xg::guid> sorted;
+            // The same keys in another order, so that lookups don't walk
+            // the memory in order
+            std::vector<xg::guid> shuffled;
+            std::vector<xg::guid> absent;
+        };
+
+        // Built on first use, so that filtered out benchmarks cost nothing
+        const index_data& data()
+        {
+            static const index_data d = [] {
+                index_data s;
+                s.sorted.resize(entries);
+                s.absent.resize(entries);
+                xg::make_guids(s.sorted.data(), entries);
+                xg::make_guids(s.absent.data(), entries);
+                s.shuffled = s.sorted;
+                std::shuffle(s.shuffled.begin(), s.shuffled.end(),
+                             std::mt19937{42});
+                std::sort(s.sorted.begin(), s.sorted.end());
+                return s;
+            }();
+            return d;
+        }
+
+        const std::set<xg::guid>& std_set()
+        {
+            static const std::set<xg::guid> s(data().sorted.begin(),
+                                              data().sorted.end());
+            return s;
+        }
+
+        const xg::guid_index& index()
+        {
+            static const xg::guid_index i(data().sorted);
+            return i;
+        }
+
+        template <typename Contains>
+        void register_lookups(registry& r,
+                              const std::string& name,
+                              Contains contains)
+        {
+            r.add(name + " contains hit", [contains](std::size_t n) {
+                const auto& k = data().shuffled;
+                for (std::size_t i = 0; i < n; ++i) {
+                    do_not_optimize(contains(k[i % k.size()]));
+                }
+            });
+            r.add(name + " contains miss", [contains](std::size_t n) {
+                const auto& k = data().absent;
+                for (std::size_t i = 0; i < n; ++i) {
+                    do_not_optimize(contains(k[i % k.size()]));
+                }
+            });
+        }
+    }  // namespace
+
+    void register_index(registry& r)
+    {
+        register_lookups(r, "std::set", [](const xg::guid& g) {
+            return std_set().count(g) != 0;
+        });
+        register_lookups(r, "sorted std::vector", [](const xg::guid& g) {
+            const auto& v = data().sorted;
+            return std::binary_search(v.begin(), v.end(), g);
+        });
+        register_lookups(r, "xg::guid_index", [](const xg::guid& g) {
+            return index().contains(g);
+        });
+
+        r.add("xg::guid_index build", [](std::size_t n) {
+            const auto& k = data().shuffled;
+            for (std::size_t i = 0; i < n; ++i) {
+                xg::guid_index built(k);
+                do_not_optimize(built.size());
+            }
+        });
+    }
+}  // namespace bench
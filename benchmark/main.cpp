@@ -0,0 +1,325 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+// crossguid_bench: measures the throughput of the crossguid operations.
+//
+// Usage: crossguid_bench [--filter <substring>] [--min-time <seconds>]
+//                        [--json <file>|-]
+//
+// Prints a table of ns/op and ops/s, and optionally writes the same results
+// as JSON to `file` (or stdout with `-`), for tracking regressions.
+//
+// Multi-threaded benchmarks report the wall time of one operation on one
+// thread as ns/op, and the combined throughput of all threads as ops/s.
+//
+// Metrics that aren't times, like memory per entry, follow in a second table.
+
+#include "bench.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace bench {
+    std::vector<unsigned> thread_counts()
+    {
+        const unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<unsigned> counts;
+        for (unsigned n = 1; n < hw; n *= 2) {
+            counts.push_back(n);
+        }
+        counts.push_back(hw);
+        return counts;
+    }
+}  // namespace bench
+
+namespace {
+    struct options {
+        std::string filter;
+        std::string json;
+        double min_time = 0.2;
+    };
+
+    struct result {
+        std::string name;
+        unsigned threads;
+        std::size_t iterations;
+        double ns_per_op;
+        double ops_per_sec;
+    };
+
+    struct metric_result {
+        std::string name;
+        double value;
+        std::string unit;
+    };
+
+    // Runs `n` operations on each of `threads` threads, started together.
+    // Returns the wall time in seconds.
+    double time_run(const bench::benchmark& b, std::size_t n)
+    {
+        using clock = std::chrono::steady_clock;
+        if (b.threads <= 1) {
+            const auto start = clock::now();
+            b.fn(n);
+            return std::chrono::duration<double>(clock::now() - start).count();
+        }
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        unsigned ready = 0;
+        bool go = false;
+
+        std::vector<std::thread> threads;
+        for (unsigned t = 0; t < b.threads; ++t) {
+            threads.emplace_back([&]() {
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    ++ready;
+                    cv.notify_all();
+                    cv.wait(lock, [&] { return go; });
+                }
+                b.fn(n);
+            });
+        }
+
+        clock::time_point start;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&] { return ready == b.threads; });
+            go = true;
+            start = clock::now();
+        }
+        cv.notify_all();
+        for (auto& t : threads) {
+            t.join();
+        }
+        return std::chrono::duration<double>(clock::now() - start).count();
+    }
+
+    // Results from fewer iterations are mostly noise
+    const std::size_t min_iterations = 100;
+
+    result run(const bench::benchmark& b, double min_time)
+    {
+        // Untimed, so that fixtures created on first use aren't counted
+        time_run(b, 1);
+
+        // Grow the iteration count until one run takes a tenth of the
+        // target time, then scale it to the target
+        std::size_t n = 16;
+        double elapsed = time_run(b, n);
+        while (elapsed < min_time / 10 && n < (std::size_t{1} << 40)) {
+            n *= 4;
+            elapsed = time_run(b, n);
+        }
+        if (elapsed < min_time) {
+            n = static_cast<std::size_t>(static_cast<double>(n) * min_time /
+                                         std::max(elapsed, 1e-9));
+        }
+
+        // Median of five runs
+        std::vector<double> times;
+        for (int i = 0; i < 5; ++i) {
+            times.push_back(time_run(b, n));
+        }
+        std::sort(times.begin(), times.end());
+        const double t = times[2];
+
+        result r;
+        r.name = b.name;
+        r.threads = b.threads;
+        r.iterations = n;
+        r.ns_per_op = t * 1e9 / static_cast<double>(n);
+        r.ops_per_sec = static_cast<double>(n) * b.threads / t;
+        return r;
+    }
+
+    std::string json_escape(const std::string& s)
+    {
+        std::string out;
+        for (char ch : s) {
+            if (ch == '"' || ch == '\\') {
+                out += '\\';
+            }
+            out += ch;
+        }
+        return out;
+    }
+
+    void write_json(std::ostream& os,
+                    const std::vector<result>& results,
+                    const std::vector<metric_result>& metrics)
+    {
+        char date[32] = {};
+        const auto now = std::time(nullptr);
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ",
+                      std::gmtime(&now));
+
+        os << "{\n  \"context\": {\n";
+        os << "    \"date\": \"" << date << "\",\n";
+#if defined(__VERSION__)
+        os << "    \"compiler\": \"" << json_escape(__VERSION__) << "\",\n";
+#elif defined(_MSC_FULL_VER)
+        os << "    \"compiler\": \"MSVC " << _MSC_FULL_VER << "\",\n";
+#endif
+#ifdef NDEBUG
+        os << "    \"assertions\": false,\n";
+#else
+        os << "    \"assertions\": true,\n";
+#endif
+        os << "    \"hardware_threads\": "
+           << std::thread::hardware_concurrency() << "\n  },\n";
+
+        os << "  \"benchmarks\": [";
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const auto& r = results[i];
+            os << (i == 0 ? "\n" : ",\n");
+            os << "    {\"name\": \"" << json_escape(r.name)
+               << "\", \"threads\": " << r.threads
+               << ", \"iterations\": " << r.iterations
+               << ", \"ns_per_op\": " << r.ns_per_op
+               << ", \"ops_per_sec\": " << r.ops_per_sec << "}";
+        }
+        os << "\n  ],\n";
+
+        os << "  \"metrics\": [";
+        for (std::size_t i = 0; i < metrics.size(); ++i) {
+            const auto& m = metrics[i];
+            os << (i == 0 ? "\n" : ",\n");
+            os << "    {\"name\": \"" << json_escape(m.name)
+               << "\", \"value\": " << m.value << ", \"unit\": \""
+               << json_escape(m.unit) << "\"}";
+        }
+        os << "\n  ]\n}\n";
+    }
+
+    bool parse_options(int argc, char** argv, options& opts)
+    {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (i + 1 < argc && arg == "--filter") {
+                opts.filter = argv[++i];
+            }
+            else if (i + 1 < argc && arg == "--json") {
+                opts.json = argv[++i];
+            }
+            else if (i + 1 < argc && arg == "--min-time") {
+                opts.min_time = std::atof(argv[++i]);
+            }
+            else {
+                std::cerr << "Usage: " << argv[0]
+                          << " [--filter <substring>] [--min-time <seconds>]"
+                             " [--json <file>|-]\n";
+                return false;
+            }
+        }
+        return true;
+    }
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    options opts;
+    if (!parse_options(argc, argv, opts)) {
+        return 1;
+    }
+
+    bench::registry registry;
+    bench::register_generate(registry);
+    bench::register_parse(registry);
+    bench::register_format(registry);
+    bench::register_compare(registry);
+    bench::register_containers(registry);
+    bench::register_scan(registry);
+    bench::register_batch(registry);
+    bench::register_encoding(registry);
+    bench::register_sort(registry);
+    bench::register_index(registry);
+    bench::register_column(registry);
+    bench::register_filter(registry);
+    bench::register_concurrent(registry);
+
+    // Keep stdout clean for the JSON when it goes there
+    std::ostream& table = opts.json == "-" ? std::cerr : std::cout;
+
+    std::vector<result> results;
+    char line[160];
+    std::snprintf(line, sizeof(line), "%-40s %7s %12s %16s\n", "benchmark",
+                  "threads", "ns/op", "ops/s");
+    table << line;
+    for (const auto& b : registry.all()) {
+        if (b.name.find(opts.filter) == std::string::npos) {
+            continue;
+        }
+        const auto r = run(b, opts.min_time);
+        std::snprintf(line, sizeof(line), "%-40s %7u %12.2f %16.0f\n",
+                      r.name.c_str(), r.threads, r.ns_per_op, r.ops_per_sec);
+        table << line << std::flush;
+        if (r.iterations < min_iterations) {
+            std::cerr << "warning: " << r.name << " ran only " << r.iterations
+                      << " iterations, raise --min-time for a stable result\n";
+        }
+        results.push_back(r);
+    }
+
+    std::vector<metric_result> metrics;
+    for (const auto& m : registry.metrics()) {
+        if (m.name.find(opts.filter) == std::string::npos) {
+            continue;
+        }
+        if (metrics.empty()) {
+            std::snprintf(line, sizeof(line), "\n%-40s %12s %s\n", "metric",
+                          "value", "unit");
+            table << line;
+        }
+        const metric_result r{m.name, m.measure(), m.unit};
+        std::snprintf(line, sizeof(line), "%-40s %12.2f %s\n", r.name.c_str(),
+                      r.value, r.unit.c_str());
+        table << line << std::flush;
+        metrics.push_back(r);
+    }
+
+    if (opts.json == "-") {
+        write_json(std::cout, results, metrics);
+    }
+    else if (!opts.json.empty()) {
+        std::ofstream file(opts.json);
+        write_json(file, results, metrics);
+        if (!file) {
+            std::cerr << "Failed to write " << opts.json << '\n';
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,168 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#include "bench.hpp"
+
+#include <crossguid/guid.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <memory>
+
+namespace bench {
+    namespace {
+        // The parser as it was before vectorization, for comparison
+        unsigned char reference_hex_digit(unsigned char ch)
+        {
+            if (ch > 47 && ch < 58) {
+                return static_cast<unsigned char>(ch - 48);
+            }
+            if (ch > 96 && ch < 103) {
+                return static_cast<unsigned char>(ch - 87);
+            }
+            if (ch > 64 && ch < 71) {
+                return static_cast<unsigned char>(ch - 55);
+            }
+            return 0;
+        }
+
+        xg::guid reference_parse(const char* s)
+        {
+            std::array<unsigned char, 16> bytes{{0}};
+            char char1{};
+            std::size_t next_byte = 0;
+            bool looking_for_first_char = true;
+
+            const auto end = s + std::strlen(s);
+            for (; s != end; ++s) {
+                auto ch = *s;
+                if (ch == '-') {
+                    continue;
+                }
+                if (next_byte >= 16 ||
+                    std::isxdigit(static_cast<unsigned char>(ch)) == 0) {
+                    return xg::guid{};
+                }
+                if (looking_for_first_char) {
+                    char1 = ch;
+                    looking_for_first_char = false;
+                }
+                else {
+                    bytes[next_byte++] = static_cast<unsigned char>(
+                        reference_hex_digit(static_cast<unsigned char>(char1)) *
+                            16 +
+                        reference_hex_digit(static_cast<unsigned char>(ch)));
+                    looking_for_first_char = true;
+                }
+            }
+            if (next_byte < 16) {
+                return xg::guid{};
+            }
+            return xg::guid{bytes};
+        }
+
+        using inputs = std::shared_ptr<const std::vector<std::string>>;
+
+        inputs make_inputs(std::string (*transform)(std::string, std::size_t))
+        {
+            auto v = std::make_shared<std::vector<std::string>>();
+            for (std::size_t i = 0; i < 1024; ++i) {
+                v->push_back(transform(xg::make_guid().str(), i));
+            }
+            return v;
+        }
+
+        template <typename Parse>
+        function parse_each(inputs in, Parse parse)
+        {
+            return [in, parse](std::size_t n) {
+                const auto& v = *in;
+                for (std::size_t i = 0; i < n; ++i) {
+                    do_not_optimize(parse(v[i % v.size()].c_str()));
+                }
+            };
+        }
+
+        // Through xg::parse, which takes the length instead of measuring it
+        function parse_range_each(inputs in, xg::parse_mode mode)
+        {
+            return [in, mode](std::size_t n) {
+                const auto& v = *in;
+                for (std::size_t i = 0; i < n; ++i) {
+                    do_not_optimize(xg::parse(v[i % v.size()], mode).value);
+                }
+            };
+        }
+    }  // namespace
+
+    void register_parse(registry& r)
+    {
+        const auto canonical =
+            make_inputs([](std::string s, std::size_t) { return s; });
+        const auto upper = make_inputs([](std::string s, std::size_t) {
+            std::transform(s.begin(), s.end(), s.begin(), [](char ch) {
+                return static_cast<char>(
+                    std::toupper(static_cast<unsigned char>(ch)));
+            });
+            return s;
+        });
+        const auto no_hyphens = make_inputs([](std::string s, std::size_t) {
+            s.erase(std::remove(s.begin(), s.end(), '-'), s.end());
+            return s;
+        });
+        const auto invalid = make_inputs([](std::string s, std::size_t i) {
+            s[i % s.size()] = 'x';
+            return s;
+        });
+
+        const auto braced = make_inputs([](std::string s, std::size_t) {
+            return "{" + s + "}";
+        });
+        const auto urn = make_inputs([](std::string s, std::size_t) {
+            return "urn:uuid:" + s;
+        });
+
+        auto construct = [](const char* s) { return xg::guid{s}; };
+        r.add("guid(const char*) canonical", parse_each(canonical, construct));
+        r.add("guid(const char*) uppercase", parse_each(upper, construct));
+        r.add("guid(const char*) no hyphens",
+              parse_each(no_hyphens, construct));
+        r.add("guid(const char*) invalid", parse_each(invalid, construct));
+        r.add("parse strict",
+              parse_range_each(canonical, xg::parse_mode::strict));
+        r.add("parse braced",
+              parse_range_each(braced, xg::parse_mode::braced));
+        r.add("parse urn", parse_range_each(urn, xg::parse_mode::urn));
+        r.add("parse lenient canonical",
+              parse_range_each(canonical, xg::parse_mode::lenient));
+        r.add("parse lenient no hyphens",
+              parse_range_each(no_hyphens, xg::parse_mode::lenient));
+        r.add("parse strict invalid",
+              parse_range_each(invalid, xg::parse_mode::strict));
+        r.add("reference loop canonical",
+              parse_each(canonical, reference_parse));
+        r.add("reference loop invalid", parse_each(invalid, reference_parse));
+    }
+}  // namespace bench
@@ -0,0 +1,100 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#include "bench.hpp"
+
+#include <crossguid/guid.hpp>
+#include <crossguid/scan.hpp>
+
+#include <random>
+#include <regex>
+#include <string>
+
+namespace bench {
+    namespace {
+        // Log lines, a third of them with a request ID
+        std::string make_log(std::size_t size)
+        {
+            std::mt19937 rng{1};
+            std::string log;
+            while (log.size() < size) {
+                log += "2024-05-17T12:34:56.789Z INFO http-server ";
+                if (rng() % 3 == 0) {
+                    log += "request_id=" + xg::make_guid().str() + " ";
+                }
+                log += "GET /api/v1/items?page=" + std::to_string(rng() % 100) +
+                       " status=200 latency_ms=" + std::to_string(rng() % 500) +
+                       "\n";
+            }
+            log.resize(size);
+            return log;
+        }
+
+        const std::string& log()
+        {
+            static const std::string s = make_log(std::size_t{64} << 20);
+            return s;
+        }
+    }  // namespace
+
+    void register_scan(registry& r)
+    {
+        const std::size_t mib = std::size_t{1} << 20;
+
+        r.add("scan 1 MiB log", [mib](std::size_t n) {
+            const auto& s = log();
+            for (std::size_t i = 0; i < n; ++i) {
+                do_not_optimize(xg::scan(s.data(), s.data() + mib).size());
+            }
+        });
+        r.add("std::regex 1 MiB log", [mib](std::size_t n) {
+            const std::regex re{"[0-9a-fA-F]{8}-[0-9a-fA-F]{4}-[0-9a-fA-F]{4}-"
+                                "[0-9a-fA-F]{4}-[0-9a-fA-F]{12}"};
+            const auto& s = log();
+            for (std::size_t i = 0; i < n; ++i) {
+                std::size_t count = 0;
+                for (std::cregex_iterator it{s.data(), s.data() + mib, re}, end;
+                     it != end; ++it) {
+                    ++count;
+                }
+                do_not_optimize(count);
+            }
+        });
+
+        for (auto threads : thread_counts()) {
+            r.add("scan 64 MiB log, " + std::to_string(threads) +
+                      (threads == 1 ? " thread" : " threads"),
+                  [threads](std::size_t n) {
+                      const auto& s = log();
+                      xg::scan_options options;
+                      options.threads = threads;
+                      for (std::size_t i = 0; i < n; ++i) {
+                          do_not_optimize(
+                              xg::scan(s.data(), s.data() + s.size(), options)
+                                  .size());
+                      }
+                  });
+        }
+    }
+}  // namespace bench
@@ -0,0 +1,100 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#include "bench.hpp"
+
+#include <crossguid/guid.hpp>
+#include <crossguid/sort.hpp>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#ifdef CROSSGUID_BENCH_EXECUTION
+#include <execution>
+#endif
+
+namespace bench {
+    namespace {
+        const std::size_t count = std::size_t{1} << 22;
+
+        const std::vector<xg::guid>& unsorted()
+        {
+            static const std::vector<xg::guid> v = [] {
+                std::vector<xg::guid> guids(count);
+                xg::make_guids(guids.data(), guids.size());
+                return guids;
+            }();
+            return v;
+        }
+
+        // Every iteration sorts a fresh copy
+        template <typename Sort>
+        std::function<void(std::size_t)> sort_copies(Sort sort)
+        {
+            return [sort](std::size_t n) {
+                std::vector<xg::guid> v;
+                for (std::size_t i = 0; i < n; ++i) {
+                    v = unsorted();
+                    sort(v);
+                    do_not_optimize(v.front());
+                }
+            };
+        }
+    }  // namespace
+
+    void register_sort(registry& r)
+    {
+        const std::string suffix = " 4M GUIDs";
+
+        r.add("std::sort" + suffix, sort_copies([](std::vector<xg::guid>& v) {
+                  std::sort(v.begin(), v.end());
+              }));
+#ifdef CROSSGUID_BENCH_EXECUTION
+        r.add("std::sort(std::execution::par)" + suffix,
+              sort_copies([](std::vector<xg::guid>& v) {
+                  std::sort(std::execution::par, v.begin(), v.end());
+              }));
+#endif
+
+        for (auto threads : thread_counts()) {
+            const auto threads_suffix =
+                ", " + std::to_string(threads) +
+                (threads == 1 ? " thread" : " threads");
+            for (bool in_place : {false, true}) {
+                xg::sort_options options;
+                options.threads = threads;
+                options.in_place = in_place;
+                r.add(std::string{in_place ? "xg::sort in place"
+                                           : "xg::sort"} +
+                          suffix + threads_suffix,
+                      sort_copies([options](std::vector<xg::guid>& v) {
+                          xg::sort(v.data(), v.data() + v.size(), options);
+                      }));
+            }
+        }
+
+        r.add("copy only" + suffix, sort_copies([](std::vector<xg::guid>&) {}));
+    }
+}  // namespace bench
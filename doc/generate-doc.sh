@@ -1,4 +1,4 @@
 #!/bin/sh
 
 standardese_bin="$1"
-$standardese_bin --config standardese.ini --output.prefix=html/ ../include/crossguid/guid.hpp
+$standardese_bin --config standardese.ini --output.prefix=html/ ../include/crossguid/guid.hpp ../include/crossguid/guid_map.hpp
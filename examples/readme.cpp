@@ -39,6 +39,12 @@ int main()
     xg::guid from_std_array{std::move(bytes_std_array)};
     unsigned char bytes_c_array[16] = {0};
     xg::guid from_c_array{bytes_c_array};
+    // or at compile time, from a literal (C++14 and later)
+#if XG_HAS_RELAXED_CONSTEXPR
+    using namespace xg::literals;
+    constexpr auto from_literal = "7bcd757f-5b10-4f9b-af69-1a1f226f3b3e"_guid;
+    static_assert(from_literal.version() == 4, "parsed at compile time");
+#endif
 
     // guid is convertible to a bool
     if (g) {
@@ -0,0 +1,137 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#pragma once
+
+#include "guid.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace xg {
+    /// Options for the batch conversions.
+    struct batch_options {
+        /// Number of threads converting rows in parallel.
+        /// `0` uses one per hardware thread.
+        unsigned threads{1};
+        /// Number of rows handed to a thread at a time.
+        /// Rounded up to a multiple of 8, so that every byte of the validity
+        /// bitmap is written by one thread.
+        std::size_t rows_per_task{std::size_t{1} << 16};
+    };
+
+    /// Parses a column of `n` GUIDs in the canonical textual representation,
+    /// stored as fixed-width rows beginning `stride` bytes apart at `text`,
+    /// like in a CSV file with a fixed layout or an Arrow fixed-size binary
+    /// column.
+    ///
+    /// \effects Assigns the GUID of row `i` to `out[i]`, or a nil GUID if the
+    /// row isn't valid. If `valid` isn't null, sets bit `i` of the bitmap
+    /// (`valid[i / 8] >> (i % 8) & 1`, least significant bit first, like
+    /// Apache Arrow) to `1` for valid rows and `0` for invalid ones.
+    ///
+    /// \returns The number of valid rows.
+    ///
+    /// \requires `stride >= 36`. `text` must point to `(n - 1) * stride + 36`
+    /// readable bytes, `out` to `n` GUIDs, and `valid` (if not null) to
+    /// `(n + 7) / 8` bytes.
+    ///
+    /// \notes Only the canonical form is accepted, with digits in either
+    /// case. Rows are parsed with the vectorized kernels of
+    /// `guid(const char*)`, without measuring or copying any strings.
+    std::size_t parse_batch(const char* text,
+                            std::size_t stride,
+                            std::size_t n,
+                            guid* out,
+                            std::uint8_t* valid = nullptr,
+                            const batch_options& options = batch_options{});
+
+    /// Formats a column of `n` GUIDs as fixed-width rows beginning `stride`
+    /// bytes apart at `text`, the opposite of [xg::parse_batch]().
+    ///
+    /// \effects Writes the textual representation of `in[i]` with `flags`,
+    /// `formatted_size(flags)` characters, at `text + i * stride`. Nothing is
+    /// written between the rows, and no null terminators are.
+    ///
+    /// \requires `stride >= formatted_size(flags)`.
+    ///
+    /// \notes Uses SSE4.1 byte shuffles where available, selected at runtime,
+    /// to convert 16 bytes to hexadecimal digits and insert the hyphens at
+    /// once.
+    void format_batch(const guid* in,
+                      std::size_t n,
+                      char* text,
+                      std::size_t stride,
+                      format_flags flags = format_flags::none,
+                      const batch_options& options = batch_options{});
+
+    /// Converts `n` GUIDs to the Microsoft byte layout of
+    /// [xg::to_ms_bytes](), for SQL Server and .NET.
+    ///
+    /// \effects Writes `to_ms_bytes(in[i])` to the 16 bytes at
+    /// `out + 16 * i`.
+    ///
+    /// \requires `out` must point to `16 * n` bytes, either not overlapping
+    /// `in` or at the same address, to convert in place.
+    ///
+    /// \notes Reorders the bytes of 2 GUIDs at a time with an AVX2 byte
+    /// shuffle, or 1 with SSE4.1, where available, selected at runtime.
+    /// \unique_name to_ms_bytes_batch
+    void to_ms_bytes(const guid* in,
+                     std::size_t n,
+                     unsigned char* out) noexcept;
+
+    /// Converts `n` GUIDs from the Microsoft byte layout of
+    /// [xg::to_ms_bytes](), the opposite of
+    /// [`to_ms_bytes(in, n, out)`](standardese://to_ms_bytes_batch/).
+    ///
+    /// \effects Assigns `from_ms_bytes(in + 16 * i)` to `out[i]`.
+    ///
+    /// \requires `in` must point to `16 * n` bytes, either not overlapping
+    /// `out` or at the same address, to convert in place.
+    ///
+    /// \notes Vectorized like
+    /// [`to_ms_bytes(in, n, out)`](standardese://to_ms_bytes_batch/).
+    /// \unique_name from_ms_bytes_batch
+    void from_ms_bytes(const unsigned char* in,
+                       std::size_t n,
+                       guid* out) noexcept;
+
+    /// \returns Pointer to the first GUID in `[first, last)` equal to
+    /// `value`, or `last` if there's none.
+    ///
+    /// \notes Compares 4 GUIDs at a time with AVX2 or SSE4.1 where
+    /// available, selected at runtime, for membership tests in small
+    /// unsorted arrays.
+    const guid* find(const guid* first,
+                     const guid* last,
+                     const guid& value) noexcept;
+
+    /// \returns The number of GUIDs in `[first, last)` equal to `value`.
+    ///
+    /// \notes Vectorized like [xg::find]().
+    std::size_t count(const guid* first,
+                      const guid* last,
+                      const guid& value) noexcept;
+}  // namespace xg
@@ -0,0 +1,566 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#pragma once
+
+#include "epoch.hpp"
+#include "guid.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+
+namespace xg {
+    namespace detail {
+        /// \exclude
+        struct concurrent_node_base {
+            std::atomic<concurrent_node_base*> next{nullptr};
+        };
+
+        /// \exclude
+        /// The head of the buckets of a table that have been moved to the
+        /// next, larger one.
+        inline concurrent_node_base* moved_bucket() noexcept
+        {
+            static concurrent_node_base moved;
+            return &moved;
+        }
+    }  // namespace detail
+
+    /// A hash map from GUIDs to values of type `T` that any number of
+    /// threads can use at once, like a registry of sessions or connections.
+    ///
+    /// Lookups are lock-free: they follow the chain of a bucket with atomic
+    /// loads only, so readers never wait for writers or for each other.
+    /// Insertions and erasures lock one of 256 stripes of the buckets, so
+    /// writers only wait for writers of the same stripe.
+    ///
+    /// Values are never modified in place: assigning replaces the node of
+    /// an element. Erased and replaced nodes are destroyed with epoch-based
+    /// reclamation, once no lookup can still be reading them: by whichever
+    /// thread erases or assigns later, possibly after the map is destroyed.
+    ///
+    /// When the map grows, the buckets are moved to a table twice as large
+    /// a few at a time, by the writers, instead of all at once: no
+    /// operation waits for a whole rehash. Lookups look in the new table
+    /// for the buckets already moved. The nodes that can't be moved without
+    /// breaking the chains that lookups may be following are copied.
+    ///
+    /// As with [xg::guid_map](), the default [xg::fold_hash]() uses the
+    /// random bits of the keys as they are, so it's only suited to random
+    /// (version 4) GUIDs. Use [xg::mix_hash]() as `Hash` for time-ordered,
+    /// name-based or untrusted GUIDs.
+    ///
+    /// \requires `T` must be copy constructible, to move elements to a
+    /// larger table while they can still be read.
+    template <typename T, typename Hash = fold_hash>
+    class concurrent_guid_map {
+    public:
+        using key_type = guid;
+        using mapped_type = T;
+        using hasher = Hash;
+        using size_type = std::size_t;
+
+        /// \effects Constructs an empty map with room for `capacity`
+        /// elements before it grows.
+        /// \output_section Constructors
+        explicit concurrent_guid_map(std::size_t capacity = 0,
+                                     const Hash& hash = Hash())
+            : _hash(hash), _stripes(new stripe[stripe_count])
+        {
+            std::size_t buckets = stripe_count;
+            while (buckets < capacity) {
+                buckets *= 2;
+            }
+            _table.store(new table(buckets), std::memory_order_relaxed);
+        }
+
+        concurrent_guid_map(const concurrent_guid_map&) = delete;
+        concurrent_guid_map& operator=(const concurrent_guid_map&) = delete;
+
+        /// \effects Destroys the elements.
+        /// \requires No other thread is using the map.
+        ~concurrent_guid_map()
+        {
+            table* t = _table.load(std::memory_order_relaxed);
+            while (t != nullptr) {
+                for (std::size_t i = 0; i <= t->mask; ++i) {
+                    auto* p = t->buckets[i].load(std::memory_order_relaxed);
+                    if (p == detail::moved_bucket()) {
+                        continue;
+                    }
+                    while (p != nullptr) {
+                        auto* next = p->next.load(std::memory_order_relaxed);
+                        delete static_cast<node*>(p);
+                        p = next;
+                    }
+                }
+                table* next = t->next.load(std::memory_order_relaxed);
+                delete t;
+                t = next;
+            }
+        }
+
+        /// \effects Inserts `value` with the key `key`, if `key` isn't in
+        /// the map.
+        ///
+        /// \returns `true` if it was inserted.
+        ///
+        /// \notes The element is constructed from `value` before looking
+        /// for `key`, so `value` is moved from even if it isn't inserted.
+        /// \output_section Modifiers
+        template <typename M>
+        bool insert(const guid& key, M&& value)
+        {
+            const auto h = hash_of(key);
+            std::unique_ptr<node> n(new node(key, h, std::forward<M>(value)));
+            detail::epoch_guard guard;
+            help_migrate();
+
+            auto& s = stripe_of(h);
+            {
+                std::lock_guard<std::mutex> lock(s.mutex);
+                auto& bucket = locked_bucket(h);
+                auto* head = bucket.load(std::memory_order_relaxed);
+                for (auto* p = head; p != nullptr;
+                     p = p->next.load(std::memory_order_relaxed)) {
+                    if (static_cast<node*>(p)->key == key) {
+                        return false;
+                    }
+                }
+                n->next.store(head, std::memory_order_relaxed);
+                bucket.store(n.release(), std::memory_order_release);
+                s.size.store(s.size.load(std::memory_order_relaxed) + 1,
+                             std::memory_order_relaxed);
+            }
+            grow_if_needed(s);
+            return true;
+        }
+
+        /// \effects Assigns `value` to the element with the key `key`, or
+        /// inserts it if there isn't one.
+        ///
+        /// \returns `true` if it was inserted, `false` if assigned.
+        template <typename M>
+        bool insert_or_assign(const guid& key, M&& value)
+        {
+            const auto h = hash_of(key);
+            std::unique_ptr<node> n(new node(key, h, std::forward<M>(value)));
+            detail::epoch_guard guard;
+            help_migrate();
+
+            auto& s = stripe_of(h);
+            node* replaced = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(s.mutex);
+                auto& bucket = locked_bucket(h);
+                std::atomic<detail::concurrent_node_base*>* link = &bucket;
+                for (auto* p = link->load(std::memory_order_relaxed);
+                     p != nullptr; p = link->load(std::memory_order_relaxed)) {
+                    if (static_cast<node*>(p)->key == key) {
+                        replaced = static_cast<node*>(p);
+                        break;
+                    }
+                    link = &p->next;
+                }
+                if (replaced != nullptr) {
+                    n->next.store(
+                        replaced->next.load(std::memory_order_relaxed),
+                        std::memory_order_relaxed);
+                    link->store(n.release(), std::memory_order_release);
+                }
+                else {
+                    n->next.store(bucket.load(std::memory_order_relaxed),
+                                  std::memory_order_relaxed);
+                    bucket.store(n.release(), std::memory_order_release);
+                    s.size.store(s.size.load(std::memory_order_relaxed) + 1,
+                                 std::memory_order_relaxed);
+                }
+            }
+            if (replaced != nullptr) {
+                detail::epoch_retire(replaced);
+                return false;
+            }
+            grow_if_needed(s);
+            return true;
+        }
+
+        /// \effects Inserts the value returned by `make()` with the key
+        /// `key`, if `key` isn't in the map. `make` is called under the
+        /// lock of the stripe of `key`, so at most once per insertion, and
+        /// the value can depend on not being inserted concurrently, like a
+        /// counter.
+        ///
+        /// \returns A copy of the value with the key `key`, whether it was
+        /// inserted or not.
+        template <typename F>
+        T find_or_insert(const guid& key, F&& make)
+        {
+            const auto h = hash_of(key);
+            detail::epoch_guard guard;
+            help_migrate();
+
+            auto& s = stripe_of(h);
+            std::lock_guard<std::mutex> lock(s.mutex);
+            auto& bucket = locked_bucket(h);
+            auto* head = bucket.load(std::memory_order_relaxed);
+            for (auto* p = head; p != nullptr;
+                 p = p->next.load(std::memory_order_relaxed)) {
+                if (static_cast<node*>(p)->key == key) {
+                    return static_cast<node*>(p)->value;
+                }
+            }
+            auto* n = new node(key, h, make());
+            n->next.store(head, std::memory_order_relaxed);
+            bucket.store(n, std::memory_order_release);
+            s.size.store(s.size.load(std::memory_order_relaxed) + 1,
+                         std::memory_order_relaxed);
+            // Under the lock, since the node could be erased as soon as
+            // it's released. Growing doesn't take stripe locks.
+            grow_if_needed(s);
+            return n->value;
+        }
+
+        /// \effects Erases the element with the key `key`, if there is one.
+        /// \returns `true` if an element was erased.
+        bool erase(const guid& key)
+        {
+            const auto h = hash_of(key);
+            detail::epoch_guard guard;
+            help_migrate();
+
+            auto& s = stripe_of(h);
+            node* erased = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(s.mutex);
+                std::atomic<detail::concurrent_node_base*>* link =
+                    &locked_bucket(h);
+                for (auto* p = link->load(std::memory_order_relaxed);
+                     p != nullptr; p = link->load(std::memory_order_relaxed)) {
+                    if (static_cast<node*>(p)->key == key) {
+                        erased = static_cast<node*>(p);
+                        break;
+                    }
+                    link = &p->next;
+                }
+                if (erased == nullptr) {
+                    return false;
+                }
+                link->store(erased->next.load(std::memory_order_relaxed),
+                            std::memory_order_release);
+                s.size.store(s.size.load(std::memory_order_relaxed) - 1,
+                             std::memory_order_relaxed);
+            }
+            detail::epoch_retire(erased);
+            return true;
+        }
+
+        /// \effects Calls `f(value)` with a const reference to the value
+        /// with the key `key`, if there is one. The value stays valid until
+        /// `f` returns, even if the element is erased or assigned
+        /// meanwhile.
+        ///
+        /// \returns `true` if there was a value.
+        ///
+        /// \notes Lock-free.
+        /// \output_section Lookup
+        template <typename F>
+        bool visit(const guid& key, F&& f) const
+        {
+            const auto h = hash_of(key);
+            detail::epoch_guard guard;
+            const table* t = _table.load(std::memory_order_acquire);
+            for (;;) {
+                const detail::concurrent_node_base* p =
+                    t->buckets[h & t->mask].load(std::memory_order_acquire);
+                if (p == detail::moved_bucket()) {
+                    t = t->next.load(std::memory_order_acquire);
+                    continue;
+                }
+                for (; p != nullptr;
+                     p = p->next.load(std::memory_order_acquire)) {
+                    const auto* n = static_cast<const node*>(p);
+                    if (n->key == key) {
+                        f(n->value);
+                        return true;
+                    }
+                }
+                return false;
+            }
+        }
+
+        /// \effects Copies the value with the key `key` to `out`, if there
+        /// is one.
+        /// \returns `true` if there was a value, `false` if `out` is left as
+        /// is.
+        /// \notes Lock-free.
+        bool find(const guid& key, T& out) const
+        {
+            return visit(key, [&out](const T& value) { out = value; });
+        }
+
+        /// \returns `true` if there's an element with the key `key`.
+        /// \notes Lock-free.
+        bool contains(const guid& key) const
+        {
+            return visit(key, [](const T&) {});
+        }
+
+        /// \returns The number of elements. It can change at any time if
+        /// other threads are modifying the map.
+        /// \output_section Capacity
+        std::size_t size() const noexcept
+        {
+            std::size_t n = 0;
+            for (std::size_t i = 0; i < stripe_count; ++i) {
+                n += _stripes[i].size.load(std::memory_order_relaxed);
+            }
+            return n;
+        }
+        /// \returns `true` if there are no elements.
+        bool empty() const noexcept
+        {
+            return size() == 0;
+        }
+
+        /// \returns The number of buckets of the current table, the one the
+        /// elements are being moved to if the map is growing.
+        std::size_t bucket_count() const
+        {
+            detail::epoch_guard guard;
+            const table* t = _table.load(std::memory_order_acquire);
+            const table* next = t->next.load(std::memory_order_acquire);
+            return (next != nullptr ? next->mask : t->mask) + 1;
+        }
+
+    private:
+        // A power of 2, and the minimum number of buckets, so that the
+        // stripe of a bucket is the same in every table
+        static const std::size_t stripe_count = 256;
+        // Buckets moved to the next table per writer that helps
+        static const std::size_t migrate_chunk = 64;
+
+        struct node : detail::concurrent_node_base {
+            template <typename M>
+            node(const guid& k, std::size_t h, M&& v)
+                : key(k), hash(h), value(std::forward<M>(v))
+            {
+            }
+
+            guid key;
+            std::size_t hash;
+            T value;
+        };
+
+        struct table {
+            explicit table(std::size_t n)
+                : buckets(new std::atomic<detail::concurrent_node_base*>[n]),
+                  mask(n - 1)
+            {
+                for (std::size_t i = 0; i < n; ++i) {
+                    buckets[i].store(nullptr, std::memory_order_relaxed);
+                }
+            }
+
+            std::unique_ptr<std::atomic<detail::concurrent_node_base*>[]>
+                buckets;
+            std::size_t mask;
+            // The larger table the buckets are being moved to
+            std::atomic<table*> next{nullptr};
+            // Held by the writer moving buckets, which are moved in order:
+            // the first `migrated` are
+            std::mutex migrate_mutex;
+            std::size_t migrated{0};
+        };
+
+        struct stripe {
+            std::mutex mutex;
+            // The number of elements in the buckets of the stripe, modified
+            // under the lock
+            std::atomic<std::size_t> size{0};
+            // So that writers of different stripes don't share cache lines
+            char pad[64];
+        };
+
+        std::size_t hash_of(const guid& key) const
+        {
+            return _hash(key);
+        }
+
+        stripe& stripe_of(std::size_t h) const noexcept
+        {
+            return _stripes[h & (stripe_count - 1)];
+        }
+
+        // The bucket of `h` in the newest table that has it. Buckets are
+        // only moved under the lock of their stripe, which the caller
+        // holds.
+        std::atomic<detail::concurrent_node_base*>& locked_bucket(
+            std::size_t h) const noexcept
+        {
+            table* t = _table.load(std::memory_order_acquire);
+            for (;;) {
+                auto& bucket = t->buckets[h & t->mask];
+                if (bucket.load(std::memory_order_relaxed) !=
+                    detail::moved_bucket()) {
+                    return bucket;
+                }
+                t = t->next.load(std::memory_order_acquire);
+            }
+        }
+
+        // Starts growing if the stripe `s` has more elements than buckets.
+        // Called in a guard.
+        void grow_if_needed(stripe& s) noexcept
+        {
+            table* t = _table.load(std::memory_order_acquire);
+            if (s.size.load(std::memory_order_relaxed) <=
+                    (t->mask + 1) / stripe_count ||
+                t->next.load(std::memory_order_acquire) != nullptr) {
+                return;
+            }
+            table* larger = nullptr;
+            try {
+                larger = new table(2 * (t->mask + 1));
+            }
+            catch (const std::bad_alloc&) {
+                // Stay at the current size, and try again on the next
+                // insertion
+                return;
+            }
+            table* expected = nullptr;
+            if (!t->next.compare_exchange_strong(expected, larger,
+                                                 std::memory_order_acq_rel,
+                                                 std::memory_order_acquire)) {
+                delete larger;
+            }
+        }
+
+        // Moves the next few buckets to the larger table, if the map is
+        // growing and no other writer is moving them
+        void help_migrate()
+        {
+            table* t = _table.load(std::memory_order_acquire);
+            table* larger = t->next.load(std::memory_order_acquire);
+            if (larger == nullptr) {
+                return;
+            }
+            std::unique_lock<std::mutex> lock(t->migrate_mutex,
+                                              std::try_to_lock);
+            if (!lock.owns_lock() ||
+                _table.load(std::memory_order_acquire) != t) {
+                return;
+            }
+            const std::size_t count = t->mask + 1;
+            const auto end = std::min(t->migrated + migrate_chunk, count);
+            for (; t->migrated < end; ++t->migrated) {
+                migrate_bucket(*t, *larger, t->migrated);
+            }
+            if (t->migrated == count) {
+                _table.store(larger, std::memory_order_release);
+                lock.unlock();
+                detail::epoch_retire(t);
+            }
+        }
+
+        // Moves the elements of bucket `b` of `from` to `to`, and marks it
+        // as moved. Readers see either the old chain or the new ones.
+        //
+        // The elements go to two buckets of `to`. As in Java's
+        // ConcurrentHashMap, the nodes at the end of the chain that all go
+        // to the same one are linked there as they are, since the old chain
+        // stays valid through them, and only the nodes before them are
+        // copied. With short chains, that's most of the nodes.
+        void migrate_bucket(table& from, table& to, std::size_t b)
+        {
+            std::lock_guard<std::mutex> lock(stripe_of(b).mutex);
+            auto& bucket = from.buckets[b];
+            auto* head = bucket.load(std::memory_order_relaxed);
+
+            detail::concurrent_node_base* last_run = head;
+            for (auto* p = head; p != nullptr;
+                 p = p->next.load(std::memory_order_relaxed)) {
+                if ((static_cast<node*>(p)->hash & to.mask) !=
+                    (static_cast<node*>(last_run)->hash & to.mask)) {
+                    last_run = p;
+                }
+            }
+
+            // Copy the rest first, so that nothing is published if a copy
+            // throws
+            detail::concurrent_node_base* copies = nullptr;
+            try {
+                for (auto* p = head; p != last_run;
+                     p = p->next.load(std::memory_order_relaxed)) {
+                    const auto* old = static_cast<node*>(p);
+                    auto* copy = new node(old->key, old->hash, old->value);
+                    copy->next.store(copies, std::memory_order_relaxed);
+                    copies = copy;
+                }
+            }
+            catch (...) {
+                while (copies != nullptr) {
+                    auto* next = copies->next.load(std::memory_order_relaxed);
+                    delete static_cast<node*>(copies);
+                    copies = next;
+                }
+                throw;
+            }
+
+            // Both buckets of `to` are empty until `b` is marked as moved
+            if (last_run != nullptr) {
+                to.buckets[static_cast<node*>(last_run)->hash & to.mask]
+                    .store(last_run, std::memory_order_release);
+            }
+            while (copies != nullptr) {
+                auto* copy = static_cast<node*>(copies);
+                copies = copy->next.load(std::memory_order_relaxed);
+                auto& target = to.buckets[copy->hash & to.mask];
+                copy->next.store(target.load(std::memory_order_relaxed),
+                                 std::memory_order_relaxed);
+                target.store(copy, std::memory_order_release);
+            }
+            bucket.store(detail::moved_bucket(), std::memory_order_release);
+
+            for (auto* p = head; p != last_run;) {
+                auto* next = p->next.load(std::memory_order_relaxed);
+                detail::epoch_retire(static_cast<node*>(p));
+                p = next;
+            }
+        }
+
+        Hash _hash;
+        std::unique_ptr<stripe[]> _stripes;
+        std::atomic<table*> _table{nullptr};
+    };
+
+    template <typename T, typename Hash>
+    const std::size_t concurrent_guid_map<T, Hash>::stripe_count;
+    template <typename T, typename Hash>
+    const std::size_t concurrent_guid_map<T, Hash>::migrate_chunk;
+}  // namespace xg
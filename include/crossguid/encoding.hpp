@@ -0,0 +1,133 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#pragma once
+
+#include "guid.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+
+namespace xg {
+    /// Compact textual encodings of the byte representation of a GUID.
+    ///
+    /// Every encoding has a fixed length, given by [xg::encoded_size]().
+    enum class encoding {
+        /// Base64 with the URL and filename safe alphabet of RFC 4648
+        /// (`A-Z`, `a-z`, `0-9`, `-` and `_`), without padding:
+        /// 22 characters.
+        base64url,
+        /// Crockford's base32 (`0-9` and `A-Z` without `I`, `L`, `O` and
+        /// `U`) of the bytes as a 128-bit big-endian integer, like a ULID:
+        /// 26 characters, the first one `0-7`.
+        /// Sorts in the same order as the byte representation.
+        base32,
+        /// Base58 with the Bitcoin alphabet of the bytes as a 128-bit
+        /// big-endian integer, left-padded with `1` (the zero digit):
+        /// 22 characters.
+        /// Sorts in the same order as the byte representation.
+        base58
+    };
+
+    /// \returns The number of characters in a GUID encoded with `e`.
+    constexpr std::size_t encoded_size(encoding e) noexcept
+    {
+        return e == encoding::base32 ? 26 : 22;
+    }
+
+    namespace detail {
+        /// Writes the `encoded_size(e)` characters of `bytes` encoded with
+        /// `e` to `out`.
+        void encode(const unsigned char* bytes,
+                    encoding e,
+                    char* out) noexcept;
+    }  // namespace detail
+
+    /// \effects Writes `g` encoded with `e` to the range beginning at `it`.
+    ///
+    /// \requires The range must hold `encoded_size(e)` characters.
+    ///
+    /// \returns Iterator past the last character written.
+    ///
+    /// \throws Any exceptions thrown by the iterator.
+    ///
+    /// \notes Base64url converts 12 of the bytes at once with SSE4.1 shuffles
+    /// where available, selected at runtime. The others work on 64-bit
+    /// halves of the GUID, and base58 on limbs of 5 digits.
+    template <typename OutputIt>
+    OutputIt encode_to(const guid& g, encoding e, OutputIt it)
+    {
+        char buf[26];
+        detail::encode(g.bytes().data(), e, buf);
+        return std::copy(buf, buf + encoded_size(e), it);
+    }
+
+    /// \returns `g` encoded with `e`.
+    ///
+    /// \throws Any exceptions thrown by `std::string`.
+    inline std::string encode(const guid& g, encoding e)
+    {
+        std::string s(encoded_size(e), '\0');
+        encode_to(g, e, s.begin());
+        return s;
+    }
+
+    /// Decodes a GUID encoded with `e` at the beginning of `[first, last)`,
+    /// like [xg::parse]().
+    ///
+    /// Exactly `encoded_size(e)` characters are consumed, and anything can
+    /// follow them.
+    /// Decoding is strict, so that every GUID has one encoding:
+    /// base64url rejects padding and nonzero unused bits, and base32 rejects
+    /// values above 128 bits, as does base58.
+    /// Base32 accepts lowercase letters, and `I`, `L` and `O` as `1`, `1` and
+    /// `0`, as Crockford specifies.
+    ///
+    /// \returns A [xg::parse_result]() with the GUID and the end of the
+    /// consumed input.
+    ///
+    /// \notes Doesn't allocate, branch on the characters, or consult the
+    /// locale. Base64url validates and converts 16 characters at once with
+    /// SSE4.1 where available.
+    ///
+    /// \unique_name decode_range
+    parse_result decode(const char* first,
+                        const char* last,
+                        encoding e) noexcept;
+
+    /// Decodes a GUID encoded with `e` at the beginning of `s`, which can be
+    /// any contiguous character sequence with `data()` and `size()`.
+    ///
+    /// \effects Equivalent to `decode(s.data(), s.data() + s.size(), e)`.
+    ///
+    /// \unique_name decode_string
+    template <typename String>
+    auto decode(const String& s, encoding e) noexcept
+        -> decltype(static_cast<const char*>(s.data()) + s.size(),
+                    parse_result{})
+    {
+        return decode(s.data(), s.data() + s.size(), e);
+    }
+}  // namespace xg
@@ -0,0 +1,77 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+// Epoch-based memory reclamation for the lock-free readers of the
+// concurrent containers. An implementation detail of the library, like the
+// detail namespaces of the other headers.
+
+#pragma once
+
+namespace xg {
+    namespace detail {
+        /// \exclude
+        /// Marks the current thread as reading shared pointers for as long
+        /// as it's alive, so that the objects retired with [epoch_retire]()
+        /// meanwhile are kept alive. Guards can be nested.
+        ///
+        /// The global epoch only advances when every thread in a guard has
+        /// seen the current one, and an object retired in epoch `e` is
+        /// destroyed once the epoch is `e + 2`: no thread can still be in a
+        /// guard that began before the object was unlinked.
+        ///
+        /// The first guard of a thread allocates its record, and throws
+        /// `std::bad_alloc` if it can't.
+        class epoch_guard {
+        public:
+            epoch_guard();
+            ~epoch_guard();
+
+            epoch_guard(const epoch_guard&) = delete;
+            epoch_guard& operator=(const epoch_guard&) = delete;
+
+        private:
+            void* _record;
+        };
+
+        /// \exclude
+        /// Destroys `p` with `deleter(p)` once no thread can hold a pointer
+        /// to it anymore, from any thread that retires objects later.
+        /// \requires `p` must be unreachable from the shared data, and the
+        /// calling thread must be in an [epoch_guard]().
+        /// \notes Doesn't allocate while there's room left for the objects
+        /// retired by the thread. If there isn't and memory runs out, the
+        /// objects that can be are destroyed to make room, and if none can,
+        /// `p` is leaked rather than destroyed early.
+        void epoch_retire(void* p, void (*deleter)(void*)) noexcept;
+
+        /// \exclude
+        /// Typed [epoch_retire]() of an object created with `new`.
+        template <typename T>
+        void epoch_retire(T* p) noexcept
+        {
+            epoch_retire(static_cast<void*>(p),
+                         [](void* q) { delete static_cast<T*>(q); });
+        }
+    }  // namespace detail
+}  // namespace xg
@@ -0,0 +1,166 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#pragma once
+
+#include "guid.hpp"
+
+#include <cstddef>
+
+#if defined(__has_include)
+#if __has_include(<version>)
+#include <version>
+#endif
+#endif
+
+// Check for C++20 std::format
+#ifndef XG_HAS_STD_FORMAT
+#if defined(__cpp_lib_format) && __cpp_lib_format >= 201907L
+#define XG_HAS_STD_FORMAT 1
+#else
+#define XG_HAS_STD_FORMAT 0
+#endif
+#endif  // !defined(XG_HAS_STD_FORMAT)
+
+#if XG_HAS_STD_FORMAT
+#include <format>
+#include <string_view>
+#endif
+
+// {fmt} support: include <fmt/format.h> before this header, or define
+// XG_FMT to have it included here
+#if defined(XG_FMT) && !defined(FMT_VERSION)
+#include <fmt/format.h>
+#endif
+
+namespace xg {
+    namespace detail {
+        /// \exclude
+        /// Parses the format spec of a GUID in `[first, last)`, up to the
+        /// closing brace, into `flags`.
+        /// \returns The end of the spec. If a character is unknown, sets
+        /// `valid` to `false` and returns it instead.
+        template <typename It>
+        XG_CONSTEXPR14 It parse_format_spec(It first,
+                                            It last,
+                                            format_flags& flags,
+                                            bool& valid) noexcept
+        {
+            valid = true;
+            for (; first != last && *first != '}'; ++first) {
+                switch (*first) {
+                    case 'x':
+                        break;
+                    case 'X':
+                        flags = flags | format_flags::uppercase;
+                        break;
+                    case 'n':
+                        flags = flags | format_flags::no_hyphens;
+                        break;
+                    case 'b':
+                        flags = flags | format_flags::braces;
+                        break;
+                    default:
+                        valid = false;
+                        return first;
+                }
+            }
+            return first;
+        }
+    }  // namespace detail
+}  // namespace xg
+
+#if XG_HAS_STD_FORMAT
+namespace std {
+    /// Formats GUIDs with `std::format`, without creating a `std::string`
+    /// first.
+    ///
+    /// The format spec is any combination of `x` (lowercase, the default),
+    /// `X` (uppercase), `n` (no hyphens) and `b` (in braces), like
+    /// `std::format("{:Xb}", g)`.
+    template <>
+    struct formatter<xg::guid, char> {
+        constexpr auto parse(std::format_parse_context& ctx)
+            -> decltype(ctx.begin())
+        {
+            bool valid = true;
+            const auto it = xg::detail::parse_format_spec(
+                ctx.begin(), ctx.end(), flags, valid);
+            if (!valid) {
+                throw std::format_error("invalid format spec for xg::guid");
+            }
+            return it;
+        }
+
+        template <typename FormatContext>
+        auto format(const xg::guid& g, FormatContext& ctx) const
+            -> decltype(ctx.out())
+        {
+            char text[38];
+            const auto end = g.str_to(text, flags);
+            return std::formatter<std::string_view, char>{}.format(
+                std::string_view(text, static_cast<std::size_t>(end - text)),
+                ctx);
+        }
+
+        xg::format_flags flags{xg::format_flags::none};
+    };
+}  // namespace std
+#endif  // XG_HAS_STD_FORMAT
+
+#ifdef FMT_VERSION
+namespace fmt {
+    /// Formats GUIDs with {fmt}, like `fmt::format("{:Xb}", g)`, with the
+    /// same format specs as `std::formatter<xg::guid>`.
+    template <>
+    struct formatter<xg::guid, char> {
+        XG_CONSTEXPR14 auto parse(fmt::format_parse_context& ctx)
+            -> decltype(ctx.begin())
+        {
+            bool valid = true;
+            const auto it = xg::detail::parse_format_spec(
+                ctx.begin(), ctx.end(), flags, valid);
+            if (!valid) {
+                throw fmt::format_error("invalid format spec for xg::guid");
+            }
+            return it;
+        }
+
+        template <typename FormatContext>
+        auto format(const xg::guid& g, FormatContext& ctx) const
+            -> decltype(ctx.out())
+        {
+            // Through the string formatter, which writes to the buffer
+            // underlying ctx.out() at once instead of character by character
+            char text[38];
+            const auto end = g.str_to(text, flags);
+            return fmt::formatter<fmt::string_view, char>{}.format(
+                fmt::string_view(text, static_cast<std::size_t>(end - text)),
+                ctx);
+        }
+
+        xg::format_flags flags{xg::format_flags::none};
+    };
+}  // namespace fmt
+#endif  // FMT_VERSION
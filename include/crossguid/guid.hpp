@@ -24,16 +24,28 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <iosfwd>
+#include <iterator>
 #include <string>
+#include <system_error>
+#include <type_traits>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
 
 // Check for C++14 constexpr
 #ifndef XG_HAS_RELAXED_CONSTEXPR
-#if (defined(__cpp_constexpr) && __cpp_constexpr >= 201304L) || \
-    (defined(__GNUC__) && __GNUC__ >= 5) ||                     \
-    (defined(__clang__) && defined(__clang_minor__) &&          \
-     (__clang__ * 100 + __clang_minor__) >= 304) ||             \
+#if (defined(__cpp_constexpr) && __cpp_constexpr >= 201304L) ||     \
+    (defined(__GNUC__) && __GNUC__ >= 5 && __cplusplus >= 201402L) || \
+    (defined(__clang__) && defined(__clang_minor__) &&              \
+     (__clang__ * 100 + __clang_minor__) >= 304 &&                  \
+     __cplusplus >= 201402L) ||                                     \
     (defined(_MSC_VER) && _MSC_VER >= 1910)
 #define XG_HAS_RELAXED_CONSTEXPR 1
 #else
@@ -46,10 +58,88 @@
 #define XG_CONSTEXPR14 constexpr
 #else
 /// \exclude
-#define XG_CONSTEXPR14 /*constexpr*/
+/// Still implies inline, like constexpr, for the functions at namespace
+/// scope.
+#define XG_CONSTEXPR14 inline
+#endif
+
+// Check for C++20 consteval
+#ifndef XG_HAS_CONSTEVAL
+#if defined(__cpp_consteval) && __cpp_consteval >= 201811L
+#define XG_HAS_CONSTEVAL 1
+#else
+#define XG_HAS_CONSTEVAL 0
+#endif
+#endif  // !defined(XG_HAS_CONSTEVAL)
+
+#if XG_HAS_CONSTEVAL
+/// \exclude
+#define XG_CONSTEVAL consteval
+#else
+/// \exclude
+#define XG_CONSTEVAL XG_CONSTEXPR14
+#endif
+
+// Check for C++20 operator<=>
+#ifndef XG_HAS_THREE_WAY_COMPARISON
+#if defined(__cpp_impl_three_way_comparison) && \
+    __cpp_impl_three_way_comparison >= 201907L && defined(__has_include)
+#if __has_include(<compare>)
+#define XG_HAS_THREE_WAY_COMPARISON 1
+#endif
+#endif
+#ifndef XG_HAS_THREE_WAY_COMPARISON
+#define XG_HAS_THREE_WAY_COMPARISON 0
+#endif
+#endif  // !defined(XG_HAS_THREE_WAY_COMPARISON)
+
+#if XG_HAS_THREE_WAY_COMPARISON
+#include <compare>
 #endif
 
 namespace xg {
+    /// Options for the textual representation of a GUID.
+    ///
+    /// Flags can be combined with `|`.
+    enum class format_flags : unsigned {
+        /// Lowercase hexadecimal digits in 5 groups separated by hyphens,
+        /// 36 characters total.
+        none = 0,
+        /// Uppercase hexadecimal digits.
+        uppercase = 1,
+        /// No hyphens, just the 32 hexadecimal digits.
+        no_hyphens = 2,
+        /// Enclosed in braces, like the Windows registry:
+        /// `{7bcd757f-5b10-4f9b-af69-1a1f226f3b3e}`.
+        braces = 4
+    };
+
+    /// \returns The union of the flags in `a` and `b`.
+    constexpr format_flags operator|(format_flags a, format_flags b) noexcept
+    {
+        return static_cast<format_flags>(static_cast<unsigned>(a) |
+                                         static_cast<unsigned>(b));
+    }
+    /// \returns The intersection of the flags in `a` and `b`.
+    constexpr format_flags operator&(format_flags a, format_flags b) noexcept
+    {
+        return static_cast<format_flags>(static_cast<unsigned>(a) &
+                                         static_cast<unsigned>(b));
+    }
+
+    /// \returns The number of characters in a textual representation
+    /// formatted with `flags`.
+    constexpr std::size_t formatted_size(format_flags flags) noexcept
+    {
+        return std::size_t{(flags & format_flags::no_hyphens) ==
+                                   format_flags::none
+                               ? 36u
+                               : 32u} +
+               std::size_t{(flags & format_flags::braces) == format_flags::none
+                               ? 0u
+                               : 2u};
+    }
+
     /// A GUID (Globally Unique IDentifier)/UUID (Universally Unique
     /// IDentifier).
     ///
@@ -64,6 +154,11 @@ namespace xg {
     /// There is a special GUID value, called the nil value, which has all of
     /// its bits in its byte representation set to `0`. The nil value represents
     /// an invalid GUID.
+    ///
+    /// A GUID is trivially copyable and standard-layout, and consists of its
+    /// byte representation only, with no padding and an alignment of 1, so
+    /// that arrays of GUIDs can be written to and read from files or memory
+    /// as they are, like by [xg::guid_column]().
     class guid {
     public:
         /// \effects Constructs a nil GUID.
@@ -112,6 +207,17 @@ namespace xg {
         ///
         /// \unique_name str_ret
         std::string str() const;
+        /// \effects Equivalent to:
+        /// `std::string s; s.resize(formatted_size(flags));
+        /// guid.str_to(s.begin(), flags); return s;`.
+        ///
+        /// \returns The textual representation of the GUID contained in
+        /// `*this`, formatted according to `flags`.
+        ///
+        /// \throws Any exceptions thrown by `s`.
+        ///
+        /// \unique_name str_flags
+        std::string str(format_flags flags) const;
 
         /// \requires `OutputIt` must meet the requirements of
         /// `LegacyOutputIterator`.
@@ -130,6 +236,21 @@ namespace xg {
         /// \unique_name str_to
         template <typename OutputIt>
         OutputIt str_to(OutputIt it) const;
+        /// \requires Same as [`str_to(it)`](standardese://str_to/), except
+        /// that the range must hold `formatted_size(flags)` characters.
+        ///
+        /// \effects Assigns `char`s for the textual representation of the GUID
+        /// contained in `*this`, formatted according to `flags`, to the range
+        /// beginning at `it`.
+        ///
+        /// \returns Iterator one past the last element assigned.
+        ///
+        /// \throws Any exceptions throw by incrementing, dereferencing or
+        /// assigning to `it`.
+        ///
+        /// \unique_name str_to_flags
+        template <typename OutputIt>
+        OutputIt str_to(OutputIt it, format_flags flags) const;
 
         /// \returns A constant reference to the byte representation of the GUID
         /// contained in `*this`.
@@ -148,6 +269,14 @@ namespace xg {
             return _bytes.data();
         }
 
+        /// \returns The version of the GUID contained in `*this`: the high
+        /// nibble of byte 6, like `4` for random GUIDs and `7` for
+        /// time-ordered ones.
+        XG_CONSTEXPR14 unsigned version() const noexcept
+        {
+            return static_cast<unsigned>(_bytes[6] >> 4);
+        }
+
         /// \returns `true` if `*this` represents a valid GUID.
         /// \unique_name operator_bool
         /// \output_section Operators
@@ -163,23 +292,372 @@ namespace xg {
         std::array<unsigned char, 16> _bytes{{0}};
     };
 
-    /// \effects Streams the textual representation of `guid` into `s`.
+    static_assert(std::is_trivially_copyable<guid>::value,
+                  "xg::guid must be trivially copyable");
+    static_assert(std::is_standard_layout<guid>::value,
+                  "xg::guid must be standard-layout");
+    static_assert(sizeof(guid) == 16 && alignof(guid) == 1,
+                  "xg::guid must be 16 bytes with no alignment requirement");
+
+    /// \effects Streams the textual representation of `guid` into `s`, in
+    /// uppercase if `s` has `std::ios_base::uppercase` set, and padded to
+    /// `s.width()` with `s.fill()`, like other formatted output.
+    ///
     /// \returns `s`
+    ///
+    /// \notes Formats into a local buffer, and writes it to the stream
+    /// buffer at once.
     std::ostream& operator<<(std::ostream& s, const guid& guid);
 
+    /// \effects Skips leading whitespace, and reads a GUID in the canonical
+    /// form, or in braces, from `s` into `guid`. Sets `failbit` and leaves
+    /// `guid` as is if the characters read aren't a GUID.
+    ///
+    /// \returns `s`
+    ///
+    /// \notes Reads the 36 characters (or 38 in braces) from the stream
+    /// buffer at once, rather than one at a time.
+    std::istream& operator>>(std::istream& s, guid& guid);
+
     /// Creates a valid GUID.
     /// \effects Creates a GUID using platform APIs.
     /// \returns A valid [xg::guid]().
     guid make_guid();
 
+    /// Creates a time-ordered GUID.
+    /// \effects Creates a version 7 GUID (RFC 9562): a 48-bit Unix timestamp
+    /// in milliseconds, followed by a 12-bit counter and 62 random bits.
+    ///
+    /// \returns A valid [xg::guid]().
+    ///
+    /// \notes GUIDs created by the same process are strictly increasing when
+    /// compared with `std::less`, also across threads. The counter orders
+    /// GUIDs created within the same millisecond. It's kept together with the
+    /// timestamp in one atomic variable, and no locks are taken.
+    /// If the counter overflows, the timestamp is advanced by a millisecond
+    /// ahead of the clock.
+    guid make_guid_v7();
+
+    /// \returns The Unix timestamp in milliseconds contained in the version 7
+    /// GUID `g`.
+    /// \requires `g.version() == 7`
+    XG_CONSTEXPR14 std::uint64_t v7_timestamp(const guid& g) noexcept
+    {
+        std::uint64_t ts = 0;
+        for (std::size_t i = 0; i < 6; ++i) {
+            ts = (ts << 8) | g.bytes()[i];
+        }
+        return ts;
+    }
+
+    /// The name space ID for fully-qualified domain names (RFC 4122,
+    /// appendix C), for use with
+    /// [`make_guid_v5`](standardese://make_guid_v5_ptr/).
+    constexpr guid namespace_dns{std::array<unsigned char, 16>{
+        {0x6b, 0xa7, 0xb8, 0x10, 0x9d, 0xad, 0x11, 0xd1, 0x80, 0xb4, 0x00,
+         0xc0, 0x4f, 0xd4, 0x30, 0xc8}}};
+    /// The name space ID for URLs.
+    constexpr guid namespace_url{std::array<unsigned char, 16>{
+        {0x6b, 0xa7, 0xb8, 0x11, 0x9d, 0xad, 0x11, 0xd1, 0x80, 0xb4, 0x00,
+         0xc0, 0x4f, 0xd4, 0x30, 0xc8}}};
+    /// The name space ID for ISO object identifiers (OIDs).
+    constexpr guid namespace_oid{std::array<unsigned char, 16>{
+        {0x6b, 0xa7, 0xb8, 0x12, 0x9d, 0xad, 0x11, 0xd1, 0x80, 0xb4, 0x00,
+         0xc0, 0x4f, 0xd4, 0x30, 0xc8}}};
+    /// The name space ID for X.500 distinguished names.
+    constexpr guid namespace_x500{std::array<unsigned char, 16>{
+        {0x6b, 0xa7, 0xb8, 0x14, 0x9d, 0xad, 0x11, 0xd1, 0x80, 0xb4, 0x00,
+         0xc0, 0x4f, 0xd4, 0x30, 0xc8}}};
+
+    /// Creates a name-based GUID.
+    /// \effects Creates a version 5 GUID (RFC 4122) from the SHA-1 hash of
+    /// the name space ID `ns` and the `len` characters beginning at `name`.
+    ///
+    /// \returns A valid [xg::guid](). The same name in the same name space
+    /// always results in the same GUID.
+    ///
+    /// \unique_name make_guid_v5_ptr
+    guid make_guid_v5(const guid& ns, const char* name, std::size_t len);
+    /// \effects Equivalent to:
+    /// `make_guid_v5(ns, name.data(), name.size())`.
+    /// \unique_name make_guid_v5_str
+    inline guid make_guid_v5(const guid& ns, const std::string& name)
+    {
+        return make_guid_v5(ns, name.data(), name.size());
+    }
+
+    /// Creates a name-based GUID with MD5.
+    /// \effects Creates a version 3 GUID (RFC 4122) from the MD5 hash of
+    /// the name space ID `ns` and the `len` characters beginning at `name`.
+    ///
+    /// \notes Prefer version 5 GUIDs, unless version 3 is needed for
+    /// compatibility.
+    ///
+    /// \unique_name make_guid_v3_ptr
+    guid make_guid_v3(const guid& ns, const char* name, std::size_t len);
+    /// \effects Equivalent to:
+    /// `make_guid_v3(ns, name.data(), name.size())`.
+    /// \unique_name make_guid_v3_str
+    inline guid make_guid_v3(const guid& ns, const std::string& name)
+    {
+        return make_guid_v3(ns, name.data(), name.size());
+    }
+
+    /// Creates name-based GUIDs in bulk.
+    /// \effects Assigns `make_guid_v5(ns, names[i], lengths[i])` to `out[i]`
+    /// for every `i` in `[0, n)`.
+    ///
+    /// \returns `out + n`
+    ///
+    /// \notes On processors with AVX2, eight names are hashed at once, one
+    /// in each 32-bit lane of the vector registers.
+    ///
+    /// \unique_name make_guids_v5_ptr
+    guid* make_guids_v5(const guid& ns,
+                        const char* const* names,
+                        const std::size_t* lengths,
+                        std::size_t n,
+                        guid* out);
+    /// \requires `InputIt` must meet the requirements of
+    /// `LegacyInputIterator`, and its value type must have `data()` and
+    /// `size()` member functions, like `std::string`.
+    /// `OutputIt` must meet the requirements of `LegacyOutputIterator`.
+    ///
+    /// \effects Assigns `make_guid_v5(ns, name.data(), name.size())` to the
+    /// range beginning at `out` for every `name` in `[first, last)`.
+    ///
+    /// \returns Iterator one past the last element assigned.
+    ///
+    /// \notes Forward iterators yielding references are read in place.
+    /// The names of other iterators, like `std::istream_iterator` or ones
+    /// yielding temporaries, are copied to a local buffer first.
+    ///
+    /// \unique_name make_guids_v5_it
+    template <typename InputIt, typename OutputIt>
+    OutputIt make_guids_v5(const guid& ns,
+                           InputIt first,
+                           InputIt last,
+                           OutputIt out);
+
+    /// Creates `n` valid GUIDs.
+    /// \effects Assigns `n` GUIDs, as if created with
+    /// [`make_guid()`](standardese://xg::make_guid/), to the range beginning
+    /// at `first`.
+    ///
+    /// \returns `first + n`
+    ///
+    /// \notes On Linux, the entropy for all of the GUIDs is read from the
+    /// platform in large blocks, and the version and variant bits are set in
+    /// a single pass afterwards.
+    /// Other platforms call the GUID API once per GUID.
+    ///
+    /// \unique_name make_guids_ptr
+    guid* make_guids(guid* first, std::size_t n);
+    /// \requires `ForwardIt` must meet the requirements of
+    /// `LegacyForwardIterator`, with [xg::guid]() as its value type.
+    /// \effects Equivalent to:
+    /// `make_guids(first, std::distance(first, last))`.
+    /// \unique_name make_guids_range
+    template <typename ForwardIt>
+    ForwardIt make_guids(ForwardIt first, ForwardIt last);
+    /// \effects Fills `arr` with valid GUIDs.
+    /// \unique_name make_guids_array
+    template <std::size_t N>
+    void make_guids(std::array<guid, N>& arr)
+    {
+        make_guids(arr.data(), N);
+    }
+    /// \effects Fills `arr` with valid GUIDs.
+    /// \unique_name make_guids_c_array
+    template <std::size_t N>
+    void make_guids(guid (&arr)[N])
+    {
+        make_guids(arr, N);
+    }
+    /// \requires `OutputIt` must meet the requirements of
+    /// `LegacyOutputIterator`, with [xg::guid]() as its value type.
+    ///
+    /// \effects Assigns `n` valid GUIDs to the range beginning at `it`.
+    /// They are generated in batches into a local buffer, see
+    /// [`make_guids(first, n)`](standardese://make_guids_ptr/).
+    ///
+    /// \returns Iterator one past the last element assigned.
+    ///
+    /// \unique_name make_guids_it
+    template <typename OutputIt>
+    OutputIt make_guids(OutputIt it, std::size_t n);
+
     /// Creates a GUID from a byte representation.
     /// \requires Range starting from `p` must be at least 16 elements long.
     guid make_guid_from_bytes(unsigned char* p);
 
+    namespace detail {
+        /// \exclude
+        constexpr int constexpr_hex_value(char ch) noexcept
+        {
+            return ch >= '0' && ch <= '9'
+                       ? ch - '0'
+                       : ch >= 'a' && ch <= 'f'
+                             ? ch - 'a' + 10
+                             : ch >= 'A' && ch <= 'F' ? ch - 'A' + 10 : -1;
+        }
+
+        /// \exclude
+        /// Parses `[s, s + len)` into `out` with the rules of
+        /// `guid(const char*)`, without the vectorized kernels, so that it
+        /// can run in constant expressions.
+        XG_CONSTEXPR14 bool constexpr_parse(const char* s,
+                                            std::size_t len,
+                                            unsigned char (&out)[16]) noexcept
+        {
+            std::size_t digits = 0;
+            for (std::size_t i = 0; i < len; ++i) {
+                if (s[i] == '-') {
+                    continue;
+                }
+                const int value = constexpr_hex_value(s[i]);
+                if (value < 0 || digits >= 32) {
+                    return false;
+                }
+                out[digits / 2] = static_cast<unsigned char>(
+                    digits % 2 == 0 ? value << 4 : out[digits / 2] | value);
+                ++digits;
+            }
+            return digits == 32;
+        }
+
+        /// \exclude
+        constexpr guid guid_from_raw(const unsigned char (&b)[16]) noexcept
+        {
+            return guid{std::array<unsigned char, 16>{
+                {b[0], b[1], b[2], b[3], b[4], b[5], b[6], b[7], b[8], b[9],
+                 b[10], b[11], b[12], b[13], b[14], b[15]}}};
+        }
+
+        /// \exclude
+        /// Deliberately not `constexpr`: reaching it while evaluating a
+        /// GUID literal in a constant expression is a compile error.
+        inline guid malformed_guid_literal() noexcept
+        {
+            return guid{};
+        }
+    }  // namespace detail
+
+    /// Creates a GUID from the textual representation in `[s, s + len)`,
+    /// with the same rules as `guid(const char*)`.
+    ///
+    /// Unlike the constructor, it can be used in constant expressions (with
+    /// C++14 or later), so GUIDs known in advance are parsed at compile time
+    /// and stored in the binary as bytes.
+    ///
+    /// \returns The parsed GUID, or a nil GUID if `[s, s + len)` isn't a valid
+    /// GUID textual representation.
+    ///
+    /// \notes At runtime, the constructor is several times faster, since it
+    /// uses SIMD instructions when it can.
+    XG_CONSTEXPR14 guid make_guid_from_string(const char* s,
+                                              std::size_t len) noexcept
+    {
+        unsigned char bytes[16] = {};
+        return detail::constexpr_parse(s, len, bytes)
+                   ? detail::guid_from_raw(bytes)
+                   : guid{};
+    }
+
+    namespace detail {
+        /// \exclude
+        /// Reverses the byte order of the first three fields (4, 2 and 2
+        /// bytes) of the 16 bytes at `b`, which converts between the RFC 4122
+        /// and the Microsoft layouts in either direction.
+        XG_CONSTEXPR14 std::array<unsigned char, 16> swap_ms_fields(
+            const unsigned char* b) noexcept
+        {
+            return std::array<unsigned char, 16>{
+                {b[3], b[2], b[1], b[0], b[5], b[4], b[7], b[6], b[8], b[9],
+                 b[10], b[11], b[12], b[13], b[14], b[15]}};
+        }
+    }  // namespace detail
+
+    /// \returns The byte representation of `g` in the layout of the Windows
+    /// `GUID` struct, also used by SQL Server `uniqueidentifier` columns and
+    /// .NET `Guid.ToByteArray()`: the first three fields (4, 2 and 2 bytes)
+    /// in little-endian byte order, followed by the last 8 bytes as they are.
+    ///
+    /// \notes [xg::guid]() stores the fields in big-endian (RFC 4122) byte
+    /// order, so `00112233-4455-6677-8899-aabbccddeeff` is
+    /// `33 22 11 00 55 44 77 66 88 99 aa bb cc dd ee ff` in this layout.
+    /// See `<crossguid/batch.hpp>` for converting arrays of GUIDs.
+    XG_CONSTEXPR14 std::array<unsigned char, 16> to_ms_bytes(
+        const guid& g) noexcept
+    {
+        return detail::swap_ms_fields(&g.bytes()[0]);
+    }
+
+    /// \returns The GUID with the byte representation `b` in the Microsoft
+    /// layout of [xg::to_ms_bytes]().
+    /// \unique_name from_ms_bytes_array
+    XG_CONSTEXPR14 guid from_ms_bytes(
+        const std::array<unsigned char, 16>& b) noexcept
+    {
+        return guid{detail::swap_ms_fields(&b[0])};
+    }
+    /// \returns The GUID with the byte representation at `p` in the Microsoft
+    /// layout of [xg::to_ms_bytes]().
+    /// \requires `p` must point to 16 bytes.
+    /// \unique_name from_ms_bytes_ptr
+    XG_CONSTEXPR14 guid from_ms_bytes(const unsigned char* p) noexcept
+    {
+        return guid{detail::swap_ms_fields(p)};
+    }
+
+    namespace detail {
+        /// \exclude
+        inline std::uint64_t load_u64(const unsigned char* p) noexcept
+        {
+            std::uint64_t v;
+            std::memcpy(&v, p, sizeof(v));
+            return v;
+        }
+
+        /// \exclude
+        /// The 8 bytes at `p` as a big-endian integer, so that integers
+        /// compare like the bytes do.
+        inline std::uint64_t load_u64_be(const unsigned char* p) noexcept
+        {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            return load_u64(p);
+#elif defined(__GNUC__) || defined(__clang__)
+            return __builtin_bswap64(load_u64(p));
+#else
+            std::uint64_t v = 0;
+            for (std::size_t i = 0; i < 8; ++i) {
+                v = v << 8 | p[i];
+            }
+            return v;
+#endif
+        }
+
+        /// \exclude
+        inline void prefetch(const void* p) noexcept
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            __builtin_prefetch(p);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+            _mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0);
+#else
+            static_cast<void>(p);
+#endif
+        }
+    }  // namespace detail
+
     /// \returns `true` if the GUIDs contained in `lhs` and `rhs` compare equal.
+    ///
+    /// \notes Compares two 64-bit words.
     inline bool operator==(const guid& lhs, const guid& rhs) noexcept
     {
-        return lhs.bytes() == rhs.bytes();
+        return ((detail::load_u64(lhs.data()) ^ detail::load_u64(rhs.data())) |
+                (detail::load_u64(lhs.data() + 8) ^
+                 detail::load_u64(rhs.data() + 8))) == 0;
     }
 
     /// \returns `false` if the GUIDs contained in `lhs` and `rhs` compare
@@ -189,13 +667,227 @@ namespace xg {
         return !(operator==(lhs, rhs));
     }
 
+    /// \returns `true` if the byte representation of `lhs` is
+    /// lexicographically less than that of `rhs`.
+    ///
+    /// This is the order of the canonical textual representations, and the
+    /// order of creation of time-ordered GUIDs.
+    ///
+    /// \notes Compares two 64-bit words.
+    inline bool operator<(const guid& lhs, const guid& rhs) noexcept
+    {
+        const auto lhs_hi = detail::load_u64_be(lhs.data());
+        const auto rhs_hi = detail::load_u64_be(rhs.data());
+        return lhs_hi != rhs_hi ? lhs_hi < rhs_hi
+                                : detail::load_u64_be(lhs.data() + 8) <
+                                      detail::load_u64_be(rhs.data() + 8);
+    }
+
+    /// \returns `rhs < lhs`.
+    inline bool operator>(const guid& lhs, const guid& rhs) noexcept
+    {
+        return rhs < lhs;
+    }
+
+    /// \returns `!(rhs < lhs)`.
+    inline bool operator<=(const guid& lhs, const guid& rhs) noexcept
+    {
+        return !(rhs < lhs);
+    }
+
+    /// \returns `!(lhs < rhs)`.
+    inline bool operator>=(const guid& lhs, const guid& rhs) noexcept
+    {
+        return !(lhs < rhs);
+    }
+
+#if XG_HAS_THREE_WAY_COMPARISON
+    /// \returns The order of `lhs` and `rhs`, consistent with
+    /// [`operator<`](standardese://xg::operator<).
+    ///
+    /// \requires C++20.
+    inline std::strong_ordering operator<=>(const guid& lhs,
+                                            const guid& rhs) noexcept
+    {
+        const auto lhs_hi = detail::load_u64_be(lhs.data());
+        const auto rhs_hi = detail::load_u64_be(rhs.data());
+        return lhs_hi != rhs_hi ? lhs_hi <=> rhs_hi
+                                : detail::load_u64_be(lhs.data() + 8) <=>
+                                      detail::load_u64_be(rhs.data() + 8);
+    }
+#endif
+
+    /// The textual representations accepted by [xg::parse]().
+    enum class parse_mode {
+        /// The canonical form, `7bcd757f-5b10-4f9b-af69-1a1f226f3b3e`:
+        /// 36 characters, with hyphens exactly at offsets 8, 13, 18 and 23.
+        strict,
+        /// The canonical form in braces, like the Windows registry:
+        /// `{7bcd757f-5b10-4f9b-af69-1a1f226f3b3e}`.
+        braced,
+        /// The canonical form prefixed with `urn:uuid:` (RFC 4122), the
+        /// prefix in any case.
+        urn,
+        /// The rules of `guid(const char*)`: 32 hexadecimal digits with any
+        /// number of hyphens between them, optionally in braces or after
+        /// `urn:uuid:`.
+        lenient
+    };
+
+    /// The result of [xg::parse](), in the style of
+    /// `std::from_chars_result`.
+    struct parse_result {
+        /// The parsed GUID, or a nil GUID on error.
+        guid value;
+        /// Pointer to the first character not consumed, or `first` on
+        /// error.
+        const char* ptr;
+        /// `std::errc{}` on success, or `std::errc::invalid_argument` if the
+        /// beginning of the input isn't a GUID in the requested form.
+        std::errc ec;
+
+        /// \returns `true` if the parse succeeded.
+        explicit operator bool() const noexcept
+        {
+            return ec == std::errc{};
+        }
+    };
+
+    /// Parses a GUID at the beginning of `[first, last)`, like
+    /// `std::from_chars`.
+    ///
+    /// The range doesn't need to be null-terminated, and parsing stops at the
+    /// end of the GUID, so it can be followed by anything.
+    /// Hexadecimal digits can be in either case.
+    ///
+    /// \returns A [xg::parse_result]() with the GUID and the end of the
+    /// consumed input.
+    ///
+    /// \notes Doesn't allocate or consult the locale.
+    /// Canonical input uses the same vectorized kernels as
+    /// `guid(const char*)`.
+    ///
+    /// \unique_name parse_range
+    parse_result parse(const char* first,
+                       const char* last,
+                       parse_mode mode = parse_mode::strict) noexcept;
+
+    /// Parses a GUID at the beginning of `s`, which can be any contiguous
+    /// character sequence with `data()` and `size()`, like `std::string`
+    /// or `std::string_view`.
+    ///
+    /// \effects Equivalent to
+    /// `parse(s.data(), s.data() + s.size(), mode)`.
+    ///
+    /// \unique_name parse_string
+    template <typename String>
+    auto parse(const String& s, parse_mode mode = parse_mode::strict) noexcept
+        -> decltype(static_cast<const char*>(s.data()) + s.size(),
+                    parse_result{})
+    {
+        return parse(s.data(), s.data() + s.size(), mode);
+    }
+
+    inline namespace literals {
+        /// A GUID literal: `"7bcd757f-5b10-4f9b-af69-1a1f226f3b3e"_guid`.
+        ///
+        /// The string is parsed with the same rules as `guid(const char*)`.
+        /// In a constant expression (and in every use with C++20, where the
+        /// operator is `consteval`), it's parsed at compile time, and
+        /// malformed input fails to compile.
+        ///
+        /// \returns The parsed GUID. A malformed literal evaluated at runtime,
+        /// only possible before C++20, results in a nil GUID.
+        ///
+        /// \requires C++14 or later for compile time parsing.
+        XG_CONSTEVAL guid operator""_guid(const char* s,
+                                          std::size_t len) noexcept
+        {
+            unsigned char bytes[16] = {};
+            return detail::constexpr_parse(s, len, bytes)
+                       ? detail::guid_from_raw(bytes)
+                       : detail::malformed_guid_literal();
+        }
+    }  // namespace literals
+
+    namespace detail {
+        /// \exclude
+        inline void mul_u128(std::uint64_t a,
+                             std::uint64_t b,
+                             std::uint64_t& lo,
+                             std::uint64_t& hi) noexcept
+        {
+#if defined(__SIZEOF_INT128__)
+            __extension__ typedef unsigned __int128 u128;
+            const u128 r = static_cast<u128>(a) * b;
+            lo = static_cast<std::uint64_t>(r);
+            hi = static_cast<std::uint64_t>(r >> 64);
+#else
+            const std::uint64_t a_lo = a & 0xffffffff, a_hi = a >> 32;
+            const std::uint64_t b_lo = b & 0xffffffff, b_hi = b >> 32;
+            const std::uint64_t ll = a_lo * b_lo, lh = a_lo * b_hi;
+            const std::uint64_t hl = a_hi * b_lo, hh = a_hi * b_hi;
+            const std::uint64_t mid = (ll >> 32) + (lh & 0xffffffff) + hl;
+            lo = (mid << 32) | (ll & 0xffffffff);
+            hi = hh + (lh >> 32) + (mid >> 32);
+#endif
+        }
+
+        /// \exclude
+        /// Parses `[first, last)` with the rules of `guid(const char*)`.
+        /// \returns `false` if it isn't a valid GUID, leaving `out` as is.
+        bool parse_guid(const char* first,
+                        const char* last,
+                        guid& out) noexcept;
+    }  // namespace detail
+
+    /// A hash function for GUIDs that folds the two 64-bit halves of the
+    /// byte representation together with xor.
+    ///
+    /// This is the cheapest possible hash, and it's as good as any for
+    /// random (version 4) GUIDs, since all of their bits except the version
+    /// and variant are already uniformly distributed.
+    /// Don't use it for time-ordered, name-based or untrusted GUIDs: their
+    /// low bits can be predictable or chosen to collide.
+    ///
+    /// \notes Use it as the `Hash` template argument of an unordered
+    /// container: `std::unordered_map<xg::guid, T, xg::fold_hash>`.
+    struct fold_hash {
+        std::size_t operator()(const guid& g) const noexcept
+        {
+            return static_cast<std::size_t>(detail::load_u64(g.data()) ^
+                                            detail::load_u64(g.data() + 8));
+        }
+    };
+
+    /// A hash function for GUIDs that mixes all of the 128 bits of the byte
+    /// representation into every bit of the result, with two 64x64->128-bit
+    /// multiplications in the style of wyhash.
+    ///
+    /// It's safe for GUIDs of every version, including time-ordered ones, and
+    /// still only a few nanoseconds. This is what `std::hash<xg::guid>` uses.
+    struct mix_hash {
+        std::size_t operator()(const guid& g) const noexcept
+        {
+            const std::uint64_t k0 = 0xa0761d6478bd642full;
+            const std::uint64_t k1 = 0xe7037ed1a0b428dbull;
+            const std::uint64_t k2 = 0x8ebc6af09c88c6e3ull;
+
+            std::uint64_t lo, hi;
+            detail::mul_u128(detail::load_u64(g.data()) ^ k1,
+                             detail::load_u64(g.data() + 8) ^ k0, lo, hi);
+            std::uint64_t mix_lo, mix_hi;
+            detail::mul_u128(lo ^ k2, hi ^ k1, mix_lo, mix_hi);
+            return static_cast<std::size_t>(mix_lo ^ mix_hi);
+        }
+    };
+
     // definitions
 
     /// \exclude
     inline guid::operator bool() const noexcept
     {
-        guid empty;
-        return *this != empty;
+        return (detail::load_u64(data()) | detail::load_u64(data() + 8)) != 0;
     }
 
     /// \exclude
@@ -213,29 +905,61 @@ namespace xg {
         return s;
     }
 
+    /// \exclude
+    inline std::string guid::str(format_flags flags) const
+    {
+        std::string s;
+        s.resize(formatted_size(flags));
+        str_to(s.begin(), flags);
+        return s;
+    }
+
     /// \exclude
     template <typename OutputIt>
     OutputIt guid::str_to(OutputIt it) const
     {
-        char one[9], two[5], three[5], four[5], five[13];
-
-        snprintf(one, 9, "%02x%02x%02x%02x", _bytes[0], _bytes[1], _bytes[2],
-                 _bytes[3]);
-        snprintf(two, 5, "%02x%02x", _bytes[4], _bytes[5]);
-        snprintf(three, 5, "%02x%02x", _bytes[6], _bytes[7]);
-        snprintf(four, 5, "%02x%02x", _bytes[8], _bytes[9]);
-        snprintf(five, 13, "%02x%02x%02x%02x%02x%02x", _bytes[10], _bytes[11],
-                 _bytes[12], _bytes[13], _bytes[14], _bytes[15]);
-
-        it = std::copy(one, one + 8, it);
-        *it++ = '-';
-        it = std::copy(two, two + 4, it);
-        *it++ = '-';
-        it = std::copy(three, three + 4, it);
-        *it++ = '-';
-        it = std::copy(four, four + 4, it);
-        *it++ = '-';
-        it = std::copy(five, five + 12, it);
+        return str_to(it, format_flags::none);
+    }
+
+    /// \exclude
+    template <typename OutputIt>
+    OutputIt guid::str_to(OutputIt it, format_flags flags) const
+    {
+        const bool upper =
+            (flags & format_flags::uppercase) != format_flags::none;
+        const bool hyphens =
+            (flags & format_flags::no_hyphens) == format_flags::none;
+        const bool braces =
+            (flags & format_flags::braces) != format_flags::none;
+        const char* digits =
+            "0123456789abcdef0123456789ABCDEF" + (upper ? 16 : 0);
+
+        // Table lookups only; the hyphens are inserted while copying out
+        char buf[32];
+        for (std::size_t i = 0; i < 16; ++i) {
+            buf[2 * i] = digits[_bytes[i] >> 4];
+            buf[2 * i + 1] = digits[_bytes[i] & 0x0f];
+        }
+        if (braces) {
+            *it++ = '{';
+        }
+        if (!hyphens) {
+            it = std::copy(buf, buf + 32, it);
+        }
+        else {
+            it = std::copy(buf, buf + 8, it);
+            *it++ = '-';
+            it = std::copy(buf + 8, buf + 12, it);
+            *it++ = '-';
+            it = std::copy(buf + 12, buf + 16, it);
+            *it++ = '-';
+            it = std::copy(buf + 16, buf + 20, it);
+            *it++ = '-';
+            it = std::copy(buf + 20, buf + 32, it);
+        }
+        if (braces) {
+            *it++ = '}';
+        }
         return it;
     }
 
@@ -250,6 +974,109 @@ namespace xg {
     {
         _bytes.swap(other._bytes);
     }
+
+    /// \exclude
+    template <typename ForwardIt>
+    ForwardIt make_guids(ForwardIt first, ForwardIt last)
+    {
+        return make_guids(
+            first, static_cast<std::size_t>(std::distance(first, last)));
+    }
+
+    namespace detail {
+        /// \exclude
+        /// Whether the names of `It` stay valid after it's incremented, so
+        /// that a batch of them can be hashed in place.
+        template <typename It>
+        struct stable_names
+            : std::integral_constant<
+                  bool,
+                  std::is_base_of<std::forward_iterator_tag,
+                                  typename std::iterator_traits<
+                                      It>::iterator_category>::value &&
+                      std::is_reference<typename std::iterator_traits<
+                          It>::reference>::value> {};
+
+        /// \exclude
+        template <typename InputIt, typename OutputIt>
+        OutputIt make_guids_v5(const guid& ns,
+                               InputIt first,
+                               InputIt last,
+                               OutputIt out,
+                               std::true_type)
+        {
+            const char* names[64];
+            std::size_t lengths[64];
+            guid buf[64];
+            while (first != last) {
+                std::size_t n = 0;
+                for (; n < 64 && first != last; ++n, ++first) {
+                    names[n] = first->data();
+                    lengths[n] = first->size();
+                }
+                xg::make_guids_v5(ns, names, lengths, n, buf);
+                out = std::copy(buf, buf + n, out);
+            }
+            return out;
+        }
+
+        /// \exclude
+        /// Copies the names of a batch to `chars` before hashing them.
+        template <typename InputIt, typename OutputIt>
+        OutputIt make_guids_v5(const guid& ns,
+                               InputIt first,
+                               InputIt last,
+                               OutputIt out,
+                               std::false_type)
+        {
+            const char* names[64];
+            std::size_t lengths[64];
+            guid buf[64];
+            std::string chars;
+            while (first != last) {
+                chars.clear();
+                std::size_t n = 0;
+                for (; n < 64 && first != last; ++n, ++first) {
+                    const auto& name = *first;
+                    chars.append(name.data(), name.size());
+                    lengths[n] = name.size();
+                }
+                const char* p = chars.data();
+                for (std::size_t i = 0; i < n; p += lengths[i++]) {
+                    names[i] = p;
+                }
+                xg::make_guids_v5(ns, names, lengths, n, buf);
+                out = std::copy(buf, buf + n, out);
+            }
+            return out;
+        }
+    }  // namespace detail
+
+    /// \exclude
+    template <typename InputIt, typename OutputIt>
+    OutputIt make_guids_v5(const guid& ns,
+                           InputIt first,
+                           InputIt last,
+                           OutputIt out)
+    {
+        return detail::make_guids_v5(
+            ns, first, last, out,
+            typename detail::stable_names<InputIt>::type{});
+    }
+
+    /// \exclude
+    template <typename OutputIt>
+    OutputIt make_guids(OutputIt it, std::size_t n)
+    {
+        guid buf[64];
+        while (n > 0) {
+            const auto len = n < 64 ? n : std::size_t{64};
+            make_guids(buf, len);
+            it = std::copy(buf, buf + len, it);
+            n -= len;
+        }
+        return it;
+    }
 }  // namespace xg
 
 namespace std {
@@ -259,16 +1086,22 @@ namespace std {
         lhs.swap(rhs);
     }
 
+    /// Orders GUIDs with [`xg::operator<`](standardese://xg::operator<).
     template <>
     struct less<xg::guid> {
-        inline bool operator()(const xg::guid& lhs, const xg::guid& rhs) const
+        inline bool operator()(const xg::guid& lhs,
+                               const xg::guid& rhs) const noexcept
         {
-            return lhs.bytes() < rhs.bytes();
+            return lhs < rhs;
         }
     };
 
+    /// Hashes GUIDs with [xg::mix_hash]().
     template <>
     struct hash<xg::guid> {
-        std::size_t operator()(const xg::guid& guid) const;
+        std::size_t operator()(const xg::guid& guid) const noexcept
+        {
+            return xg::mix_hash{}(guid);
+        }
     };
 }  // namespace std
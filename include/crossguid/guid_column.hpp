@@ -0,0 +1,216 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#pragma once
+
+#include "guid.hpp"
+#include "mapped_file.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+namespace xg {
+    /// A GUID column file, mapped into memory read-only.
+    ///
+    /// The GUIDs are used in place in the mapping, without being copied or
+    /// parsed, so opening a file costs the same regardless of its size: the
+    /// pages are read by the operating system when they're first accessed.
+    ///
+    /// A column file, as written by [xg::guid_column_writer](), consists of
+    /// a 64-byte header followed by the 16-byte representations of the
+    /// GUIDs, back to back. The header holds these fields, little-endian,
+    /// followed by zeros:
+    /// - bytes 0-7: the magic number `"xgcolumn"`,
+    /// - bytes 8-11: the format version, `1`,
+    /// - bytes 12-15: flags, of which bit 0 is set if the GUIDs are in
+    ///   ascending order, by [`operator<`](standardese://xg::operator<),
+    /// - bytes 16-23: the number of GUIDs,
+    /// - bytes 24-31: a checksum of the GUIDs and their positions,
+    /// - bytes 32-35: the offset of the first GUID from the beginning of the
+    ///   file, a multiple of 64, so that the GUIDs are aligned to cache
+    ///   lines in the mapping,
+    /// - bytes 36-39: the size of a GUID, `16`.
+    ///
+    /// The file may continue after the last GUID, for example if a writer
+    /// was interrupted before updating the header, and those bytes are
+    /// ignored.
+    class guid_column {
+    public:
+        /// \effects Constructs an object that maps no file, with `size() ==
+        /// 0`.
+        /// \output_section Constructors
+        guid_column() noexcept = default;
+
+        /// \effects Maps the column file at `path` into memory, and checks
+        /// its header. The checksum isn't checked, see
+        /// [xg::guid_column::verify]().
+        ///
+        /// \throws `std::system_error` if the file can't be opened or mapped,
+        /// or `std::system_error` with `std::errc::invalid_argument` if it
+        /// isn't a valid column file.
+        explicit guid_column(const char* path);
+
+        guid_column(guid_column&& other) noexcept;
+        guid_column& operator=(guid_column&& other) noexcept;
+
+        /// \returns Pointer to the first GUID.
+        /// \output_section Records
+        const guid* data() const noexcept
+        {
+            return _data;
+        }
+        /// \returns The number of GUIDs.
+        std::size_t size() const noexcept
+        {
+            return _size;
+        }
+        /// \returns `true` if there are no GUIDs.
+        bool empty() const noexcept
+        {
+            return _size == 0;
+        }
+
+        const guid* begin() const noexcept
+        {
+            return _data;
+        }
+        const guid* end() const noexcept
+        {
+            return _data + _size;
+        }
+
+        /// \returns The GUID at `i`.
+        /// \requires `i < size()`.
+        const guid& operator[](std::size_t i) const noexcept
+        {
+            return _data[i];
+        }
+
+        /// \returns `true` if the file is flagged as being sorted in
+        /// ascending order, so it can be searched with
+        /// `std::lower_bound` and such.
+        bool sorted() const noexcept
+        {
+            return _sorted;
+        }
+
+        /// \returns `true` if the checksum of the GUIDs matches the one in
+        /// the header.
+        ///
+        /// \notes Reads the whole file.
+        bool verify() const noexcept;
+
+    private:
+        mapped_file _file;
+        const guid* _data{nullptr};
+        std::size_t _size{0};
+        std::uint64_t _checksum{0};
+        bool _sorted{true};
+    };
+
+    /// How [xg::guid_column_writer]() opens a file.
+    enum class column_mode {
+        /// Creates the file, or replaces its contents.
+        truncate,
+        /// Appends to an existing column file, or creates it.
+        append
+    };
+
+    /// Writes a GUID column file, in a stream.
+    ///
+    /// The GUIDs are written through a buffer as they're appended, and the
+    /// count, flags and checksum in the header are updated by
+    /// [xg::guid_column_writer::flush]() and when the writer is closed. A
+    /// reader opening the file in the meantime sees the GUIDs written up to
+    /// the last flush.
+    class guid_column_writer {
+    public:
+        /// \effects Opens the column file at `path` for writing.
+        ///
+        /// With `column_mode::append`, GUIDs are appended after those in the
+        /// file, if any, and the checksum and sortedness flag carry on from
+        /// its header.
+        ///
+        /// \throws `std::system_error` if the file can't be opened or
+        /// written, or `std::system_error` with `std::errc::invalid_argument`
+        /// if appending to a file that isn't a valid column file.
+        /// \output_section Constructors
+        explicit guid_column_writer(const char* path,
+                                    column_mode mode = column_mode::truncate);
+
+        guid_column_writer(const guid_column_writer&) = delete;
+        guid_column_writer& operator=(const guid_column_writer&) = delete;
+
+        guid_column_writer(guid_column_writer&& other) noexcept;
+        guid_column_writer& operator=(guid_column_writer&& other) noexcept;
+
+        /// \effects Closes the file, ignoring errors.
+        /// Call [xg::guid_column_writer::close]() to see them.
+        ~guid_column_writer() noexcept;
+
+        /// \effects Appends `g`.
+        /// \throws `std::system_error` if the file can't be written.
+        /// \output_section Writing
+        void append(const guid& g)
+        {
+            append(&g, &g + 1);
+        }
+
+        /// \effects Appends the GUIDs in `[first, last)`.
+        /// \throws `std::system_error` if the file can't be written.
+        void append(const guid* first, const guid* last);
+
+        /// \effects Writes the buffered GUIDs, and updates the header.
+        /// \throws `std::system_error` if the file can't be written.
+        void flush();
+
+        /// \effects Flushes, and closes the file.
+        /// \throws `std::system_error` if the file can't be written or
+        /// closed.
+        void close();
+
+        /// \returns The number of GUIDs in the file, including the ones
+        /// appended.
+        std::size_t size() const noexcept
+        {
+            return _size;
+        }
+
+        /// \returns `true` if the GUIDs in the file are in ascending order.
+        bool sorted() const noexcept
+        {
+            return _sorted;
+        }
+
+    private:
+        std::FILE* _file{nullptr};
+        // Offset of the first GUID in the file
+        std::uint64_t _offset{0};
+        std::size_t _size{0};
+        std::uint64_t _checksum{0};
+        guid _last{};
+        bool _sorted{true};
+    };
+}  // namespace xg
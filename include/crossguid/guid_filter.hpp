@@ -0,0 +1,354 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#pragma once
+
+#include "guid.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iosfwd>
+#include <vector>
+
+namespace xg {
+    namespace detail {
+        /// \exclude
+        /// The 64 bits of `g` the filters hash with. Random (version 4) GUIDs
+        /// are folded like [xg::fold_hash](), since their bits are uniformly
+        /// distributed already: the xor covers the version and variant bits
+        /// with random ones. Other versions, like time-ordered GUIDs with
+        /// predictable bits, are mixed like [xg::mix_hash]().
+        inline std::uint64_t filter_key(const guid& g) noexcept
+        {
+            // Big-endian loads, so that saved filters are portable
+            const std::uint64_t a = load_u64_be(g.data());
+            const std::uint64_t b = load_u64_be(g.data() + 8);
+            if (g.version() == 4) {
+                return a ^ b;
+            }
+            std::uint64_t lo, hi;
+            mul_u128(a ^ 0xe7037ed1a0b428dbull, b ^ 0xa0761d6478bd642full, lo,
+                     hi);
+            std::uint64_t mix_lo, mix_hi;
+            mul_u128(lo ^ 0x8ebc6af09c88c6e3ull, hi ^ 0xe7037ed1a0b428dbull,
+                     mix_lo, mix_hi);
+            return mix_lo ^ mix_hi;
+        }
+
+        /// \exclude
+        /// Maps `x` to `[0, n)` with its high bits, without a division.
+        inline std::uint64_t reduce_range(std::uint64_t x,
+                                          std::uint64_t n) noexcept
+        {
+            std::uint64_t lo, hi;
+            mul_u128(x, n, lo, hi);
+            return hi;
+        }
+
+        /// \exclude
+        /// The bit of word `i` of a Bloom filter block set for the low 32
+        /// bits `x` of a key, like the split block Bloom filters of Apache
+        /// Parquet.
+        inline std::uint64_t bloom_bit(std::uint32_t x, unsigned i) noexcept
+        {
+            static const std::uint32_t salts[8] = {
+                0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du,
+                0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u};
+            return std::uint64_t{1}
+                   << (static_cast<std::uint32_t>(x * salts[i]) >> 26);
+        }
+
+        /// \exclude
+        inline std::uint64_t rotate_left(std::uint64_t x, unsigned r) noexcept
+        {
+            return (x << r) | (x >> ((64 - r) & 63));
+        }
+
+        /// \exclude
+        /// The hash of the key `key` in an xor filter with the seed `seed`:
+        /// the finalizer of MurmurHash3, so that a new seed gives unrelated
+        /// positions if constructing the filter fails.
+        inline std::uint64_t xor_filter_hash(std::uint64_t key,
+                                             std::uint64_t seed) noexcept
+        {
+            std::uint64_t h = key + seed;
+            h = (h ^ (h >> 33)) * 0xff51afd7ed558ccdull;
+            h = (h ^ (h >> 33)) * 0xc4ceb9fe1a85ec53ull;
+            return h ^ (h >> 33);
+        }
+    }  // namespace detail
+
+    /// A blocked Bloom filter of GUIDs: a set that can answer membership
+    /// queries with false positives, but no false negatives, in a fraction of
+    /// the memory of the GUIDs themselves.
+    ///
+    /// Every GUID sets 8 bits, one in each 64-bit word, of a single 64-byte
+    /// block, so that an insertion or a query touches one cache line only.
+    /// With the default 10 bits per GUID, about 1% of the GUIDs that weren't
+    /// inserted are false positives.
+    ///
+    /// GUIDs can be inserted at any time, but not removed. Like the standard
+    /// containers, a filter can be queried from several threads at once, but
+    /// not while it's modified.
+    ///
+    /// \notes The bits of random (version 4) GUIDs are used as they are, and
+    /// the other versions are hashed first. A filter of random GUIDs chosen
+    /// by an adversary can be flooded with false positives.
+    class guid_bloom_filter {
+    public:
+        /// \effects Constructs an empty filter with no memory, which
+        /// contains nothing and can't be inserted into.
+        /// \output_section Constructors
+        guid_bloom_filter() noexcept = default;
+
+        /// \effects Constructs an empty filter with room for `capacity`
+        /// GUIDs at `bits_per_key` bits per GUID, rounded up to whole
+        /// 64-byte blocks, and at least one.
+        ///
+        /// \notes The false positive rate rises when more GUIDs than
+        /// `capacity` are inserted.
+        explicit guid_bloom_filter(std::size_t capacity,
+                                   unsigned bits_per_key = 10);
+
+        guid_bloom_filter(const guid_bloom_filter& other);
+        guid_bloom_filter& operator=(const guid_bloom_filter& other);
+        /// \effects Moves the blocks of `other`, leaving it without memory.
+        guid_bloom_filter(guid_bloom_filter&& other) noexcept;
+        /// \effects Moves the blocks of `other`, leaving it without memory.
+        guid_bloom_filter& operator=(guid_bloom_filter&& other) noexcept;
+
+        /// \effects Inserts `g`.
+        /// \requires `block_count() != 0`
+        /// \output_section Insertion and lookup
+        void insert(const guid& g) noexcept
+        {
+            const auto key = detail::filter_key(g);
+            std::uint64_t* words = block(key);
+            const auto x = static_cast<std::uint32_t>(key);
+            for (unsigned i = 0; i < 8; ++i) {
+                words[i] |= detail::bloom_bit(x, i);
+            }
+        }
+
+        /// \effects Inserts the GUIDs in `[first, last)`.
+        /// \requires `block_count() != 0`
+        /// \notes Faster than inserting them one at a time into a large
+        /// filter, since the blocks of several GUIDs are prefetched at once.
+        void insert(const guid* first, const guid* last) noexcept;
+
+        /// \returns `false` if `g` was definitely not inserted, `true` if
+        /// it probably was.
+        bool may_contain(const guid& g) const noexcept
+        {
+            if (_blocks == 0) {
+                return false;
+            }
+            const auto key = detail::filter_key(g);
+            const std::uint64_t* words = block(key);
+            const auto x = static_cast<std::uint32_t>(key);
+            std::uint64_t missing = 0;
+            for (unsigned i = 0; i < 8; ++i) {
+                missing |= detail::bloom_bit(x, i) & ~words[i];
+            }
+            return missing == 0;
+        }
+
+        /// \effects Removes every GUID, keeping the memory.
+        void clear() noexcept;
+
+        /// \returns The number of 64-byte blocks.
+        /// \output_section Memory
+        std::size_t block_count() const noexcept
+        {
+            return _blocks;
+        }
+        /// \returns The size of the bit array in bytes, `64 * block_count()`.
+        std::size_t size_in_bytes() const noexcept
+        {
+            return 64 * _blocks;
+        }
+
+        /// \effects Writes the filter to `out`, so that
+        /// [xg::guid_bloom_filter::load]() can reload it: a 32-byte header
+        /// with a magic number and the number of blocks, followed by the
+        /// blocks as little-endian 64-bit words.
+        ///
+        /// \throws Any exceptions thrown by `out`. Sets `out`'s `badbit` if
+        /// it fails to write, like the stream insertion operators.
+        /// \output_section Serialization
+        void save(std::ostream& out) const;
+
+        /// \returns A filter read from `in`, written by
+        /// [xg::guid_bloom_filter::save]().
+        ///
+        /// \throws `std::system_error` with `std::errc::invalid_argument` if
+        /// the header isn't valid or the data ends early.
+        static guid_bloom_filter load(std::istream& in);
+
+        /// \returns A filter read from the `size` bytes at `data`, written
+        /// by [xg::guid_bloom_filter::save](), for example from an
+        /// [xg::mapped_file]().
+        ///
+        /// \throws `std::system_error` with `std::errc::invalid_argument` if
+        /// the header isn't valid or the size doesn't match.
+        static guid_bloom_filter load(const void* data, std::size_t size);
+
+    private:
+        // Allocates `blocks` zeroed blocks
+        void allocate(std::size_t blocks);
+
+        std::uint64_t* block(std::uint64_t key) const noexcept
+        {
+            return _words + 8 * detail::reduce_range(key, _blocks);
+        }
+
+        // The blocks at _words, in _storage, 64-byte aligned where possible
+        std::vector<std::uint64_t> _storage;
+        std::uint64_t* _words{nullptr};
+        std::size_t _blocks{0};
+    };
+
+    /// A static xor filter of GUIDs: like [xg::guid_bloom_filter](), a set
+    /// with false positives but no false negatives, built once from all of
+    /// its GUIDs and immutable afterwards.
+    ///
+    /// Every GUID maps to 3 bytes of an array of about 1.23 bytes per GUID,
+    /// one in each third, and the bytes are chosen so that their xor is an
+    /// 8-bit fingerprint of the GUID. A query compares the xor of the 3 bytes
+    /// with the fingerprint, so about 1 in 256 (0.4%) of the GUIDs that
+    /// aren't in the filter are false positives, at 9.84 bits per GUID: less
+    /// than a Bloom filter with the same rate.
+    ///
+    /// \notes Construction takes about 50 bytes of temporary memory per
+    /// GUID.
+    class guid_xor_filter {
+    public:
+        /// \effects Constructs an empty filter, which contains nothing.
+        /// \output_section Constructors
+        guid_xor_filter() noexcept = default;
+
+        /// \effects Constructs a filter of the GUIDs in `guids`.
+        explicit guid_xor_filter(const std::vector<guid>& guids);
+
+        /// \effects Constructs a filter of the GUIDs in `[first, last)`.
+        template <typename InputIt>
+        guid_xor_filter(InputIt first, InputIt last)
+            : guid_xor_filter(std::vector<guid>(first, last))
+        {
+        }
+
+        /// \effects Constructs a filter of the GUIDs in `list`.
+        guid_xor_filter(std::initializer_list<guid> list)
+            : guid_xor_filter(std::vector<guid>(list))
+        {
+        }
+
+        /// \returns `false` if `g` is definitely not in the filter, `true`
+        /// if it probably is.
+        /// \output_section Lookup
+        bool may_contain(const guid& g) const noexcept
+        {
+            if (_block_length == 0) {
+                return false;
+            }
+            const auto h =
+                detail::xor_filter_hash(detail::filter_key(g), _seed);
+            const std::uint8_t* f = _fingerprints.data();
+            return fingerprint(h) ==
+                   (f[slot(h, 0)] ^ f[slot(h, 1)] ^ f[slot(h, 2)]);
+        }
+
+        /// \returns The number of distinct hashes of the GUIDs the filter
+        /// was constructed from, which is the number of distinct GUIDs,
+        /// except for the rare GUIDs with equal hashes.
+        std::size_t size() const noexcept
+        {
+            return _size;
+        }
+        /// \returns `true` if the filter was constructed from no GUIDs.
+        bool empty() const noexcept
+        {
+            return _size == 0;
+        }
+
+        /// \returns The size of the fingerprint array in bytes.
+        /// \output_section Memory
+        std::size_t size_in_bytes() const noexcept
+        {
+            return _fingerprints.size();
+        }
+
+        /// \effects Writes the filter to `out`, so that
+        /// [xg::guid_xor_filter::load]() can reload it without constructing
+        /// it again: a 32-byte header with a magic number, the number of
+        /// GUIDs and the seed, followed by the fingerprints.
+        ///
+        /// \throws Any exceptions thrown by `out`. Sets `out`'s `badbit` if
+        /// it fails to write, like the stream insertion operators.
+        /// \output_section Serialization
+        void save(std::ostream& out) const;
+
+        /// \returns A filter read from `in`, written by
+        /// [xg::guid_xor_filter::save]().
+        ///
+        /// \throws `std::system_error` with `std::errc::invalid_argument` if
+        /// the header isn't valid or the data ends early.
+        static guid_xor_filter load(std::istream& in);
+
+        /// \returns A filter read from the `size` bytes at `data`, written
+        /// by [xg::guid_xor_filter::save](), for example from an
+        /// [xg::mapped_file]().
+        ///
+        /// \throws `std::system_error` with `std::errc::invalid_argument` if
+        /// the header isn't valid or the size doesn't match.
+        static guid_xor_filter load(const void* data, std::size_t size);
+
+    private:
+        // Sets the size and the length of the thirds for `n` hashes
+        void resize(std::size_t n);
+
+        // Peels the hypergraph of `keys`, retrying with new seeds until it
+        // succeeds, and assigns the fingerprints
+        void build(std::vector<std::uint64_t> keys);
+
+        static std::uint8_t fingerprint(std::uint64_t h) noexcept
+        {
+            return static_cast<std::uint8_t>(h ^ (h >> 32));
+        }
+
+        // The byte of the hash `h` in third `i` of the fingerprints
+        std::size_t slot(std::uint64_t h, unsigned i) const noexcept
+        {
+            return i * _block_length +
+                   static_cast<std::size_t>(detail::reduce_range(
+                       detail::rotate_left(h, 21 * i), _block_length));
+        }
+
+        std::vector<std::uint8_t> _fingerprints;
+        std::uint64_t _seed{0};
+        std::size_t _block_length{0};
+        std::size_t _size{0};
+    };
+}  // namespace xg
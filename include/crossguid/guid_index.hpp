@@ -0,0 +1,325 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#pragma once
+
+#include "guid.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iosfwd>
+#include <iterator>
+#include <vector>
+
+namespace xg {
+    namespace detail {
+        /// \exclude
+        /// Moves from node `k` of an Eytzinger layout to the ancestor it's
+        /// the left subtree of, the in-order successor of the rightmost node
+        /// of that subtree: `k >> (trailing ones of k + 1)`.
+        inline std::size_t eytzinger_up_left(std::size_t k) noexcept
+        {
+            while ((k & 1) != 0) {
+                k >>= 1;
+            }
+            return k >> 1;
+        }
+
+        /// \exclude
+        /// Like [eytzinger_up_left](), for the ancestor `k` is in the right
+        /// subtree of.
+        inline std::size_t eytzinger_up_right(std::size_t k) noexcept
+        {
+            while (k != 0 && (k & 1) == 0) {
+                k >>= 1;
+            }
+            return k >> 1;
+        }
+    }  // namespace detail
+
+    /// An immutable sorted set of GUIDs, optimized for lookups in large sets.
+    ///
+    /// The GUIDs are stored in the Eytzinger layout of a binary search tree:
+    /// the root first, followed by its children, their children, and so on,
+    /// like a binary heap. A lookup descends from the root with one
+    /// branchless comparison per level, and the nodes 4 levels below the
+    /// current one, which are contiguous, are prefetched in the meantime,
+    /// so that the cache misses of a lookup overlap instead of forming a
+    /// chain as in a binary search of a sorted array or `std::set`.
+    /// The array is aligned so that the 4 grandchildren of a node share a
+    /// cache line.
+    ///
+    /// Iteration is in sorted order.
+    class guid_index {
+    public:
+        /// A bidirectional iterator over the GUIDs, in sorted order.
+        class const_iterator {
+        public:
+            using iterator_category = std::bidirectional_iterator_tag;
+            using value_type = guid;
+            using difference_type = std::ptrdiff_t;
+            using reference = const guid&;
+            using pointer = const guid*;
+
+            const_iterator() noexcept = default;
+
+            reference operator*() const noexcept
+            {
+                return _index->_nodes[_node];
+            }
+            pointer operator->() const noexcept
+            {
+                return &_index->_nodes[_node];
+            }
+
+            const_iterator& operator++() noexcept
+            {
+                const auto n = _index->_size;
+                if (2 * _node + 1 <= n) {
+                    // The leftmost node of the right subtree
+                    _node = 2 * _node + 1;
+                    while (2 * _node <= n) {
+                        _node *= 2;
+                    }
+                }
+                else {
+                    _node = detail::eytzinger_up_left(_node);
+                }
+                return *this;
+            }
+            const_iterator operator++(int) noexcept
+            {
+                auto tmp = *this;
+                ++*this;
+                return tmp;
+            }
+
+            const_iterator& operator--() noexcept
+            {
+                const auto n = _index->_size;
+                if (_node == 0 || 2 * _node <= n) {
+                    // The rightmost node of the left subtree, or of the tree
+                    // from the end
+                    _node = _node == 0 ? 1 : 2 * _node;
+                    while (2 * _node + 1 <= n) {
+                        _node = 2 * _node + 1;
+                    }
+                }
+                else {
+                    _node = detail::eytzinger_up_right(_node);
+                }
+                return *this;
+            }
+            const_iterator operator--(int) noexcept
+            {
+                auto tmp = *this;
+                --*this;
+                return tmp;
+            }
+
+            friend bool operator==(const const_iterator& a,
+                                   const const_iterator& b) noexcept
+            {
+                return a._node == b._node;
+            }
+            friend bool operator!=(const const_iterator& a,
+                                   const const_iterator& b) noexcept
+            {
+                return a._node != b._node;
+            }
+
+        private:
+            friend class guid_index;
+
+            const_iterator(const guid_index* index, std::size_t node) noexcept
+                : _index(index), _node(node)
+            {
+            }
+
+            const guid_index* _index{nullptr};
+            // Node number, 1 for the root, 0 for the end
+            std::size_t _node{0};
+        };
+        using iterator = const_iterator;
+        using value_type = guid;
+        using size_type = std::size_t;
+
+        /// \effects Constructs an empty index.
+        /// \output_section Constructors
+        guid_index() noexcept = default;
+
+        /// \effects Constructs an index of the GUIDs in `guids`. Duplicates
+        /// are stored once.
+        ///
+        /// \notes Sorts with [xg::sort]().
+        explicit guid_index(std::vector<guid> guids);
+
+        /// \effects Constructs an index of the GUIDs in `[first, last)`.
+        template <typename InputIt>
+        guid_index(InputIt first, InputIt last)
+            : guid_index(std::vector<guid>(first, last))
+        {
+        }
+
+        /// \effects Constructs an index of the GUIDs in `list`.
+        guid_index(std::initializer_list<guid> list)
+            : guid_index(std::vector<guid>(list))
+        {
+        }
+
+        guid_index(const guid_index& other);
+        guid_index& operator=(const guid_index& other);
+        /// \effects Moves the GUIDs of `other`, leaving it empty.
+        guid_index(guid_index&& other) noexcept;
+        /// \effects Moves the GUIDs of `other`, leaving it empty.
+        guid_index& operator=(guid_index&& other) noexcept;
+
+        /// \returns The number of GUIDs.
+        /// \output_section Lookup
+        std::size_t size() const noexcept
+        {
+            return _size;
+        }
+        /// \returns `true` if there are no GUIDs.
+        bool empty() const noexcept
+        {
+            return _size == 0;
+        }
+
+        /// \returns `true` if the index contains `g`.
+        bool contains(const guid& g) const noexcept
+        {
+            const auto it = lower_bound(g);
+            return it != end() && *it == g;
+        }
+
+        /// \returns An iterator to `g`, or `end()` if the index doesn't
+        /// contain it.
+        const_iterator find(const guid& g) const noexcept
+        {
+            const auto it = lower_bound(g);
+            return it != end() && *it == g ? it : end();
+        }
+
+        /// \returns An iterator to the first GUID not less than `g`, or
+        /// `end()`.
+        const_iterator lower_bound(const guid& g) const noexcept
+        {
+            const std::uint64_t hi = detail::load_u64_be(g.data());
+            const std::uint64_t lo = detail::load_u64_be(g.data() + 8);
+            return {this, descend(hi, lo, false)};
+        }
+
+        /// \returns An iterator to the first GUID greater than `g`, or
+        /// `end()`.
+        const_iterator upper_bound(const guid& g) const noexcept
+        {
+            const std::uint64_t hi = detail::load_u64_be(g.data());
+            const std::uint64_t lo = detail::load_u64_be(g.data() + 8);
+            return {this, descend(hi, lo, true)};
+        }
+
+        /// \returns An iterator to the smallest GUID.
+        /// \output_section Iterators
+        const_iterator begin() const noexcept
+        {
+            std::size_t k = _size == 0 ? 0 : 1;
+            while (2 * k <= _size && k != 0) {
+                k *= 2;
+            }
+            return {this, k};
+        }
+        /// \returns The end iterator.
+        const_iterator end() const noexcept
+        {
+            return {this, 0};
+        }
+
+        /// \effects Writes the index to `out`, so that [xg::guid_index::load]()
+        /// can reload it without sorting or rebuilding: a 32-byte header
+        /// with a magic number and the number of GUIDs, followed by the
+        /// GUIDs in their stored order.
+        ///
+        /// \throws Any exceptions thrown by `out`. Sets `out`'s `badbit` if
+        /// it fails to write, like the stream insertion operators.
+        /// \output_section Serialization
+        void save(std::ostream& out) const;
+
+        /// \returns An index read from `in`, written by
+        /// [xg::guid_index::save]().
+        ///
+        /// \throws `std::system_error` with `std::errc::invalid_argument` if
+        /// the header isn't valid or the data ends early.
+        static guid_index load(std::istream& in);
+
+        /// \returns An index read from the `size` bytes at `data`, written by
+        /// [xg::guid_index::save](), for example from an
+        /// [xg::mapped_file]().
+        ///
+        /// \throws `std::system_error` with `std::errc::invalid_argument` if
+        /// the header isn't valid or the size doesn't match.
+        static guid_index load(const void* data, std::size_t size);
+
+    private:
+        // Allocates the nodes of an index of `n` GUIDs
+        void allocate(std::size_t n);
+
+        // The node of the first GUID not less than (or greater than, with
+        // `upper`) the GUID (hi, lo), or 0
+        std::size_t descend(std::uint64_t hi,
+                            std::uint64_t lo,
+                            bool upper) const noexcept
+        {
+            const guid* nodes = _nodes;
+            std::size_t k = 1;
+            while (k <= _size) {
+                // The 16 descendants 4 levels down, 4 cache lines
+                const auto ahead = reinterpret_cast<std::uintptr_t>(nodes) +
+                                   16 * k * sizeof(guid);
+                for (std::size_t line = 0; line < 4; ++line) {
+                    detail::prefetch(
+                        reinterpret_cast<const void*>(ahead + 64 * line));
+                }
+
+                const std::uint64_t node_hi =
+                    detail::load_u64_be(nodes[k].data());
+                const std::uint64_t node_lo =
+                    detail::load_u64_be(nodes[k].data() + 8);
+                const bool go_right =
+                    upper ? node_hi < hi || (node_hi == hi && node_lo <= lo)
+                          : node_hi < hi || (node_hi == hi && node_lo < lo);
+                k = 2 * k + static_cast<std::size_t>(go_right);
+            }
+            // The last node where the search went left
+            return detail::eytzinger_up_left(k);
+        }
+
+        // Nodes 1 to _size of the tree at _nodes[1] to _nodes[_size], in
+        // _storage, with _nodes 64-byte aligned where possible
+        std::vector<guid> _storage;
+        const guid* _nodes{nullptr};
+        std::size_t _size{0};
+    };
+}  // namespace xg
@@ -0,0 +1,178 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#pragma once
+
+#include "concurrent_guid_map.hpp"
+#include "guid.hpp"
+#include "guid_column.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace xg {
+    /// Assigns each distinct GUID a dense 32-bit handle, so that records
+    /// referring to the same GUIDs many times, like the edges of a graph,
+    /// can store 4 bytes instead of 16.
+    ///
+    /// Handles are assigned in order from 0, and never change. The GUID of
+    /// every handle is stored in one contiguous array indexed by the handle,
+    /// and the handle of every GUID in an [xg::concurrent_guid_map](), so
+    /// both lookups are O(1) and lock-free.
+    ///
+    /// Any number of threads can intern GUIDs at once. Interning one that
+    /// already has a handle is a lock-free lookup. Assigning a new handle
+    /// takes a lock, and doubles the array when it's full; the old array
+    /// is destroyed with epoch-based reclamation, once no lookup can still
+    /// be reading it.
+    ///
+    /// The array is the snapshot: [xg::guid_interner::save]() writes it as
+    /// a column file, and constructing an interner from the
+    /// [xg::guid_column]() of the file restores the same handles.
+    class guid_interner {
+    public:
+        using handle_type = std::uint32_t;
+
+        /// The maximum number of GUIDs, so that every handle is less than
+        /// `0xffffffff`, which can be used as a null handle.
+        static const std::size_t max_size = 0xffffffff;
+
+        /// \effects Constructs an empty interner, with room for `capacity`
+        /// GUIDs before it grows.
+        /// \output_section Constructors
+        explicit guid_interner(std::size_t capacity = 0);
+
+        /// \effects Constructs an interner that assigns the handle `i` to
+        /// `snapshot[i]`, as saved by [xg::guid_interner::save]().
+        ///
+        /// \throws `std::system_error` with `std::errc::invalid_argument` if
+        /// a GUID is in `snapshot` twice, or if it has more than `max_size`.
+        ///
+        /// \notes The checksum of the file isn't checked, see
+        /// [xg::guid_column::verify]().
+        explicit guid_interner(const guid_column& snapshot);
+
+        guid_interner(const guid_interner&) = delete;
+        guid_interner& operator=(const guid_interner&) = delete;
+
+        ~guid_interner();
+
+        /// \returns The handle of `g`, which is assigned the next one if it
+        /// has none yet.
+        /// \throws `std::length_error` if a handle has to be assigned, and
+        /// there are `max_size` already.
+        /// \output_section Interning
+        handle_type intern(const guid& g);
+
+        /// \effects Equivalent to: `out[i] = intern(first[i])` for every `i`
+        /// in `[0, n)`.
+        void intern(const guid* first, std::size_t n, handle_type* out);
+
+        /// \effects Copies the handle of `g` to `out`, if it has one.
+        /// \returns `true` if `g` has a handle, `false` if `out` is left as
+        /// is.
+        /// \notes Lock-free.
+        /// \output_section Lookup
+        bool find(const guid& g, handle_type& out) const
+        {
+            return _handles.find(g, out);
+        }
+
+        /// \returns The GUID with the handle `h`.
+        /// \requires `h` was returned by this interner, to this thread or
+        /// to one this thread synchronized with afterwards.
+        /// \throws `std::bad_alloc` if the calling thread has never used a
+        /// concurrent container before, and its bookkeeping can't be
+        /// allocated.
+        /// \notes Lock-free.
+        guid operator[](handle_type h) const;
+
+        /// \returns The GUID with the handle `h`.
+        /// \throws `std::out_of_range` if `h` isn't less than `size()`.
+        guid at(handle_type h) const;
+
+        /// \effects Equivalent to: `out[i] = (*this)[first[i]]` for every
+        /// `i` in `[0, n)`, but faster.
+        /// \requires The same as for `operator[]`, for each handle.
+        /// \throws The same as `operator[]`.
+        void resolve(const handle_type* first, std::size_t n,
+                     guid* out) const;
+
+        /// \returns The number of GUIDs, which is also the next handle.
+        /// \output_section Capacity
+        std::size_t size() const noexcept
+        {
+            return _size.load(std::memory_order_acquire);
+        }
+        /// \returns `true` if there are no GUIDs.
+        bool empty() const noexcept
+        {
+            return size() == 0;
+        }
+
+        /// \effects Writes the GUIDs to a column file at `path`, in the
+        /// order of their handles, replacing its contents.
+        ///
+        /// GUIDs interned concurrently may or may not be written, but every
+        /// handle in the file is the handle of its GUID.
+        ///
+        /// \throws `std::system_error` if the file can't be written.
+        /// \output_section Snapshots
+        void save(const char* path) const;
+
+        /// \effects Appends the GUIDs with the handles from `writer.size()`
+        /// on to `writer`, then flushes it.
+        ///
+        /// If `writer` appends to a file written by an earlier `save` of
+        /// this interner, only the GUIDs interned since are written.
+        ///
+        /// \throws `std::system_error` if the file can't be written, or
+        /// `std::system_error` with `std::errc::invalid_argument` if it has
+        /// more GUIDs than the interner.
+        void save(guid_column_writer& writer) const;
+
+    private:
+        struct table {
+            explicit table(std::size_t n) : guids(new guid[n]), capacity(n)
+            {
+            }
+
+            std::unique_ptr<guid[]> guids;
+            std::size_t capacity;
+        };
+
+        // Assigns the next handle to `g`. Called under the lock of the
+        // stripe of `g` in _handles, so only once per GUID.
+        handle_type assign(const guid& g);
+
+        concurrent_guid_map<handle_type, mix_hash> _handles;
+        // Modified under _mutex, and retired when replaced
+        std::atomic<table*> _guids{nullptr};
+        std::atomic<std::size_t> _size{0};
+        std::mutex _mutex;
+    };
+}  // namespace xg
@@ -0,0 +1,950 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#pragma once
+
+#include "guid.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if !defined(XG_NO_SIMD) &&                          \
+    (defined(__SSE2__) || defined(_M_X64) ||         \
+     (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+/// \exclude
+#define XG_GUID_TABLE_SSE2 1
+#include <emmintrin.h>
+#else
+/// \exclude
+#define XG_GUID_TABLE_SSE2 0
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace xg {
+    namespace detail {
+        // Every slot of a table has a control byte.
+        // Full slots store the 7 low bits of the hash of their key, so that
+        // 16 slots can be filtered with one vector compare before looking at
+        // any keys. The other states have the high bit set.
+        /// \exclude
+        constexpr signed char ctrl_empty = -128;
+        /// \exclude
+        constexpr signed char ctrl_deleted = -2;
+        /// \exclude
+        constexpr signed char ctrl_sentinel = -1;
+
+        /// \exclude
+        constexpr std::size_t group_width = 16;
+
+        /// \exclude
+        inline unsigned count_trailing_zeros(std::uint32_t x) noexcept
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return static_cast<unsigned>(__builtin_ctz(x));
+#elif defined(_MSC_VER)
+            unsigned long i;
+            _BitScanForward(&i, x);
+            return static_cast<unsigned>(i);
+#else
+            unsigned n = 0;
+            for (; (x & 1) == 0; x >>= 1) {
+                ++n;
+            }
+            return n;
+#endif
+        }
+
+        /// \exclude
+        /// The control bytes of 16 consecutive slots, probed at once.
+        /// The `match` functions return a bitmask with bit `i` set if slot `i`
+        /// of the group matches.
+        class ctrl_group {
+        public:
+            explicit ctrl_group(const signed char* p) noexcept
+#if XG_GUID_TABLE_SSE2
+                : _ctrl(_mm_loadu_si128(
+                      static_cast<const __m128i*>(static_cast<const void*>(p))))
+            {
+            }
+
+            std::uint32_t match(signed char b) const noexcept
+            {
+                return static_cast<std::uint32_t>(_mm_movemask_epi8(
+                    _mm_cmpeq_epi8(_mm_set1_epi8(b), _ctrl)));
+            }
+
+            std::uint32_t match_empty_or_deleted() const noexcept
+            {
+                return static_cast<std::uint32_t>(_mm_movemask_epi8(
+                    _mm_cmpgt_epi8(_mm_set1_epi8(ctrl_sentinel), _ctrl)));
+            }
+#else
+            {
+                std::memcpy(_ctrl, p, group_width);
+            }
+
+            std::uint32_t match(signed char b) const noexcept
+            {
+                std::uint32_t mask = 0;
+                for (std::size_t i = 0; i < group_width; ++i) {
+                    mask |= static_cast<std::uint32_t>(_ctrl[i] == b) << i;
+                }
+                return mask;
+            }
+
+            std::uint32_t match_empty_or_deleted() const noexcept
+            {
+                std::uint32_t mask = 0;
+                for (std::size_t i = 0; i < group_width; ++i) {
+                    mask |= static_cast<std::uint32_t>(_ctrl[i] < ctrl_sentinel)
+                            << i;
+                }
+                return mask;
+            }
+#endif
+
+            std::uint32_t match_empty() const noexcept
+            {
+                return match(ctrl_empty);
+            }
+
+        private:
+#if XG_GUID_TABLE_SSE2
+            __m128i _ctrl;
+#else
+            signed char _ctrl[group_width];
+#endif
+        };
+
+        /// \exclude
+        struct guid_set_policy {
+            using slot_type = guid;
+            static constexpr bool const_iterators = true;
+
+            static const guid& key(const slot_type& s) noexcept
+            {
+                return s;
+            }
+        };
+
+        /// \exclude
+        template <typename T>
+        struct guid_map_policy {
+            using slot_type = std::pair<const guid, T>;
+            static constexpr bool const_iterators = false;
+
+            static const guid& key(const slot_type& s) noexcept
+            {
+                return s.first;
+            }
+        };
+
+        template <typename Policy, typename Hash, typename Allocator>
+        class guid_table;
+
+        /// \exclude
+        template <typename Slot, bool Const>
+        class guid_table_iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = Slot;
+            using difference_type = std::ptrdiff_t;
+            using reference =
+                typename std::conditional<Const, const Slot&, Slot&>::type;
+            using pointer =
+                typename std::conditional<Const, const Slot*, Slot*>::type;
+
+            guid_table_iterator() noexcept = default;
+
+            template <bool C = Const,
+                      typename = typename std::enable_if<C>::type>
+            guid_table_iterator(
+                const guid_table_iterator<Slot, false>& other) noexcept
+                : _ctrl(other._ctrl), _slot(other._slot)
+            {
+            }
+
+            reference operator*() const noexcept
+            {
+                return *_slot;
+            }
+            pointer operator->() const noexcept
+            {
+                return _slot;
+            }
+
+            guid_table_iterator& operator++() noexcept
+            {
+                ++_ctrl;
+                ++_slot;
+                skip_free();
+                return *this;
+            }
+            guid_table_iterator operator++(int) noexcept
+            {
+                auto tmp = *this;
+                ++*this;
+                return tmp;
+            }
+
+            friend bool operator==(const guid_table_iterator& a,
+                                   const guid_table_iterator& b) noexcept
+            {
+                return a._ctrl == b._ctrl;
+            }
+            friend bool operator!=(const guid_table_iterator& a,
+                                   const guid_table_iterator& b) noexcept
+            {
+                return a._ctrl != b._ctrl;
+            }
+
+        private:
+            template <typename, typename, typename>
+            friend class guid_table;
+            friend class guid_table_iterator<Slot, !Const>;
+
+            guid_table_iterator(const signed char* ctrl, pointer slot) noexcept
+                : _ctrl(ctrl), _slot(slot)
+            {
+                skip_free();
+            }
+
+            // Stops at a full slot or at the sentinel after the last slot
+            void skip_free() noexcept
+            {
+                while (*_ctrl < ctrl_sentinel) {
+                    ++_ctrl;
+                    ++_slot;
+                }
+            }
+
+            const signed char* _ctrl{nullptr};
+            pointer _slot{nullptr};
+        };
+
+        /// \exclude
+        /// The open-addressing hash table behind [xg::guid_map]() and
+        /// [xg::guid_set]().
+        ///
+        /// The slots are split into groups of 16, each with 16 control bytes
+        /// stored separately from the slots. A key is looked up by probing
+        /// the groups in a triangular sequence beginning at the group chosen
+        /// by the high bits of its hash, until one of them contains an empty
+        /// slot. Keys are only compared in the slots whose control byte
+        /// equals the low 7 bits of the hash.
+        template <typename Policy, typename Hash, typename Allocator>
+        class guid_table {
+            using slot_type = typename Policy::slot_type;
+            using slot_allocator = typename std::allocator_traits<
+                Allocator>::template rebind_alloc<slot_type>;
+            using slot_traits = std::allocator_traits<slot_allocator>;
+            using ctrl_allocator = typename std::allocator_traits<
+                Allocator>::template rebind_alloc<signed char>;
+            using ctrl_traits = std::allocator_traits<ctrl_allocator>;
+
+        public:
+            using key_type = guid;
+            using value_type = slot_type;
+            using size_type = std::size_t;
+            using difference_type = std::ptrdiff_t;
+            using hasher = Hash;
+            using key_equal = std::equal_to<guid>;
+            using allocator_type = Allocator;
+            using reference = value_type&;
+            using const_reference = const value_type&;
+            using pointer = typename slot_traits::pointer;
+            using const_pointer = typename slot_traits::const_pointer;
+            using const_iterator = guid_table_iterator<slot_type, true>;
+            using iterator = typename std::conditional<
+                Policy::const_iterators,
+                const_iterator,
+                guid_table_iterator<slot_type, false>>::type;
+
+            guid_table() = default;
+
+            /// \effects Constructs an empty container with room for
+            /// `capacity` elements without rehashing.
+            explicit guid_table(size_type capacity,
+                                const Hash& hash = Hash(),
+                                const Allocator& alloc = Allocator())
+                : _hash(hash), _alloc(alloc)
+            {
+                reserve(capacity);
+            }
+
+            /// \effects Constructs a container with the elements of `init`.
+            guid_table(std::initializer_list<value_type> init,
+                       const Hash& hash = Hash(),
+                       const Allocator& alloc = Allocator())
+                : guid_table(init.size(), hash, alloc)
+            {
+                insert(init);
+            }
+
+            guid_table(const guid_table& other)
+                : _hash(other._hash),
+                  _alloc(slot_traits::select_on_container_copy_construction(
+                      other._alloc))
+            {
+                reserve(other._size);
+                for (const auto& s : other) {
+                    emplace_key(Policy::key(s), s);
+                }
+            }
+            guid_table(guid_table&& other) noexcept
+                : _ctrl(other._ctrl),
+                  _slots(other._slots),
+                  _capacity(other._capacity),
+                  _size(other._size),
+                  _growth_left(other._growth_left),
+                  _hash(std::move(other._hash)),
+                  _alloc(std::move(other._alloc))
+            {
+                other.release();
+            }
+
+            guid_table& operator=(const guid_table& other)
+            {
+                if (this != &other) {
+                    guid_table tmp(other);
+                    swap(tmp);
+                }
+                return *this;
+            }
+            guid_table& operator=(guid_table&& other) noexcept
+            {
+                if (this != &other) {
+                    deallocate();
+                    _ctrl = other._ctrl;
+                    _slots = other._slots;
+                    _capacity = other._capacity;
+                    _size = other._size;
+                    _growth_left = other._growth_left;
+                    _hash = std::move(other._hash);
+                    _alloc = std::move(other._alloc);
+                    other.release();
+                }
+                return *this;
+            }
+
+            ~guid_table() noexcept
+            {
+                deallocate();
+            }
+
+            iterator begin() noexcept
+            {
+                return _capacity == 0 ? iterator{empty_ctrl(), nullptr}
+                                      : iterator{_ctrl, _slots};
+            }
+            const_iterator begin() const noexcept
+            {
+                return _capacity == 0 ? const_iterator{empty_ctrl(), nullptr}
+                                      : const_iterator{_ctrl, _slots};
+            }
+            const_iterator cbegin() const noexcept
+            {
+                return begin();
+            }
+            iterator end() noexcept
+            {
+                return _capacity == 0
+                           ? iterator{empty_ctrl(), nullptr}
+                           : iterator{_ctrl + _capacity, _slots + _capacity};
+            }
+            const_iterator end() const noexcept
+            {
+                return _capacity == 0
+                           ? const_iterator{empty_ctrl(), nullptr}
+                           : const_iterator{_ctrl + _capacity,
+                                            _slots + _capacity};
+            }
+            const_iterator cend() const noexcept
+            {
+                return end();
+            }
+
+            bool empty() const noexcept
+            {
+                return _size == 0;
+            }
+            size_type size() const noexcept
+            {
+                return _size;
+            }
+            size_type max_size() const noexcept
+            {
+                return slot_traits::max_size(_alloc);
+            }
+            /// \returns The number of slots, full or not.
+            size_type capacity() const noexcept
+            {
+                return _capacity;
+            }
+            float load_factor() const noexcept
+            {
+                return _capacity == 0 ? 0.f
+                                      : static_cast<float>(_size) /
+                                            static_cast<float>(_capacity);
+            }
+            /// \returns The load factor above which the container grows,
+            /// `7/8`.
+            float max_load_factor() const noexcept
+            {
+                return 0.875f;
+            }
+
+            hasher hash_function() const
+            {
+                return _hash;
+            }
+            key_equal key_eq() const
+            {
+                return key_equal();
+            }
+            allocator_type get_allocator() const
+            {
+                return allocator_type(_alloc);
+            }
+
+            /// \effects Makes room for `n` elements without rehashing.
+            void reserve(size_type n)
+            {
+                if (n > growth_limit(_capacity)) {
+                    resize(capacity_for(n));
+                }
+            }
+
+            /// \effects Destroys every element, keeping the capacity.
+            void clear() noexcept
+            {
+                if (_capacity == 0) {
+                    return;
+                }
+                destroy_slots();
+                std::memset(_ctrl, ctrl_empty, _capacity);
+                _size = 0;
+                _growth_left = growth_limit(_capacity);
+            }
+
+            std::pair<iterator, bool> insert(const value_type& value)
+            {
+                return emplace_key(Policy::key(value), value);
+            }
+            std::pair<iterator, bool> insert(value_type&& value)
+            {
+                return emplace_key(Policy::key(value), std::move(value));
+            }
+            template <typename InputIt>
+            void insert(InputIt first, InputIt last)
+            {
+                for (; first != last; ++first) {
+                    insert(*first);
+                }
+            }
+            void insert(std::initializer_list<value_type> init)
+            {
+                insert(init.begin(), init.end());
+            }
+
+            /// \effects Destroys the element at `pos`.
+            /// \returns Iterator to the element after it.
+            /// \notes Other iterators stay valid.
+            iterator erase(const_iterator pos) noexcept
+            {
+                const auto i = static_cast<size_type>(pos._slot - _slots);
+                erase_at(i);
+                return iterator{_ctrl + i, _slots + i};
+            }
+            /// \effects Destroys the element with the key `key`, if any.
+            /// \returns The number of elements destroyed, `0` or `1`.
+            size_type erase(const guid& key) noexcept
+            {
+                const auto i = find_index(key);
+                if (i == _capacity) {
+                    return 0;
+                }
+                erase_at(i);
+                return 1;
+            }
+
+            void swap(guid_table& other) noexcept
+            {
+                using std::swap;
+                swap(_ctrl, other._ctrl);
+                swap(_slots, other._slots);
+                swap(_capacity, other._capacity);
+                swap(_size, other._size);
+                swap(_growth_left, other._growth_left);
+                swap(_hash, other._hash);
+                swap(_alloc, other._alloc);
+            }
+
+            iterator find(const guid& key) noexcept
+            {
+                const auto i = find_index(key);
+                return i == _capacity ? end() : iterator{_ctrl + i, _slots + i};
+            }
+            const_iterator find(const guid& key) const noexcept
+            {
+                const auto i = find_index(key);
+                return i == _capacity ? end()
+                                      : const_iterator{_ctrl + i, _slots + i};
+            }
+            /// \effects Looks up the GUID in the null-terminated string `s`,
+            /// parsed like `guid(const char*)`, without constructing a GUID
+            /// first.
+            /// \returns `end()` if `s` isn't a valid GUID or isn't in the
+            /// container.
+            /// \unique_name find_c_string
+            iterator find(const char* s) noexcept
+            {
+                guid key;
+                return detail::parse_guid(s, s + std::strlen(s), key)
+                           ? find(key)
+                           : end();
+            }
+            /// \unique_name find_c_string_const
+            const_iterator find(const char* s) const noexcept
+            {
+                guid key;
+                return detail::parse_guid(s, s + std::strlen(s), key)
+                           ? find(key)
+                           : end();
+            }
+            /// \effects Looks up the GUID in `s`, parsed like
+            /// `guid(const char*)`.
+            /// \unique_name find_string
+            iterator find(const std::string& s) noexcept
+            {
+                guid key;
+                return detail::parse_guid(s.data(), s.data() + s.size(), key)
+                           ? find(key)
+                           : end();
+            }
+            /// \unique_name find_string_const
+            const_iterator find(const std::string& s) const noexcept
+            {
+                guid key;
+                return detail::parse_guid(s.data(), s.data() + s.size(), key)
+                           ? find(key)
+                           : end();
+            }
+
+            bool contains(const guid& key) const noexcept
+            {
+                return find_index(key) != _capacity;
+            }
+            bool contains(const char* s) const noexcept
+            {
+                return find(s) != end();
+            }
+            bool contains(const std::string& s) const noexcept
+            {
+                return find(s) != end();
+            }
+            size_type count(const guid& key) const noexcept
+            {
+                return contains(key) ? 1 : 0;
+            }
+            size_type count(const char* s) const noexcept
+            {
+                return contains(s) ? 1 : 0;
+            }
+            size_type count(const std::string& s) const noexcept
+            {
+                return contains(s) ? 1 : 0;
+            }
+
+        protected:
+            /// Inserts an element constructed from `args` if `key` isn't in
+            /// the container.
+            template <typename... Args>
+            std::pair<iterator, bool> emplace_key(const guid& key,
+                                                  Args&&... args)
+            {
+                const auto h = hash_of(key);
+                auto i = size_type{0};
+                if (_capacity != 0) {
+                    const auto r = find_or_free(key, h);
+                    if (r.found) {
+                        return {iterator{_ctrl + r.index, _slots + r.index},
+                                false};
+                    }
+                    i = r.index;
+                }
+                if (_capacity == 0 ||
+                    (_growth_left == 0 && _ctrl[i] != ctrl_deleted)) {
+                    grow();
+                    i = find_first_free(h);
+                }
+                slot_traits::construct(_alloc, _slots + i,
+                                       std::forward<Args>(args)...);
+                if (_ctrl[i] == ctrl_empty) {
+                    --_growth_left;
+                }
+                _ctrl[i] = h2(h);
+                ++_size;
+                return {iterator{_ctrl + i, _slots + i}, true};
+            }
+
+        private:
+            static const signed char* empty_ctrl() noexcept
+            {
+                static const signed char sentinel = ctrl_sentinel;
+                return &sentinel;
+            }
+
+            // At most 7/8 of the slots can be used, so that every probe
+            // sequence ends in a group with an empty slot
+            static size_type growth_limit(size_type capacity) noexcept
+            {
+                return capacity - capacity / 8;
+            }
+            static size_type capacity_for(size_type n) noexcept
+            {
+                size_type capacity = group_width;
+                while (growth_limit(capacity) < n) {
+                    capacity *= 2;
+                }
+                return capacity;
+            }
+
+            static signed char h2(std::size_t h) noexcept
+            {
+                return static_cast<signed char>(h & 0x7f);
+            }
+
+            std::size_t hash_of(const guid& key) const noexcept
+            {
+                return _hash(key);
+            }
+
+            size_type find_index(const guid& key) const noexcept
+            {
+                return _capacity == 0 ? 0 : find_index(key, hash_of(key));
+            }
+            /// \returns The index of the slot of `key`, or `_capacity` if it
+            /// isn't in the table.
+            size_type find_index(const guid& key, std::size_t h) const noexcept
+            {
+                const auto mask = _capacity / group_width - 1;
+                const auto tag = h2(h);
+                auto g = (h >> 7) & mask;
+                for (size_type step = 1;; ++step) {
+                    const auto first = g * group_width;
+                    const ctrl_group group(_ctrl + first);
+                    for (auto m = group.match(tag); m != 0; m &= m - 1) {
+                        const auto i = first + count_trailing_zeros(m);
+                        if (Policy::key(_slots[i]) == key) {
+                            return i;
+                        }
+                    }
+                    if (group.match_empty() != 0) {
+                        return _capacity;
+                    }
+                    g = (g + step) & mask;
+                }
+            }
+            struct probe_result {
+                size_type index;
+                bool found;
+            };
+            /// \returns The index of the slot of `key`, or of the first empty
+            /// or deleted slot in its probe sequence if it isn't in the
+            /// table, in one pass.
+            probe_result find_or_free(const guid& key,
+                                      std::size_t h) const noexcept
+            {
+                const auto mask = _capacity / group_width - 1;
+                const auto tag = h2(h);
+                auto free = _capacity;
+                auto g = (h >> 7) & mask;
+                for (size_type step = 1;; ++step) {
+                    const auto first = g * group_width;
+                    const ctrl_group group(_ctrl + first);
+                    for (auto m = group.match(tag); m != 0; m &= m - 1) {
+                        const auto i = first + count_trailing_zeros(m);
+                        if (Policy::key(_slots[i]) == key) {
+                            return {i, true};
+                        }
+                    }
+                    if (free == _capacity) {
+                        const auto m = group.match_empty_or_deleted();
+                        if (m != 0) {
+                            free = first + count_trailing_zeros(m);
+                        }
+                    }
+                    if (group.match_empty() != 0) {
+                        return {free, false};
+                    }
+                    g = (g + step) & mask;
+                }
+            }
+            /// \returns The index of the first empty or deleted slot in the
+            /// probe sequence of `h`.
+            size_type find_first_free(std::size_t h) const noexcept
+            {
+                const auto mask = _capacity / group_width - 1;
+                auto g = (h >> 7) & mask;
+                for (size_type step = 1;; ++step) {
+                    const auto first = g * group_width;
+                    const auto m =
+                        ctrl_group(_ctrl + first).match_empty_or_deleted();
+                    if (m != 0) {
+                        return first + count_trailing_zeros(m);
+                    }
+                    g = (g + step) & mask;
+                }
+            }
+
+            void erase_at(size_type i) noexcept
+            {
+                slot_traits::destroy(_alloc, _slots + i);
+                --_size;
+                // A probe sequence never continues past a group with an
+                // empty slot, so the slot can be made empty instead of a
+                // tombstone if its group already has one
+                const auto first = i & ~(group_width - 1);
+                if (ctrl_group(_ctrl + first).match_empty() != 0) {
+                    _ctrl[i] = ctrl_empty;
+                    ++_growth_left;
+                }
+                else {
+                    _ctrl[i] = ctrl_deleted;
+                }
+            }
+
+            void grow()
+            {
+                if (_capacity == 0) {
+                    resize(group_width);
+                }
+                else if (_size <= growth_limit(_capacity) / 2) {
+                    // Mostly tombstones: clean up without growing
+                    resize(_capacity);
+                }
+                else {
+                    resize(_capacity * 2);
+                }
+            }
+
+            void resize(size_type capacity)
+            {
+                ctrl_allocator ctrl_alloc(_alloc);
+                auto ctrl = ctrl_traits::allocate(ctrl_alloc, capacity + 1);
+                std::memset(ctrl, ctrl_empty, capacity);
+                ctrl[capacity] = ctrl_sentinel;
+                slot_type* slots;
+                try {
+                    slots = slot_traits::allocate(_alloc, capacity);
+                }
+                catch (...) {
+                    ctrl_traits::deallocate(ctrl_alloc, ctrl, capacity + 1);
+                    throw;
+                }
+
+                auto old_ctrl = _ctrl;
+                auto old_slots = _slots;
+                const auto old_capacity = _capacity;
+                _ctrl = ctrl;
+                _slots = slots;
+                _capacity = capacity;
+                _growth_left = growth_limit(capacity) - _size;
+
+                for (size_type i = 0; i < old_capacity; ++i) {
+                    if (old_ctrl[i] < 0) {
+                        continue;
+                    }
+                    const auto h = hash_of(Policy::key(old_slots[i]));
+                    const auto j = find_first_free(h);
+                    _ctrl[j] = h2(h);
+                    slot_traits::construct(_alloc, _slots + j,
+                                           std::move(old_slots[i]));
+                    slot_traits::destroy(_alloc, old_slots + i);
+                }
+                if (old_capacity != 0) {
+                    slot_traits::deallocate(_alloc, old_slots, old_capacity);
+                    ctrl_traits::deallocate(ctrl_alloc, old_ctrl,
+                                            old_capacity + 1);
+                }
+            }
+
+            void destroy_slots() noexcept
+            {
+                for (size_type i = 0; i < _capacity; ++i) {
+                    if (_ctrl[i] >= 0) {
+                        slot_traits::destroy(_alloc, _slots + i);
+                    }
+                }
+            }
+
+            void deallocate() noexcept
+            {
+                if (_capacity == 0) {
+                    return;
+                }
+                destroy_slots();
+                ctrl_allocator ctrl_alloc(_alloc);
+                slot_traits::deallocate(_alloc, _slots, _capacity);
+                ctrl_traits::deallocate(ctrl_alloc, _ctrl, _capacity + 1);
+            }
+
+            void release() noexcept
+            {
+                _ctrl = nullptr;
+                _slots = nullptr;
+                _capacity = 0;
+                _size = 0;
+                _growth_left = 0;
+            }
+
+            signed char* _ctrl{nullptr};
+            slot_type* _slots{nullptr};
+            size_type _capacity{0};
+            size_type _size{0};
+            size_type _growth_left{0};
+            Hash _hash{};
+            slot_allocator _alloc{};
+        };
+    }  // namespace detail
+
+    /// An unordered associative container from GUIDs to values of type `T`,
+    /// with the interface of `std::unordered_map`.
+    ///
+    /// Unlike `std::unordered_map`, it stores the elements in one flat
+    /// array instead of a node per element, and finds them by comparing 16
+    /// control bytes at a time (with SSE2, where available) holding 7 bits
+    /// of the hash of each key.
+    /// A lookup typically touches one cache line of control bytes and one
+    /// of elements.
+    ///
+    /// The default [xg::fold_hash]() takes the control bytes and the
+    /// position of a key straight from its random bits, so it's only suited
+    /// to random (version 4) GUIDs. Use [xg::mix_hash]() as `Hash` for
+    /// time-ordered, name-based or untrusted GUIDs.
+    ///
+    /// Lookups also accept the textual representation of a GUID, as a
+    /// `const char*` or a `std::string`.
+    ///
+    /// \notes Inserting invalidates all iterators and references when the
+    /// container grows, which happens when `size()` exceeds 7/8 of
+    /// `capacity()`. Erasing only invalidates the erased element.
+    template <typename T,
+              typename Hash = fold_hash,
+              typename Allocator = std::allocator<std::pair<const guid, T>>>
+    class guid_map
+        : public detail::
+              guid_table<detail::guid_map_policy<T>, Hash, Allocator> {
+        using base =
+            detail::guid_table<detail::guid_map_policy<T>, Hash, Allocator>;
+
+    public:
+        using mapped_type = T;
+        using typename base::iterator;
+        using typename base::const_iterator;
+
+        using base::base;
+
+        /// \effects Inserts an element with the key `key` and a value
+        /// constructed from `args`, if `key` isn't in the container.
+        /// Otherwise does nothing, `args` aren't moved from.
+        template <typename... Args>
+        std::pair<iterator, bool> try_emplace(const guid& key, Args&&... args)
+        {
+            return this->emplace_key(
+                key, std::piecewise_construct, std::forward_as_tuple(key),
+                std::forward_as_tuple(std::forward<Args>(args)...));
+        }
+
+        /// \effects Assigns `value` to the element with the key `key`, or
+        /// inserts it if there isn't one.
+        template <typename M>
+        std::pair<iterator, bool> insert_or_assign(const guid& key, M&& value)
+        {
+            auto r = try_emplace(key, std::forward<M>(value));
+            if (!r.second) {
+                r.first->second = std::forward<M>(value);
+            }
+            return r;
+        }
+
+        /// \returns The value with the key `key`, inserting a value
+        /// initialized one if there isn't one.
+        T& operator[](const guid& key)
+        {
+            return try_emplace(key).first->second;
+        }
+
+        /// \returns The value with the key `key`.
+        /// \throws `std::out_of_range` if there isn't one.
+        T& at(const guid& key)
+        {
+            auto it = this->find(key);
+            if (it == this->end()) {
+                throw std::out_of_range("xg::guid_map::at: key not found");
+            }
+            return it->second;
+        }
+        /// \returns The value with the key `key`.
+        /// \throws `std::out_of_range` if there isn't one.
+        const T& at(const guid& key) const
+        {
+            auto it = this->find(key);
+            if (it == this->end()) {
+                throw std::out_of_range("xg::guid_map::at: key not found");
+            }
+            return it->second;
+        }
+    };
+
+    /// An unordered set of GUIDs, with the interface of
+    /// `std::unordered_set`.
+    ///
+    /// It's the same table as [xg::guid_map](), so the 16-byte keys are
+    /// stored back to back in one array.
+    template <typename Hash = fold_hash,
+              typename Allocator = std::allocator<guid>>
+    class guid_set
+        : public detail::guid_table<detail::guid_set_policy, Hash, Allocator> {
+        using base =
+            detail::guid_table<detail::guid_set_policy, Hash, Allocator>;
+
+    public:
+        using base::base;
+    };
+}  // namespace xg
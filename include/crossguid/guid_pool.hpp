@@ -0,0 +1,165 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#pragma once
+
+#include "guid.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace xg {
+    /// Options for [xg::guid_pool]().
+    struct guid_pool_options {
+        /// Number of GUIDs the pool holds, rounded up to a power of 2.
+        std::size_t capacity{4096};
+        /// The refill thread wakes up when fewer GUIDs than this are left.
+        std::size_t low_watermark{1024};
+        /// The refill thread fills the pool up to this many GUIDs, at most
+        /// `capacity`.
+        std::size_t high_watermark{4096};
+    };
+
+    /// Counters of an [xg::guid_pool]().
+    struct guid_pool_stats {
+        /// GUIDs taken from the pool.
+        std::uint64_t hits{0};
+        /// GUIDs created synchronously because the pool was empty.
+        std::uint64_t misses{0};
+        /// Times the refill thread woke up to refill the pool.
+        std::uint64_t refills{0};
+        /// GUIDs created by the refill thread.
+        std::uint64_t refilled{0};
+        /// Time the refill thread spent creating and storing GUIDs.
+        std::chrono::nanoseconds refill_time{0};
+    };
+
+    /// A pool of random GUIDs created ahead of time by a background thread,
+    /// for callers that can't afford the occasional stall of
+    /// [xg::make_guid](), when the kernel is slow to provide entropy.
+    ///
+    /// The GUIDs are held in a bounded lock-free ring buffer that any
+    /// number of threads can take GUIDs from concurrently (Dmitry Vyukov's
+    /// MPMC queue): taking one is a compare-and-swap and two loads, with
+    /// no locks and no system calls. When fewer than the low watermark are
+    /// left, the refill thread is woken up and creates GUIDs in batches
+    /// with [xg::make_guids]() until there are as many as the high
+    /// watermark. If the pool runs empty anyway, GUIDs are created
+    /// synchronously with [xg::make_guid]().
+    ///
+    /// After `fork()`, the pool is empty in the child process: the GUIDs
+    /// already in it stay the parent's, so that no GUID is handed out
+    /// twice, and the refill thread doesn't exist in the child. There,
+    /// [xg::guid_pool::get]() always falls back to [xg::make_guid]().
+    class guid_pool {
+    public:
+        /// \effects Creates an empty pool, and starts its refill thread,
+        /// which fills it up to the high watermark.
+        ///
+        /// \throws `std::system_error` if the thread can't be started.
+        /// \output_section Constructors
+        explicit guid_pool(
+            const guid_pool_options& options = guid_pool_options{});
+
+        guid_pool(const guid_pool&) = delete;
+        guid_pool& operator=(const guid_pool&) = delete;
+
+        /// \effects Stops the refill thread, unless called in a child
+        /// process, which doesn't have it.
+        ~guid_pool() noexcept;
+
+        /// \returns A GUID from the pool, or a new one from
+        /// [xg::make_guid]() if it's empty.
+        ///
+        /// \throws Anything thrown by [xg::make_guid]() when the pool is
+        /// empty.
+        /// \output_section Taking GUIDs
+        guid get();
+
+        /// \effects Takes a GUID from the pool into `out`, if it isn't empty.
+        /// \returns `false` if the pool was empty, or the calling process is
+        /// a child forked after the pool was created, leaving `out` as is.
+        bool try_get(guid& out) noexcept;
+
+        /// \returns The number of GUIDs in the pool. It can change at any
+        /// time if other threads are using the pool.
+        std::size_t size() const noexcept;
+
+        /// \returns The counters of the pool since it was created.
+        guid_pool_stats stats() const noexcept;
+
+    private:
+        struct cell {
+            std::atomic<std::size_t> sequence;
+            guid value;
+        };
+
+        // Attempts to store `g`, returning false if the pool is full.
+        // Only called by the refill thread.
+        bool push(const guid& g) noexcept;
+        void request_refill() noexcept;
+        void refill_loop() noexcept;
+        // True in a child process forked after the pool was created
+        bool forked() const noexcept;
+
+        std::unique_ptr<cell[]> _cells;
+        std::size_t _mask;
+        std::size_t _low_watermark;
+        std::size_t _high_watermark;
+
+        // The positions the producer and the consumers are at, on separate
+        // cache lines so that they don't slow each other down. The number
+        // of GUIDs taken from the pool is _dequeue_pos.
+        char _pad0[64];
+        std::atomic<std::size_t> _enqueue_pos{0};
+        char _pad1[64 - sizeof(std::atomic<std::size_t>)];
+        std::atomic<std::size_t> _dequeue_pos{0};
+        char _pad2[64 - sizeof(std::atomic<std::size_t>)];
+
+        std::atomic<bool> _refill_requested{true};
+        std::atomic<std::uint64_t> _misses{0};
+        std::atomic<std::uint64_t> _refills{0};
+        std::atomic<std::uint64_t> _refilled{0};
+        std::atomic<std::int64_t> _refill_nanoseconds{0};
+
+        // What the refill thread waits on. Owned through a pointer, so that
+        // a child process can leave it alone: the thread only exists in
+        // the parent, and may have held the mutex or waited on the
+        // condition variable when the process forked.
+        struct refill_sync {
+            std::mutex mutex;
+            std::condition_variable wake;
+            bool stop{false};
+            std::thread thread;
+        };
+        std::unique_ptr<refill_sync> _refill;
+        unsigned _fork_generation;
+    };
+}  // namespace xg
@@ -0,0 +1,99 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#pragma once
+
+#include <cstddef>
+
+namespace xg {
+    /// A read-only memory mapping of a whole file.
+    ///
+    /// Lets large files be scanned or parsed in place, without reading them
+    /// into a buffer first. The mapping is hinted for sequential access.
+    class mapped_file {
+    public:
+        /// \effects Constructs an object that maps no file, with `size() == 0`.
+        mapped_file() noexcept = default;
+
+        /// \effects Maps the file at `path` into memory, read-only.
+        /// An empty file results in an empty mapping, with `data() ==
+        /// nullptr`.
+        ///
+        /// \throws `std::system_error` if the file can't be opened or mapped.
+        explicit mapped_file(const char* path);
+
+        mapped_file(const mapped_file&) = delete;
+        mapped_file& operator=(const mapped_file&) = delete;
+
+        mapped_file(mapped_file&& other) noexcept
+            : _data(other._data), _size(other._size)
+        {
+            other._data = nullptr;
+            other._size = 0;
+        }
+        mapped_file& operator=(mapped_file&& other) noexcept
+        {
+            if (this != &other) {
+                unmap();
+                _data = other._data;
+                _size = other._size;
+                other._data = nullptr;
+                other._size = 0;
+            }
+            return *this;
+        }
+
+        /// \effects Unmaps the file.
+        ~mapped_file() noexcept
+        {
+            unmap();
+        }
+
+        /// \returns Pointer to the first byte of the file.
+        const char* data() const noexcept
+        {
+            return _data;
+        }
+        /// \returns The size of the file in bytes.
+        std::size_t size() const noexcept
+        {
+            return _size;
+        }
+
+        const char* begin() const noexcept
+        {
+            return _data;
+        }
+        const char* end() const noexcept
+        {
+            return _data + _size;
+        }
+
+    private:
+        void unmap() noexcept;
+
+        const char* _data{nullptr};
+        std::size_t _size{0};
+    };
+}  // namespace xg
@@ -0,0 +1,81 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#pragma once
+
+#include "guid.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace xg {
+    /// A GUID found by [xg::scan]().
+    struct scan_match {
+        /// The GUID.
+        guid value;
+        /// Offset of its first character from the beginning of the input.
+        std::size_t offset;
+    };
+
+    /// Options for [xg::scan]().
+    struct scan_options {
+        /// Number of threads scanning the input in parallel.
+        /// `0` uses one per hardware thread.
+        unsigned threads{1};
+        /// Size of the pieces of input handed out to the threads.
+        std::size_t chunk_size{std::size_t{1} << 22};
+    };
+
+    /// Finds every GUID in the canonical 8-4-4-4-12 textual representation
+    /// in `[first, last)`, and calls `on_match` with each of them in order.
+    ///
+    /// A GUID is only matched if it isn't part of a longer run of
+    /// hexadecimal digits: the characters right before and after it can't
+    /// be hexadecimal digits.
+    /// Digits can be in either case.
+    ///
+    /// \notes The input is classified 32 (AVX2) or 16 (SSE4.1) bytes at a
+    /// time to find the hyphen pattern of the canonical form, and only those
+    /// candidates are validated with the same kernels as `guid(const char*)`.
+    /// Without SIMD, candidates are found with `memchr`.
+    ///
+    /// \requires `[first, last)` doesn't need to be null-terminated, and is
+    /// never read past `last`.
+    void scan_each(const char* first,
+                   const char* last,
+                   const std::function<void(const scan_match&)>& on_match);
+
+    /// Finds every GUID in `[first, last)`, like [xg::scan_each]().
+    ///
+    /// With `options.threads` other than `1`, the input is split into chunks
+    /// of `options.chunk_size` bytes, which are scanned in parallel.
+    /// Each chunk also reads up to 36 bytes into the next one, so that GUIDs
+    /// crossing the boundary are found exactly once.
+    ///
+    /// \returns The GUIDs found, ordered by offset.
+    std::vector<scan_match> scan(const char* first,
+                                 const char* last,
+                                 const scan_options& options = scan_options{});
+}  // namespace xg
@@ -0,0 +1,199 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#pragma once
+
+#include "guid.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace xg {
+    namespace detail {
+        /// \exclude
+        /// Bits `[offset, offset + width)` of the 122 bits of `g` other than
+        /// the version and variant, counted from the most significant one.
+        /// \requires `width <= 64` and `offset + width <= 122`.
+        inline std::uint64_t payload_bits(const guid& g,
+                                          unsigned offset,
+                                          unsigned width) noexcept
+        {
+            if (width == 0) {
+                return 0;
+            }
+            const std::uint64_t hi = load_u64_be(g.data());
+            const std::uint64_t lo = load_u64_be(g.data() + 8);
+            // The payload is 60 bits around the version in hi, followed by
+            // 62 bits after the variant in lo
+            const std::uint64_t a = ((hi >> 16) << 12) | (hi & 0xfff);
+            const std::uint64_t b = lo & 0x3fffffffffffffff;
+            const std::uint64_t mask =
+                width == 64 ? ~std::uint64_t{0}
+                            : (std::uint64_t{1} << width) - 1;
+            const unsigned shift = 122 - offset - width;
+            if (shift >= 62) {
+                return (a >> (shift - 62)) & mask;
+            }
+            return ((a << (62 - shift)) | (b >> shift)) & mask;
+        }
+    }  // namespace detail
+
+    /// The layout of the GUIDs created by [xg::sharded_generator]().
+    ///
+    /// The GUIDs are version 8 (custom) GUIDs of RFC 9562. The 122 bits
+    /// other than the version and the variant hold, from the most
+    /// significant one: the timestamp, the node ID, the sequence number,
+    /// and random bits in the remaining ones. So they're ordered by the
+    /// timestamp first, like version 7 GUIDs, when compared with
+    /// [`operator<`](standardese://xg::operator<).
+    ///
+    /// The default layout has a 48-bit timestamp in milliseconds since the
+    /// Unix epoch, 16 bits of node ID, 16 bits of sequence number, for
+    /// 65536 GUIDs per node and millisecond, and 42 random bits.
+    struct sharded_layout {
+        /// The number of bits of the timestamp.
+        unsigned timestamp_bits{48};
+        /// The number of bits of the node ID.
+        unsigned node_bits{16};
+        /// The number of bits of the sequence number.
+        unsigned sequence_bits{16};
+        /// The resolution of the timestamp.
+        std::chrono::microseconds tick{1000};
+        /// The time of timestamp `0`.
+        std::chrono::system_clock::time_point epoch{};
+
+        /// \returns The number of random bits in the GUIDs.
+        constexpr unsigned random_bits() const noexcept
+        {
+            return 122 - timestamp_bits - node_bits - sequence_bits;
+        }
+
+        /// \returns The timestamp in `g`, in ticks since `epoch`.
+        std::uint64_t timestamp(const guid& g) const noexcept
+        {
+            return detail::payload_bits(g, 0, timestamp_bits);
+        }
+        /// \returns The time `g` was created at, rounded down to the tick.
+        std::chrono::system_clock::time_point time(const guid& g) const
+        {
+            return epoch +
+                   std::chrono::duration_cast<
+                       std::chrono::system_clock::duration>(
+                       tick * static_cast<std::chrono::microseconds::rep>(
+                                  timestamp(g)));
+        }
+        /// \returns The node ID in `g`.
+        std::uint64_t node(const guid& g) const noexcept
+        {
+            return detail::payload_bits(g, timestamp_bits, node_bits);
+        }
+        /// \returns The sequence number in `g`.
+        std::uint64_t sequence(const guid& g) const noexcept
+        {
+            return detail::payload_bits(g, timestamp_bits + node_bits,
+                                        sequence_bits);
+        }
+    };
+
+    /// A generator of time-ordered GUIDs that are unique across nodes
+    /// without coordination, and embed the ID of the node that created them
+    /// so that they can be routed by it. See [xg::sharded_layout]() for the
+    /// layout.
+    ///
+    /// A GUID is unique by construction among those of the same generator
+    /// (or of generators with the same node ID, one at a time): no two
+    /// share both the timestamp and the sequence number. The sequence
+    /// numbers of a tick are handed out to threads in blocks, with one
+    /// atomic compare-and-swap per block, and a thread takes the numbers in
+    /// its block with no synchronization. A thread's block grows from 1
+    /// number up to 256 while it keeps using up its block within the tick,
+    /// so few numbers are left unused by threads that create GUIDs rarely.
+    /// If all the sequence numbers of a tick are used, the timestamp is
+    /// advanced a tick ahead of the clock, as is it if the clock goes back.
+    ///
+    /// GUIDs created by one thread are strictly increasing. GUIDs created by
+    /// different threads are ordered by their timestamps, but not within a
+    /// tick.
+    class sharded_generator {
+    public:
+        /// \effects Constructs a generator of GUIDs with node ID `node` and
+        /// layout `layout`.
+        ///
+        /// \throws `std::system_error` with `std::errc::invalid_argument` if
+        /// the fields of the layout take more than 122 bits, more than 64
+        /// bits for the node ID, or more than 64 bits for the timestamp and
+        /// the sequence number together, if the tick isn't positive, or if
+        /// `node` doesn't fit in the node ID bits.
+        /// \output_section Constructors
+        explicit sharded_generator(
+            std::uint64_t node,
+            const sharded_layout& layout = sharded_layout{});
+
+        /// \returns A new GUID.
+        /// \throws `std::system_error` if random bytes can't be generated.
+        /// \output_section Generation
+        guid operator()();
+
+        /// \effects Creates `n` GUIDs into `[first, first + n)`, in
+        /// increasing order.
+        /// \returns `first + n`
+        /// \throws `std::system_error` if random bytes can't be generated.
+        guid* generate(guid* first, std::size_t n);
+
+        /// \returns The node ID of the GUIDs.
+        std::uint64_t node() const noexcept
+        {
+            return _node;
+        }
+        /// \returns The layout of the GUIDs.
+        const sharded_layout& layout() const noexcept
+        {
+            return _layout;
+        }
+
+    private:
+        // Reserves up to `n` consecutive sequence numbers of the current
+        // tick or a later one, as [first, last) in _state's encoding
+        void reserve(std::uint64_t now,
+                     std::uint64_t n,
+                     std::uint64_t& first,
+                     std::uint64_t& last) noexcept;
+        // The current tick, shifted to the position of _state's timestamp
+        std::uint64_t now() const noexcept;
+        // Writes the GUID of `position`, in _state's encoding, over the
+        // random bytes at `p`
+        void encode(unsigned char* p, std::uint64_t position) const noexcept;
+
+        sharded_layout _layout;
+        std::uint64_t _node;
+        // Distinguishes the per-thread blocks of different generators
+        std::uint64_t _id;
+        // The next timestamp and sequence number, with the sequence number
+        // in the low sequence_bits bits, so that using up the sequence
+        // numbers of a tick carries into the next tick
+        std::atomic<std::uint64_t> _state{0};
+    };
+}  // namespace xg
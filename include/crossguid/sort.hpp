@@ -0,0 +1,68 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#pragma once
+
+#include "guid.hpp"
+
+#include <cstddef>
+
+namespace xg {
+    /// Options for [xg::sort]().
+    struct sort_options {
+        /// Number of threads sorting in parallel.
+        /// `0` uses one per hardware thread.
+        unsigned threads{1};
+        /// Sort in place, without a buffer as large as the input.
+        bool in_place{false};
+    };
+
+    /// Sorts `[first, last)` by [`operator<`](standardese://xg::operator<),
+    /// the byte order.
+    ///
+    /// By default, sorts with a radix sort into a buffer as large as the
+    /// input. The GUIDs are distributed into 256 buckets by their first byte
+    /// (or the first byte that isn't the same in all of them), again by the
+    /// next byte while a bucket is too large for the cache, and every
+    /// bucket is then sorted by a least significant digit radix sort while
+    /// it's in cache: one stable pass per remaining byte, from the last one,
+    /// skipping bytes that are the same in every GUID of the bucket. The
+    /// histograms of all these bytes are counted in one read of the bucket.
+    /// With multiple threads, the first distribution is divided into a
+    /// contiguous block per thread, and the buckets are divided between
+    /// the threads.
+    ///
+    /// With `options.in_place`, or if the buffer can't be allocated, sorts
+    /// with an in-place most significant digit radix sort (American flag
+    /// sort) instead: the GUIDs are permuted into buckets by their first
+    /// byte with swaps, and every bucket is sorted recursively by the next
+    /// byte, with the buckets divided between the threads.
+    ///
+    /// Small inputs are sorted with `std::sort`.
+    /// If fewer threads than asked for can be started, sorts on the ones
+    /// that could.
+    void sort(guid* first,
+              guid* last,
+              const sort_options& options = sort_options{});
+}  // namespace xg
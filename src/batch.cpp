@@ -0,0 +1,497 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#include "crossguid/batch.hpp"
+
+#include "parallel.hpp"
+#include "parse.hpp"
+#include "simd.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+namespace xg {
+    namespace {
+        using format_kernel = void (*)(const guid* in,
+                                       std::size_t n,
+                                       char* text,
+                                       std::size_t stride,
+                                       format_flags flags);
+
+        void format_rows_scalar(const guid* in,
+                                std::size_t n,
+                                char* text,
+                                std::size_t stride,
+                                format_flags flags) noexcept
+        {
+            for (std::size_t i = 0; i < n; ++i) {
+                in[i].str_to(text + i * stride, flags);
+            }
+        }
+
+#if XG_HAS_X86_SIMD
+        // Splits every byte into nibbles, interleaves them into digit
+        // order, maps them to characters with a byte shuffle of a 16-entry
+        // table, and inserts the hyphens with two more shuffles
+        XG_TARGET_SSE41 void format_rows_sse41(const guid* in,
+                                               std::size_t n,
+                                               char* text,
+                                               std::size_t stride,
+                                               format_flags flags) noexcept
+        {
+            const bool upper =
+                (flags & format_flags::uppercase) != format_flags::none;
+            const bool hyphens =
+                (flags & format_flags::no_hyphens) == format_flags::none;
+            const bool braces =
+                (flags & format_flags::braces) != format_flags::none;
+            const __m128i table =
+                upper ? _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7',
+                                      '8', '9', 'A', 'B', 'C', 'D', 'E', 'F')
+                      : _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7',
+                                      '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+            const __m128i low_nibble = _mm_set1_epi8(0x0f);
+
+            // Characters 0-15 of the canonical form from digits 0-13
+            const __m128i first_shuffle = _mm_setr_epi8(
+                0, 1, 2, 3, 4, 5, 6, 7, -1, 8, 9, 10, 11, -1, 12, 13);
+            const __m128i first_hyphens = _mm_setr_epi8(
+                0, 0, 0, 0, 0, 0, 0, 0, '-', 0, 0, 0, 0, '-', 0, 0);
+            // Characters 16-31 from digits 14-15 and 16-27
+            const __m128i second_shuffle_lo = _mm_setr_epi8(
+                14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+            const __m128i second_shuffle_hi = _mm_setr_epi8(
+                -1, -1, -1, 0, 1, 2, 3, -1, 4, 5, 6, 7, 8, 9, 10, 11);
+            const __m128i second_hyphens = _mm_setr_epi8(
+                0, 0, '-', 0, 0, 0, 0, '-', 0, 0, 0, 0, 0, 0, 0, 0);
+
+            for (std::size_t i = 0; i < n; ++i) {
+                const __m128i v = _mm_loadu_si128(static_cast<const __m128i*>(
+                    static_cast<const void*>(in[i].data())));
+                const __m128i hi =
+                    _mm_and_si128(_mm_srli_epi16(v, 4), low_nibble);
+                const __m128i lo = _mm_and_si128(v, low_nibble);
+                // Digits 0-15 and 16-31
+                const __m128i a =
+                    _mm_shuffle_epi8(table, _mm_unpacklo_epi8(hi, lo));
+                const __m128i b =
+                    _mm_shuffle_epi8(table, _mm_unpackhi_epi8(hi, lo));
+
+                char* p = text + i * stride;
+                if (braces) {
+                    *p++ = '{';
+                    p[hyphens ? 36 : 32] = '}';
+                }
+                if (!hyphens) {
+                    _mm_storeu_si128(
+                        static_cast<__m128i*>(static_cast<void*>(p)), a);
+                    _mm_storeu_si128(
+                        static_cast<__m128i*>(static_cast<void*>(p + 16)), b);
+                    continue;
+                }
+
+                _mm_storeu_si128(
+                    static_cast<__m128i*>(static_cast<void*>(p)),
+                    _mm_or_si128(_mm_shuffle_epi8(a, first_shuffle),
+                                 first_hyphens));
+                _mm_storeu_si128(
+                    static_cast<__m128i*>(static_cast<void*>(p + 16)),
+                    _mm_or_si128(
+                        _mm_or_si128(_mm_shuffle_epi8(a, second_shuffle_lo),
+                                     _mm_shuffle_epi8(b, second_shuffle_hi)),
+                        second_hyphens));
+                // Characters 32-35 are digits 28-31
+                const int last = _mm_extract_epi32(b, 3);
+                std::memcpy(p + 32, &last, 4);
+            }
+        }
+#endif  // XG_HAS_X86_SIMD
+
+        format_kernel select_format_kernel() noexcept
+        {
+#if XG_HAS_X86_SIMD
+            if (detail::cpu().sse41) {
+                return format_rows_sse41;
+            }
+#endif
+            return format_rows_scalar;
+        }
+
+        using find_kernel = const guid* (*)(const guid* first,
+                                           const guid* last,
+                                           const guid& value);
+        using count_kernel = std::size_t (*)(const guid* first,
+                                             const guid* last,
+                                             const guid& value);
+
+        const guid* find_scalar(const guid* first,
+                                const guid* last,
+                                const guid& value) noexcept
+        {
+            for (; first != last; ++first) {
+                if (*first == value) {
+                    return first;
+                }
+            }
+            return last;
+        }
+
+        std::size_t count_scalar(const guid* first,
+                                 const guid* last,
+                                 const guid& value) noexcept
+        {
+            std::size_t n = 0;
+            for (; first != last; ++first) {
+                n += *first == value;
+            }
+            return n;
+        }
+
+#if XG_HAS_X86_SIMD
+        static_assert(sizeof(guid) == 16, "GUIDs must be contiguous bytes");
+
+        // Both 64-bit halves of GUID i match at bits 2i and 2i + 1 of the
+        // equality masks; keep bit 2i if both are set
+        inline unsigned whole_matches(unsigned halves) noexcept
+        {
+            return (halves & (halves >> 1)) & 0x55;
+        }
+
+        // The kernels first check 8 GUIDs at a time for any matching half,
+        // with a single branch, since most blocks have none, and only then
+        // find out which GUIDs match whole, 4 at a time.
+        // Bit 2i of the result is set if GUID i matches.
+        XG_TARGET_SSE41 unsigned match4_sse41(const guid* p,
+                                              __m128i key) noexcept
+        {
+            unsigned halves = 0;
+            for (unsigned i = 0; i < 4; ++i) {
+                const __m128i v = _mm_loadu_si128(static_cast<const __m128i*>(
+                    static_cast<const void*>(p + i)));
+                halves |= static_cast<unsigned>(_mm_movemask_pd(
+                              _mm_castsi128_pd(_mm_cmpeq_epi64(v, key))))
+                          << (2 * i);
+            }
+            return whole_matches(halves);
+        }
+
+        XG_TARGET_SSE41 unsigned match8_sse41(const guid* p,
+                                              __m128i key) noexcept
+        {
+            __m128i any = _mm_setzero_si128();
+            for (unsigned i = 0; i < 8; ++i) {
+                const __m128i v = _mm_loadu_si128(static_cast<const __m128i*>(
+                    static_cast<const void*>(p + i)));
+                any = _mm_or_si128(any, _mm_cmpeq_epi64(v, key));
+            }
+            if (_mm_testz_si128(any, any) != 0) {
+                return 0;
+            }
+            return match4_sse41(p, key) | match4_sse41(p + 4, key) << 8;
+        }
+
+        XG_TARGET_SSE41 const guid* find_sse41(const guid* first,
+                                               const guid* last,
+                                               const guid& value) noexcept
+        {
+            const __m128i key = _mm_loadu_si128(static_cast<const __m128i*>(
+                static_cast<const void*>(value.data())));
+            for (; last - first >= 8; first += 8) {
+                const auto m = match8_sse41(first, key);
+                if (m != 0) {
+                    return first + detail::count_trailing_zeros(m) / 2;
+                }
+            }
+            return find_scalar(first, last, value);
+        }
+
+        XG_TARGET_SSE41 std::size_t count_sse41(const guid* first,
+                                                const guid* last,
+                                                const guid& value) noexcept
+        {
+            const __m128i key = _mm_loadu_si128(static_cast<const __m128i*>(
+                static_cast<const void*>(value.data())));
+            std::size_t n = 0;
+            for (; last - first >= 8; first += 8) {
+                n += detail::popcount(match8_sse41(first, key));
+            }
+            return n + count_scalar(first, last, value);
+        }
+
+        XG_TARGET_AVX2 __m256i load2_avx2(const guid* p) noexcept
+        {
+            return _mm256_loadu_si256(
+                static_cast<const __m256i*>(static_cast<const void*>(p)));
+        }
+
+        XG_TARGET_AVX2 unsigned match4_avx2(const guid* p,
+                                            __m256i key) noexcept
+        {
+            const auto lo = static_cast<unsigned>(_mm256_movemask_pd(
+                _mm256_castsi256_pd(_mm256_cmpeq_epi64(load2_avx2(p), key))));
+            const auto hi = static_cast<unsigned>(_mm256_movemask_pd(
+                _mm256_castsi256_pd(
+                    _mm256_cmpeq_epi64(load2_avx2(p + 2), key))));
+            return whole_matches(lo | hi << 4);
+        }
+
+        XG_TARGET_AVX2 unsigned match8_avx2(const guid* p,
+                                            __m256i key) noexcept
+        {
+            const __m256i any = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi64(load2_avx2(p), key),
+                                _mm256_cmpeq_epi64(load2_avx2(p + 2), key)),
+                _mm256_or_si256(_mm256_cmpeq_epi64(load2_avx2(p + 4), key),
+                                _mm256_cmpeq_epi64(load2_avx2(p + 6), key)));
+            if (_mm256_testz_si256(any, any) != 0) {
+                return 0;
+            }
+            return match4_avx2(p, key) | match4_avx2(p + 4, key) << 8;
+        }
+
+        XG_TARGET_AVX2 __m256i broadcast_avx2(const guid& value) noexcept
+        {
+            return _mm256_broadcastsi128_si256(
+                _mm_loadu_si128(static_cast<const __m128i*>(
+                    static_cast<const void*>(value.data()))));
+        }
+
+        XG_TARGET_AVX2 const guid* find_avx2(const guid* first,
+                                             const guid* last,
+                                             const guid& value) noexcept
+        {
+            const __m256i key = broadcast_avx2(value);
+            for (; last - first >= 8; first += 8) {
+                const auto m = match8_avx2(first, key);
+                if (m != 0) {
+                    return first + detail::count_trailing_zeros(m) / 2;
+                }
+            }
+            return find_scalar(first, last, value);
+        }
+
+        XG_TARGET_AVX2 std::size_t count_avx2(const guid* first,
+                                              const guid* last,
+                                              const guid& value) noexcept
+        {
+            const __m256i key = broadcast_avx2(value);
+            std::size_t n = 0;
+            for (; last - first >= 8; first += 8) {
+                n += detail::popcount(match8_avx2(first, key));
+            }
+            return n + count_scalar(first, last, value);
+        }
+#endif  // XG_HAS_X86_SIMD
+
+        find_kernel select_find_kernel() noexcept
+        {
+#if XG_HAS_X86_SIMD
+            if (detail::cpu().avx2) {
+                return find_avx2;
+            }
+            if (detail::cpu().sse41) {
+                return find_sse41;
+            }
+#endif
+            return find_scalar;
+        }
+
+        count_kernel select_count_kernel() noexcept
+        {
+#if XG_HAS_X86_SIMD
+            if (detail::cpu().avx2) {
+                return count_avx2;
+            }
+            if (detail::cpu().sse41) {
+                return count_sse41;
+            }
+#endif
+            return count_scalar;
+        }
+
+        using ms_kernel = void (*)(const unsigned char* in,
+                                   std::size_t n,
+                                   unsigned char* out);
+
+        // The conversion is the same in both directions. Each GUID is read
+        // whole before it's written, so in and out may be the same.
+        void swap_ms_fields_scalar(const unsigned char* in,
+                                   std::size_t n,
+                                   unsigned char* out) noexcept
+        {
+            for (std::size_t i = 0; i < n; ++i, in += 16, out += 16) {
+                const auto b = detail::swap_ms_fields(in);
+                std::memcpy(out, b.data(), 16);
+            }
+        }
+
+#if XG_HAS_X86_SIMD
+        XG_TARGET_SSE41 __m128i ms_shuffle_sse41() noexcept
+        {
+            return _mm_setr_epi8(3, 2, 1, 0, 5, 4, 7, 6, 8, 9, 10, 11, 12, 13,
+                                 14, 15);
+        }
+
+        XG_TARGET_SSE41 void swap_ms_fields_sse41(const unsigned char* in,
+                                                  std::size_t n,
+                                                  unsigned char* out) noexcept
+        {
+            const __m128i shuffle = ms_shuffle_sse41();
+            for (std::size_t i = 0; i < n; ++i, in += 16, out += 16) {
+                const __m128i v = _mm_loadu_si128(
+                    static_cast<const __m128i*>(static_cast<const void*>(in)));
+                _mm_storeu_si128(static_cast<__m128i*>(static_cast<void*>(out)),
+                                 _mm_shuffle_epi8(v, shuffle));
+            }
+        }
+
+        // vpshufb shuffles within each 128-bit lane, so one mask converts
+        // the 2 GUIDs of a register
+        XG_TARGET_AVX2 void swap_ms_fields_avx2(const unsigned char* in,
+                                                std::size_t n,
+                                                unsigned char* out) noexcept
+        {
+            const __m256i shuffle =
+                _mm256_broadcastsi128_si256(ms_shuffle_sse41());
+            for (; n >= 4; n -= 4, in += 64, out += 64) {
+                const __m256i a = _mm256_loadu_si256(
+                    static_cast<const __m256i*>(static_cast<const void*>(in)));
+                const __m256i b =
+                    _mm256_loadu_si256(static_cast<const __m256i*>(
+                        static_cast<const void*>(in + 32)));
+                _mm256_storeu_si256(
+                    static_cast<__m256i*>(static_cast<void*>(out)),
+                    _mm256_shuffle_epi8(a, shuffle));
+                _mm256_storeu_si256(
+                    static_cast<__m256i*>(static_cast<void*>(out + 32)),
+                    _mm256_shuffle_epi8(b, shuffle));
+            }
+            swap_ms_fields_sse41(in, n, out);
+        }
+#endif  // XG_HAS_X86_SIMD
+
+        ms_kernel select_ms_kernel() noexcept
+        {
+#if XG_HAS_X86_SIMD
+            if (detail::cpu().avx2) {
+                return swap_ms_fields_avx2;
+            }
+            if (detail::cpu().sse41) {
+                return swap_ms_fields_sse41;
+            }
+#endif
+            return swap_ms_fields_scalar;
+        }
+
+        // A multiple of 8, so that tasks don't share bytes of the bitmap
+        std::size_t task_rows(const batch_options& options) noexcept
+        {
+            return (std::max<std::size_t>(options.rows_per_task, 1) + 7) / 8 *
+                   8;
+        }
+    }  // namespace
+
+    std::size_t parse_batch(const char* text,
+                            std::size_t stride,
+                            std::size_t n,
+                            guid* out,
+                            std::uint8_t* valid,
+                            const batch_options& options)
+    {
+        const auto rows = task_rows(options);
+        const auto tasks = (n + rows - 1) / rows;
+        const auto threads = detail::thread_count(options.threads, tasks);
+        if (threads <= 1) {
+            return detail::parse_canonical_rows(text, stride, n, out, valid);
+        }
+
+        std::atomic<std::size_t> total{0};
+        detail::parallel_for(tasks, threads, [&](std::size_t t) {
+            const auto first = t * rows;
+            const auto count = detail::parse_canonical_rows(
+                text + first * stride, stride, std::min(rows, n - first),
+                out + first, valid != nullptr ? valid + first / 8 : nullptr);
+            total.fetch_add(count, std::memory_order_relaxed);
+        });
+        return total.load();
+    }
+
+    void format_batch(const guid* in,
+                      std::size_t n,
+                      char* text,
+                      std::size_t stride,
+                      format_flags flags,
+                      const batch_options& options)
+    {
+        static const format_kernel kernel = select_format_kernel();
+
+        const auto rows = task_rows(options);
+        const auto tasks = (n + rows - 1) / rows;
+        const auto threads = detail::thread_count(options.threads, tasks);
+        if (threads <= 1) {
+            kernel(in, n, text, stride, flags);
+            return;
+        }
+
+        detail::parallel_for(tasks, threads, [&](std::size_t t) {
+            const auto first = t * rows;
+            kernel(in + first, std::min(rows, n - first), text + first * stride,
+                   stride, flags);
+        });
+    }
+
+    const guid* find(const guid* first,
+                     const guid* last,
+                     const guid& value) noexcept
+    {
+        static const find_kernel kernel = select_find_kernel();
+        return kernel(first, last, value);
+    }
+
+    std::size_t count(const guid* first,
+                      const guid* last,
+                      const guid& value) noexcept
+    {
+        static const count_kernel kernel = select_count_kernel();
+        return kernel(first, last, value);
+    }
+
+    void to_ms_bytes(const guid* in,
+                     std::size_t n,
+                     unsigned char* out) noexcept
+    {
+        static const ms_kernel kernel = select_ms_kernel();
+        kernel(static_cast<const unsigned char*>(static_cast<const void*>(in)),
+               n, out);
+    }
+
+    void from_ms_bytes(const unsigned char* in,
+                       std::size_t n,
+                       guid* out) noexcept
+    {
+        static const ms_kernel kernel = select_ms_kernel();
+        kernel(in, n, static_cast<unsigned char*>(static_cast<void*>(out)));
+    }
+}  // namespace xg
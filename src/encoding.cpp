@@ -0,0 +1,439 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#include "crossguid/encoding.hpp"
+
+#include "simd.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+namespace xg {
+    namespace {
+        const char base64url_digits[] =
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+        const char base32_digits[] = "0123456789ABCDEFGHJKMNPQRSTVWXYZ";
+        const char base58_digits[] =
+            "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+
+        // Digit values of every character, 0xff for invalid ones
+        struct digit_tables {
+            unsigned char base64url[256];
+            unsigned char base32[256];
+            unsigned char base58[256];
+
+            digit_tables() noexcept
+            {
+                std::memset(base64url, 0xff, sizeof(base64url));
+                std::memset(base32, 0xff, sizeof(base32));
+                std::memset(base58, 0xff, sizeof(base58));
+                for (unsigned char i = 0; i < 64; ++i) {
+                    base64url[static_cast<unsigned char>(
+                        base64url_digits[i])] = i;
+                }
+                for (unsigned char i = 0; i < 32; ++i) {
+                    const auto ch =
+                        static_cast<unsigned char>(base32_digits[i]);
+                    base32[ch] = i;
+                    if (ch >= 'A' && ch <= 'Z') {
+                        base32[ch - 'A' + 'a'] = i;
+                    }
+                }
+                for (const char* p = "IiLl"; *p != '\0'; ++p) {
+                    base32[static_cast<unsigned char>(*p)] = 1;
+                }
+                base32[static_cast<unsigned char>('O')] = 0;
+                base32[static_cast<unsigned char>('o')] = 0;
+                for (unsigned char i = 0; i < 58; ++i) {
+                    base58[static_cast<unsigned char>(base58_digits[i])] = i;
+                }
+            }
+        };
+
+        const digit_tables& tables() noexcept
+        {
+            static const digit_tables t;
+            return t;
+        }
+
+        std::uint64_t load_be64(const unsigned char* b) noexcept
+        {
+            std::uint64_t v = 0;
+            for (std::size_t i = 0; i < 8; ++i) {
+                v = v << 8 | b[i];
+            }
+            return v;
+        }
+
+        void store_be64(std::uint64_t v, unsigned char* out) noexcept
+        {
+            for (std::size_t i = 0; i < 8; ++i) {
+                out[7 - i] = static_cast<unsigned char>(v >> (8 * i));
+            }
+        }
+
+        // Writes the lowest `n` digits of `Bits` bits of `v` to `out`, most
+        // significant first.
+        // The 128 bits of a GUID are split into pieces of up to 64 bits, so
+        // that every piece is converted independently with word-wide shifts.
+        template <unsigned Bits>
+        void put_digits(std::uint64_t v,
+                        std::size_t n,
+                        const char* digits,
+                        char* out) noexcept
+        {
+            for (std::size_t i = n; i-- > 0;) {
+                out[i] = digits[v & ((1u << Bits) - 1)];
+                v >>= Bits;
+            }
+        }
+
+        // Reads `n` digits of `Bits` bits from `s`, most significant first.
+        // Invalid characters set the top bit of `seen`.
+        template <unsigned Bits>
+        std::uint64_t get_digits(const char* s,
+                                 std::size_t n,
+                                 const unsigned char* table,
+                                 unsigned& seen) noexcept
+        {
+            std::uint64_t v = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                const unsigned d = table[static_cast<unsigned char>(s[i])];
+                seen |= d;
+                v = v << Bits | (d & ((1u << Bits) - 1));
+            }
+            return v;
+        }
+
+        // 132 bits: digits 0-9 are the top 60 bits of the first half, digit
+        // 10 straddles the halves, digits 11-20 are the next 60 bits, and
+        // digit 21 holds the last 2 bits followed by 4 zeros
+        void encode_base64url_scalar(const unsigned char* bytes,
+                                     char* out) noexcept
+        {
+            const auto hi = load_be64(bytes);
+            const auto lo = load_be64(bytes + 8);
+            put_digits<6>(hi >> 4, 10, base64url_digits, out);
+            out[10] = base64url_digits[(hi & 15) << 2 | lo >> 62];
+            put_digits<6>(lo >> 2, 10, base64url_digits, out + 11);
+            out[21] = base64url_digits[(lo & 3) << 4];
+        }
+
+        bool decode_base64url_scalar(const char* s,
+                                     unsigned char* out) noexcept
+        {
+            const auto& table = tables().base64url;
+            unsigned seen = 0;
+            const auto top = get_digits<6>(s, 10, table, seen);
+            const auto middle = get_digits<6>(s + 10, 1, table, seen);
+            const auto bottom = get_digits<6>(s + 11, 10, table, seen);
+            const unsigned last = table[static_cast<unsigned char>(s[21])];
+            // The 4 unused bits must be zero
+            seen |= last | (last & 15) << 7;
+
+            store_be64(top << 4 | middle >> 2, out);
+            store_be64(middle << 62 | bottom << 2 | (last & 63) >> 4,
+                       out + 8);
+            return (seen & 0x80) == 0;
+        }
+
+#if XG_HAS_X86_SIMD
+        // The first 12 bytes to 16 digits with shuffles and multiplies,
+        // the 4 others like the scalar version
+        XG_TARGET_SSE41 void encode_base64url_sse41(const unsigned char* bytes,
+                                                    char* out) noexcept
+        {
+            __m128i in = _mm_loadu_si128(
+                static_cast<const __m128i*>(static_cast<const void*>(bytes)));
+            // Every 3 bytes to a 32-bit lane, then every 6 bits to a byte
+            in = _mm_shuffle_epi8(in, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7,
+                                                    6, 8, 7, 10, 9, 11, 10));
+            const __m128i hi = _mm_mulhi_epu16(
+                _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)),
+                _mm_set1_epi32(0x04000040));
+            const __m128i lo = _mm_mullo_epi16(
+                _mm_and_si128(in, _mm_set1_epi32(0x003f03f0)),
+                _mm_set1_epi32(0x01000010));
+            const __m128i digits = _mm_or_si128(hi, lo);
+
+            // Offset to the character by range: 0-25 (index 13), 26-51
+            // (index 0), 52-61 (indices 1-10), 62 (11) and 63 (12)
+            __m128i index = _mm_subs_epu8(digits, _mm_set1_epi8(51));
+            index = _mm_or_si128(
+                index, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), digits),
+                                     _mm_set1_epi8(13)));
+            const __m128i offsets = _mm_setr_epi8(
+                'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '-' - 62,
+                '_' - 63, 'A', 0, 0);
+            _mm_storeu_si128(
+                static_cast<__m128i*>(static_cast<void*>(out)),
+                _mm_add_epi8(digits, _mm_shuffle_epi8(offsets, index)));
+
+            const auto tail = load_be64(bytes + 8) & 0xffffffff;
+            put_digits<6>(tail >> 2, 5, base64url_digits, out + 16);
+            out[21] = base64url_digits[(tail & 3) << 4];
+        }
+
+        XG_TARGET_SSE41 bool decode_base64url_sse41(const char* s,
+                                                    unsigned char* out) noexcept
+        {
+            const __m128i in = _mm_loadu_si128(
+                static_cast<const __m128i*>(static_cast<const void*>(s)));
+            const auto in_range = [in](char first, char last) {
+                const __m128i lo = _mm_set1_epi8(static_cast<char>(first - 1));
+                const __m128i hi = _mm_set1_epi8(static_cast<char>(last + 1));
+                return _mm_and_si128(_mm_cmpgt_epi8(in, lo),
+                                     _mm_cmpgt_epi8(hi, in));
+            };
+            const __m128i upper = in_range('A', 'Z');
+            const __m128i lower = in_range('a', 'z');
+            const __m128i digit = in_range('0', '9');
+            const __m128i dash = _mm_cmpeq_epi8(in, _mm_set1_epi8('-'));
+            const __m128i underscore = _mm_cmpeq_epi8(in, _mm_set1_epi8('_'));
+            const __m128i valid = _mm_or_si128(
+                _mm_or_si128(upper, lower),
+                _mm_or_si128(digit, _mm_or_si128(dash, underscore)));
+
+            __m128i offsets = _mm_and_si128(upper, _mm_set1_epi8(-'A'));
+            offsets = _mm_or_si128(
+                offsets, _mm_and_si128(lower, _mm_set1_epi8(26 - 'a')));
+            offsets = _mm_or_si128(
+                offsets, _mm_and_si128(digit, _mm_set1_epi8(52 - '0')));
+            offsets = _mm_or_si128(
+                offsets, _mm_and_si128(dash, _mm_set1_epi8(62 - '-')));
+            offsets = _mm_or_si128(
+                offsets, _mm_and_si128(underscore, _mm_set1_epi8(63 - '_')));
+            const __m128i digits = _mm_add_epi8(in, offsets);
+
+            // Pairs of 6 bits to 12, then pairs of 12 to 24 in every 32-bit
+            // lane, and the 3 bytes of every lane to the output
+            const __m128i pairs =
+                _mm_maddubs_epi16(digits, _mm_set1_epi32(0x01400140));
+            const __m128i lanes =
+                _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+            const __m128i packed = _mm_shuffle_epi8(
+                lanes, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1,
+                                     -1, -1, -1));
+            unsigned char buf[16];
+            _mm_storeu_si128(static_cast<__m128i*>(static_cast<void*>(buf)),
+                             packed);
+            std::memcpy(out, buf, 12);
+
+            // The last 6 digits to the last 4 bytes
+            const auto& table = tables().base64url;
+            unsigned seen = 0;
+            const auto tail = get_digits<6>(s + 16, 5, table, seen);
+            const unsigned last = table[static_cast<unsigned char>(s[21])];
+            seen |= last | (last & 15) << 7;
+            const auto word = tail << 2 | (last & 63) >> 4;
+            for (std::size_t i = 0; i < 4; ++i) {
+                out[15 - i] = static_cast<unsigned char>(word >> (8 * i));
+            }
+            return _mm_movemask_epi8(valid) == 0xffff && (seen & 0x80) == 0;
+        }
+#endif  // XG_HAS_X86_SIMD
+
+        // 130 bits with 2 leading zeros: digits 0-12 are the top 63 bits,
+        // digit 13 straddles the halves, and digits 14-25 are the last 60
+        // bits
+        void encode_base32(const unsigned char* bytes, char* out) noexcept
+        {
+            const auto hi = load_be64(bytes);
+            const auto lo = load_be64(bytes + 8);
+            put_digits<5>(hi >> 1, 13, base32_digits, out);
+            out[13] = base32_digits[(hi & 1) << 4 | lo >> 60];
+            put_digits<5>(lo, 12, base32_digits, out + 14);
+        }
+
+        bool decode_base32(const char* s, unsigned char* out) noexcept
+        {
+            const auto& table = tables().base32;
+            unsigned seen = 0;
+            const auto top = get_digits<5>(s, 13, table, seen);
+            const auto middle = get_digits<5>(s + 13, 1, table, seen);
+            const auto bottom = get_digits<5>(s + 14, 12, table, seen);
+            // The first digit can only hold 3 bits
+            const unsigned first = table[static_cast<unsigned char>(s[0])];
+            seen |= (first & 0x18) << 4;
+
+            store_be64(top << 1 | middle >> 4, out);
+            store_be64(middle << 60 | bottom, out + 8);
+            return (seen & 0x80) == 0;
+        }
+
+        // Base58 goes through limbs of 5 digits, 58^5 < 2^32, held in 32-bit
+        // integers so that every step is a 64-bit multiply or a division by
+        // a constant
+        const std::uint32_t base58_limb = 58u * 58u * 58u * 58u * 58u;
+
+        void encode_base58(const unsigned char* bytes, char* out) noexcept
+        {
+            // Little-endian 32-bit words
+            std::uint32_t words[4];
+            for (std::size_t i = 0; i < 4; ++i) {
+                const unsigned char* b = bytes + 12 - 4 * i;
+                words[i] = std::uint32_t{b[0]} << 24 |
+                           std::uint32_t{b[1]} << 16 |
+                           std::uint32_t{b[2]} << 8 | b[3];
+            }
+
+            // 4 limbs of 5 digits, and the quotient below 58^2 is the first
+            // 2 digits, since 2^128 < 58^22
+            std::uint32_t limbs[5];
+            for (std::size_t l = 0; l < 4; ++l) {
+                std::uint64_t rem = 0;
+                for (std::size_t i = 4; i-- > 0;) {
+                    const std::uint64_t t = rem << 32 | words[i];
+                    words[i] = static_cast<std::uint32_t>(t / base58_limb);
+                    rem = t % base58_limb;
+                }
+                limbs[4 - l] = static_cast<std::uint32_t>(rem);
+            }
+            limbs[0] = words[0];
+
+            for (std::size_t i = 22; i-- > 2;) {
+                auto& limb = limbs[(i + 3) / 5];
+                out[i] = base58_digits[limb % 58];
+                limb /= 58;
+            }
+            out[1] = base58_digits[limbs[0] % 58];
+            out[0] = base58_digits[limbs[0] / 58];
+        }
+
+        bool decode_base58(const char* s, unsigned char* out) noexcept
+        {
+            const auto& table = tables().base58;
+            unsigned seen = 0;
+            const auto limb_value = [&seen, &table](const char* p,
+                                                    std::size_t n) {
+                std::uint32_t limb = 0;
+                for (std::size_t i = 0; i < n; ++i) {
+                    const unsigned d = table[static_cast<unsigned char>(p[i])];
+                    seen |= d;
+                    limb = limb * 58 + (d & 63);
+                }
+                return limb;
+            };
+
+            std::uint32_t words[4] = {limb_value(s, 2), 0, 0, 0};
+            std::uint64_t overflow = 0;
+            for (std::size_t l = 0; l < 4; ++l) {
+                std::uint64_t carry = limb_value(s + 2 + 5 * l, 5);
+                for (auto& w : words) {
+                    const std::uint64_t t =
+                        std::uint64_t{w} * base58_limb + carry;
+                    w = static_cast<std::uint32_t>(t);
+                    carry = t >> 32;
+                }
+                overflow |= carry;
+            }
+
+            for (std::size_t i = 0; i < 4; ++i) {
+                unsigned char* b = out + 12 - 4 * i;
+                b[0] = static_cast<unsigned char>(words[i] >> 24);
+                b[1] = static_cast<unsigned char>(words[i] >> 16);
+                b[2] = static_cast<unsigned char>(words[i] >> 8);
+                b[3] = static_cast<unsigned char>(words[i]);
+            }
+            return (seen & 0x80) == 0 && overflow == 0;
+        }
+
+        using encode_kernel = void (*)(const unsigned char*, char*);
+        using decode_kernel = bool (*)(const char*, unsigned char*);
+
+        encode_kernel select_base64url_encode() noexcept
+        {
+#if XG_HAS_X86_SIMD
+            if (detail::cpu().sse41) {
+                return encode_base64url_sse41;
+            }
+#endif
+            return encode_base64url_scalar;
+        }
+
+        decode_kernel select_base64url_decode() noexcept
+        {
+#if XG_HAS_X86_SIMD
+            if (detail::cpu().sse41) {
+                return decode_base64url_sse41;
+            }
+#endif
+            return decode_base64url_scalar;
+        }
+    }  // namespace
+
+    namespace detail {
+        void encode(const unsigned char* bytes, encoding e, char* out) noexcept
+        {
+            static const encode_kernel base64url = select_base64url_encode();
+            switch (e) {
+                case encoding::base64url:
+                    base64url(bytes, out);
+                    return;
+                case encoding::base32:
+                    encode_base32(bytes, out);
+                    return;
+                case encoding::base58:
+                    encode_base58(bytes, out);
+                    return;
+                default:
+                    return;
+            }
+        }
+    }  // namespace detail
+
+    parse_result decode(const char* first,
+                        const char* last,
+                        encoding e) noexcept
+    {
+        static const decode_kernel base64url = select_base64url_decode();
+
+        const parse_result error{guid{}, first, std::errc::invalid_argument};
+        const auto size = encoded_size(e);
+        if (static_cast<std::size_t>(last - first) < size) {
+            return error;
+        }
+
+        std::array<unsigned char, 16> bytes;
+        bool ok = false;
+        switch (e) {
+            case encoding::base64url:
+                ok = base64url(first, bytes.data());
+                break;
+            case encoding::base32:
+                ok = decode_base32(first, bytes.data());
+                break;
+            case encoding::base58:
+                ok = decode_base58(first, bytes.data());
+                break;
+            default:
+                break;
+        }
+        if (!ok) {
+            return error;
+        }
+        return {guid{bytes}, first + size, std::errc{}};
+    }
+}  // namespace xg
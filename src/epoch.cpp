@@ -0,0 +1,277 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#include "crossguid/epoch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <vector>
+
+// The design of crossbeam-epoch: threads announce the global epoch they
+// saw when entering a guard, with a sequentially consistent fence between
+// the announcement and their reads, and the epoch advances only when all
+// of the threads in guards have announced the current one.
+
+#if defined(__SANITIZE_THREAD__)
+#define XG_TSAN 1
+#elif defined(__has_feature)
+#if __has_feature(thread_sanitizer)
+#define XG_TSAN 1
+#endif
+#endif
+
+namespace xg {
+    namespace detail {
+        namespace {
+            // ThreadSanitizer doesn't support fences, and the
+            // happens-before relations it checks don't rely on them: the
+            // reclamation itself is ordered by acquire and release
+            // operations
+            void full_fence() noexcept
+            {
+#ifdef XG_TSAN
+                static std::atomic<int> dummy{0};
+                dummy.fetch_add(0, std::memory_order_seq_cst);
+#else
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+#endif
+            }
+
+            struct retired {
+                void* pointer;
+                void (*deleter)(void*);
+                std::uint64_t epoch;
+            };
+
+            // Retired objects a thread collects before trying to advance the
+            // epoch and destroy them
+            const std::size_t collect_threshold = 64;
+
+            struct thread_record {
+                // (epoch << 1) | 1 while in a guard, 0 otherwise
+                std::atomic<std::uint64_t> state{0};
+                std::atomic<bool> in_use{true};
+                thread_record* next{nullptr};
+                // Only used by the thread owning the record
+                unsigned nesting{0};
+                std::vector<retired> garbage;
+                std::size_t collect_at{collect_threshold};
+                // So that the states of different threads don't share a
+                // cache line
+                char pad[64];
+            };
+
+            struct domain {
+                std::atomic<std::uint64_t> epoch{0};
+                // Every record ever created, reused when threads exit
+                std::atomic<thread_record*> records{nullptr};
+                // The garbage of exited threads
+                std::mutex orphans_mutex;
+                std::vector<retired> orphans;
+
+                // Only runs at exit, when no other threads are using the
+                // domain
+                ~domain()
+                {
+                    for (const auto& r : orphans) {
+                        r.deleter(r.pointer);
+                    }
+                    auto* rec = records.load(std::memory_order_acquire);
+                    while (rec != nullptr) {
+                        auto* next = rec->next;
+                        for (const auto& r : rec->garbage) {
+                            r.deleter(r.pointer);
+                        }
+                        delete rec;
+                        rec = next;
+                    }
+                }
+            };
+
+            domain& global() noexcept
+            {
+                static domain d;
+                return d;
+            }
+
+            thread_record* acquire_record()
+            {
+                auto& d = global();
+                for (auto* r = d.records.load(std::memory_order_acquire);
+                     r != nullptr; r = r->next) {
+                    bool expected = false;
+                    if (!r->in_use.load(std::memory_order_relaxed) &&
+                        r->in_use.compare_exchange_strong(
+                            expected, true, std::memory_order_acquire)) {
+                        return r;
+                    }
+                }
+                auto* r = new thread_record;
+                r->next = d.records.load(std::memory_order_relaxed);
+                while (!d.records.compare_exchange_weak(
+                    r->next, r, std::memory_order_release,
+                    std::memory_order_relaxed)) {
+                }
+                return r;
+            }
+
+            // Owns the record of a thread, and gives it back at exit
+            struct record_owner {
+                thread_record* record{acquire_record()};
+
+                ~record_owner()
+                {
+                    if (!record->garbage.empty()) {
+                        auto& d = global();
+                        std::lock_guard<std::mutex> lock(d.orphans_mutex);
+                        try {
+                            d.orphans.insert(d.orphans.end(),
+                                             record->garbage.begin(),
+                                             record->garbage.end());
+                            record->garbage.clear();
+                        }
+                        catch (const std::bad_alloc&) {
+                            // Left to the next thread to use the record
+                        }
+                    }
+                    record->in_use.store(false, std::memory_order_release);
+                }
+            };
+
+            thread_record& local_record()
+            {
+                thread_local record_owner owner;
+                return *owner.record;
+            }
+
+            // Advances the epoch if every thread in a guard has announced
+            // the current one. Called in a guard, so that the epoch can't
+            // advance twice meanwhile.
+            std::uint64_t try_advance(domain& d) noexcept
+            {
+                const auto e = d.epoch.load(std::memory_order_acquire);
+                full_fence();
+                for (auto* r = d.records.load(std::memory_order_acquire);
+                     r != nullptr; r = r->next) {
+                    const auto state = r->state.load(std::memory_order_acquire);
+                    if ((state & 1) != 0 && (state >> 1) != e) {
+                        return e;
+                    }
+                }
+                auto expected = e;
+                d.epoch.compare_exchange_strong(expected, e + 1,
+                                                std::memory_order_acq_rel,
+                                                std::memory_order_acquire);
+                return expected == e ? e + 1 : expected;
+            }
+
+            // Destroys the objects in `garbage` retired two epochs before
+            // `epoch` or earlier
+            void collect(std::vector<retired>& garbage,
+                         std::uint64_t epoch) noexcept
+            {
+                std::size_t kept = 0;
+                for (const auto& r : garbage) {
+                    if (epoch - r.epoch >= 2) {
+                        r.deleter(r.pointer);
+                    }
+                    else {
+                        garbage[kept++] = r;
+                    }
+                }
+                garbage.resize(kept);
+            }
+
+            // Doubles the capacity of `garbage`, if there's memory for it
+            bool make_room(std::vector<retired>& garbage) noexcept
+            {
+                try {
+                    garbage.reserve(
+                        std::max(2 * garbage.capacity(), collect_threshold));
+                    return true;
+                }
+                catch (const std::bad_alloc&) {
+                    return false;
+                }
+            }
+        }  // namespace
+
+        epoch_guard::epoch_guard() : _record(&local_record())
+        {
+            auto& r = *static_cast<thread_record*>(_record);
+            if (r.nesting++ == 0) {
+                const auto e = global().epoch.load(std::memory_order_relaxed);
+                // A sequentially consistent exchange rather than a store
+                // and a fence, which costs the same on x86 or less
+                r.state.exchange((e << 1) | 1, std::memory_order_seq_cst);
+            }
+        }
+
+        epoch_guard::~epoch_guard()
+        {
+            auto& r = *static_cast<thread_record*>(_record);
+            if (--r.nesting == 0) {
+                r.state.store(0, std::memory_order_release);
+            }
+        }
+
+        void epoch_retire(void* p, void (*deleter)(void*)) noexcept
+        {
+            auto& d = global();
+            // Has a record, since it's in a guard
+            auto& r = local_record();
+            full_fence();
+            const auto retired_at = d.epoch.load(std::memory_order_relaxed);
+            if (r.garbage.size() == r.garbage.capacity() &&
+                !make_room(r.garbage)) {
+                // Out of memory: destroy what can be to make room. If
+                // nothing can, `p` is leaked.
+                collect(r.garbage, try_advance(d));
+                if (r.garbage.size() == r.garbage.capacity()) {
+                    return;
+                }
+            }
+            r.garbage.push_back(retired{p, deleter, retired_at});
+            if (r.garbage.size() < r.collect_at) {
+                return;
+            }
+
+            const auto e = try_advance(d);
+            collect(r.garbage, e);
+            // Adopt the garbage of exited threads, if it's not contended
+            std::unique_lock<std::mutex> lock(d.orphans_mutex,
+                                              std::try_to_lock);
+            if (lock.owns_lock() && !d.orphans.empty()) {
+                collect(d.orphans, e);
+            }
+            // Try again when the objects left have doubled, so that those
+            // still protected by a slow thread aren't scanned over and over
+            r.collect_at = std::max(2 * r.garbage.size(), collect_threshold);
+        }
+    }  // namespace detail
+}  // namespace xg
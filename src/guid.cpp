@@ -24,138 +24,110 @@
 
 #include "crossguid/guid.hpp"
 
-#include <cctype>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstring>
-#include <iomanip>
-#include <iostream>
+#include <istream>
+#include <ostream>
+#include <type_traits>
 
 #ifdef GUID_LIBUUID
 #include <uuid/uuid.h>
 #endif
 
+#include "random.hpp"
+
 #ifdef GUID_CFUUID
 #include <CoreFoundation/CFUUID.h>
 #endif
 
 #ifdef GUID_WINDOWS
 #include <objbase.h>
+
+#include "crossguid/batch.hpp"
 #endif
 
 namespace xg {
     namespace detail {
-#ifdef __GNUC__
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wconversion"
-#endif
-        // converts a single hex char to a number (0 - 15)
-        static unsigned char hex_digit_to_char(unsigned char ch)
-        {
-            // 0-9
-            if (ch > 47 && ch < 58) {
-                return ch - 48;
-            }
-
-            // a-f
-            if (ch > 96 && ch < 103) {
-                return ch - 87;
-            }
-
-            // A-F
-            if (ch > 64 && ch < 71) {
-                return ch - 55;
-            }
-
-            return 0;
-        }
-
-        static bool is_valid_hex_char(unsigned char ch)
+        void random_guid_bytes(unsigned char* p, std::size_t count)
         {
-            return std::isxdigit(ch) != 0;
+#if defined(GUID_LIBUUID) || defined(GUID_CHACHA20)
+            chacha20_random_bytes(p, 16 * count);
+#else
+            make_guids(static_cast<guid*>(static_cast<void*>(p)), count);
+#endif
         }
 
-        // converts the two hexadecimal characters to an unsigned char (a byte)
-        static unsigned char hex_pair_to_char(unsigned char a, unsigned char b)
-        {
-            return hex_digit_to_char(a) * 16 + hex_digit_to_char(b);
-        }
-#ifdef __GNUC__
-#pragma GCC diagnostic pop
-#endif
+        // Unix timestamp in milliseconds in the upper 52 bits, counter in
+        // the lower 12
+        static std::atomic<std::uint64_t> v7_state{0};
     }  // namespace detail
 
-    guid::guid(const char* s) : _bytes{{0}}
-    {
-        char char1{}, char2{};
-        std::size_t next_byte = 0;
-        bool looking_for_first_char = true;
-
-        const auto end = s + std::strlen(s);
-        for (; s != end; ++s) {
-            auto ch = *s;
-
-            if (ch == '-') {
-                continue;
-            }
+    static_assert(sizeof(guid) == 16 && std::is_standard_layout<guid>::value,
+                  "make_guids fills GUIDs through their object representation");
 
-            if (next_byte >= 16 ||
-                !detail::is_valid_hex_char(static_cast<unsigned char>(ch))) {
-                // Invalid string, so bail
-                zeroify();
-                return;
-            }
-
-            if (looking_for_first_char) {
-                char1 = ch;
-                looking_for_first_char = false;
-            }
-            else {
-                char2 = ch;
-                auto byte =
-                    detail::hex_pair_to_char(static_cast<unsigned char>(char1),
-                                             static_cast<unsigned char>(char2));
-                _bytes[next_byte++] = byte;
-                looking_for_first_char = true;
-            }
+    std::ostream& operator<<(std::ostream& s, const guid& guid)
+    {
+        const std::ostream::sentry ok(s);
+        if (!ok) {
+            return s;
         }
 
-        // if there were fewer than 16 bytes in the string then the guid is bad
-        if (next_byte < 16) {
-            zeroify();
-            return;
+        char text[36];
+        guid.str_to(text, (s.flags() & std::ios_base::uppercase) != 0
+                              ? format_flags::uppercase
+                              : format_flags::none);
+
+        const std::streamsize size = 36;
+        const std::streamsize padding = std::max(s.width() - size,
+                                                 std::streamsize{0});
+        const bool left = (s.flags() & std::ios_base::adjustfield) ==
+                          std::ios_base::left;
+        auto* buf = s.rdbuf();
+        const auto pad = [&]() {
+            for (std::streamsize i = 0; i < padding; ++i) {
+                if (std::char_traits<char>::eq_int_type(
+                        buf->sputc(s.fill()), std::char_traits<char>::eof())) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        if ((!left && !pad()) || buf->sputn(text, size) != size ||
+            (left && !pad())) {
+            s.setstate(std::ios_base::badbit);
         }
+        s.width(0);
+        return s;
     }
 
-    std::ostream& operator<<(std::ostream& s, const guid& guid)
+    std::istream& operator>>(std::istream& s, guid& guid)
     {
-        auto write_byte = [](std::ostream& stream, const unsigned char* byte) {
-            stream << std::setw(2) << static_cast<int>(*byte);
-        };
-        auto write_n_bytes = [&write_byte](std::ostream& stream,
-                                           const unsigned char*& ptr,
-                                           std::size_t n) {
-            auto end = ptr + n;
-            for (; ptr != end; ++ptr) {
-                write_byte(stream, ptr);
-            }
-        };
-
-        std::ios_base::fmtflags f(
-            s.flags());  // politely don't leave the ostream in hex mode
-
-        s << std::hex << std::setfill('0');
-
-        auto data = guid.bytes().data();
-        write_n_bytes(s, data, 4);
-        s << '-';
-        write_n_bytes(s, data, 2);
-        s << '-';
-        write_n_bytes(s, data, 2);
-        s << '-';
-        write_n_bytes(s, data, 2);
-        s << '-';
-        write_n_bytes(s, data, 6);
+        const std::istream::sentry ok(s);
+        if (!ok) {
+            return s;
+        }
 
-        s.flags(f);
+        auto* buf = s.rdbuf();
+        char text[38];
+        std::streamsize size = 36;
+        auto mode = parse_mode::strict;
+        if (std::char_traits<char>::eq_int_type(
+                buf->sgetc(), std::char_traits<char>::to_int_type('{'))) {
+            size = 38;
+            mode = parse_mode::braced;
+        }
+        if (buf->sgetn(text, size) != size) {
+            s.setstate(std::ios_base::eofbit | std::ios_base::failbit);
+            return s;
+        }
+        const auto result = parse(text, text + size, mode);
+        if (!result) {
+            s.setstate(std::ios_base::failbit);
+            return s;
+        }
+        guid = result.value;
         return s;
     }
 
@@ -177,6 +149,36 @@ namespace xg {
         uuid_generate(data.data());
         return guid{std::move(data)};
     }
+
+    // uuid_generate reads the random source once per call. Reading it once
+    // for the whole range and setting the bits ourselves creates the same
+    // version 4 GUIDs.
+    guid* make_guids(guid* first, std::size_t n)
+    {
+        auto p = reinterpret_cast<unsigned char*>(first);
+        detail::os_random_bytes(p, n * 16);
+        detail::set_v4_bits(p, n);
+        return first + n;
+    }
+#endif
+
+// linux implementation without libuuid, using a per-thread userspace CSPRNG
+#ifdef GUID_CHACHA20
+    guid make_guid()
+    {
+        std::array<unsigned char, 16> data;
+        detail::chacha20_random_bytes(data.data(), data.size());
+        detail::set_v4_bits(data.data());
+        return guid{std::move(data)};
+    }
+
+    guid* make_guids(guid* first, std::size_t n)
+    {
+        auto p = reinterpret_cast<unsigned char*>(first);
+        detail::chacha20_random_bytes(p, n * 16);
+        detail::set_v4_bits(p, n);
+        return first + n;
+    }
 #endif
 
 // mac and ios version
@@ -194,66 +196,68 @@ namespace xg {
              bytes.byte14, bytes.byte15}};
         return guid{std::move(arr)};
     }
+
+    guid* make_guids(guid* first, std::size_t n)
+    {
+        return std::generate_n(first, n, make_guid);
+    }
 #endif
 
 // windows version
 #ifdef GUID_WINDOWS
+    // Windows is little-endian only, so a GUID struct in memory is in the
+    // Microsoft layout of from_ms_bytes
+    static_assert(sizeof(GUID) == 16, "GUID must be 16 bytes");
+
     guid make_guid()
     {
         GUID id;
         CoCreateGuid(&id);
 
-        std::array<unsigned char, 16> bytes = {
-            static_cast<unsigned char>((id.Data1 >> 24) & 0xFF),
-            static_cast<unsigned char>((id.Data1 >> 16) & 0xFF),
-            static_cast<unsigned char>((id.Data1 >> 8) & 0xFF),
-            static_cast<unsigned char>((id.Data1) & 0xff),
-
-            static_cast<unsigned char>((id.Data2 >> 8) & 0xFF),
-            static_cast<unsigned char>((id.Data2) & 0xff),
-
-            static_cast<unsigned char>((id.Data3 >> 8) & 0xFF),
-            static_cast<unsigned char>((id.Data3) & 0xFF),
-
-            static_cast<unsigned char>(id.Data4[0]),
-            static_cast<unsigned char>(id.Data4[1]),
-            static_cast<unsigned char>(id.Data4[2]),
-            static_cast<unsigned char>(id.Data4[3]),
-            static_cast<unsigned char>(id.Data4[4]),
-            static_cast<unsigned char>(id.Data4[5]),
-            static_cast<unsigned char>(id.Data4[6]),
-            static_cast<unsigned char>(id.Data4[7])};
+        unsigned char bytes[16];
+        std::memcpy(bytes, &id, sizeof(id));
+        return from_ms_bytes(bytes);
+    }
 
-        return guid{std::move(bytes)};
+    guid* make_guids(guid* first, std::size_t n)
+    {
+        // Create the GUIDs in place, and convert them all at once
+        for (std::size_t i = 0; i < n; ++i) {
+            GUID id;
+            CoCreateGuid(&id);
+            std::memcpy(static_cast<void*>(first + i), &id, sizeof(id));
+        }
+        from_ms_bytes(
+            static_cast<const unsigned char*>(static_cast<const void*>(first)),
+            n, first);
+        return first + n;
     }
 #endif
 
-    namespace detail {
-        template <typename...>
-        struct hash;
-
-        template <typename T>
-        struct hash<T> : public std::hash<T> {
-            using std::hash<T>::hash;
-        };
-
-        template <typename T, typename... Rest>
-        struct hash<T, Rest...> {
-            inline std::size_t operator()(const T& v, const Rest&... rest)
-            {
-                std::size_t seed = hash<Rest...>{}(rest...);
-                seed ^= hash<T>{}(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-                return seed;
-            }
-        };
-    }  // namespace detail
-}  // namespace xg
-
-namespace std {
-    std::size_t hash<xg::guid>::operator()(const xg::guid& guid) const
+    guid make_guid_v7()
     {
-        const uint64_t* p =
-            reinterpret_cast<const uint64_t*>(guid.bytes().data());
-        return xg::detail::hash<uint64_t, uint64_t>{}(p[0], p[1]);
+        using namespace std::chrono;
+        const auto now_ms = static_cast<std::uint64_t>(
+            duration_cast<milliseconds>(system_clock::now().time_since_epoch())
+                .count());
+        const std::uint64_t now = now_ms << 12;
+
+        auto prev = detail::v7_state.load(std::memory_order_relaxed);
+        std::uint64_t next;
+        do {
+            next = now > prev ? now : prev + 1;
+        } while (!detail::v7_state.compare_exchange_weak(
+            prev, next, std::memory_order_relaxed));
+
+        std::array<unsigned char, 16> data;
+        detail::random_guid_bytes(data.data(), 1);
+        const auto ts = next >> 12;
+        for (std::size_t i = 0; i < 6; ++i) {
+            data[i] = static_cast<unsigned char>(ts >> (40 - 8 * i));
+        }
+        data[6] = static_cast<unsigned char>(0x70 | ((next >> 8) & 0x0f));
+        data[7] = static_cast<unsigned char>(next);
+        data[8] = static_cast<unsigned char>((data[8] & 0x3f) | 0x80);
+        return guid{std::move(data)};
     }
-}  // namespace std
+}  // namespace xg
@@ -0,0 +1,368 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#include "crossguid/guid_column.hpp"
+
+#include "serialization.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <system_error>
+#include <utility>
+
+#ifndef _WIN32
+#include <sys/types.h>
+#endif
+
+namespace xg {
+    namespace {
+        const char magic[8] = {'x', 'g', 'c', 'o', 'l', 'u', 'm', 'n'};
+        const std::uint32_t format_version = 1;
+        const std::uint32_t flag_sorted = 1;
+        // The size of the header, and the offset of the first GUID in the
+        // files written here
+        const std::size_t header_size = 64;
+
+        struct header {
+            std::uint64_t count;
+            std::uint64_t checksum;
+            std::uint64_t offset;
+            bool sorted;
+        };
+
+        [[noreturn]] void throw_errno(const char* what)
+        {
+            throw std::system_error(errno, std::generic_category(), what);
+        }
+
+        void write_header(unsigned char* p, const header& h) noexcept
+        {
+            std::memset(p, 0, header_size);
+            std::memcpy(p, magic, sizeof magic);
+            detail::store_le(p + 8, format_version, 4);
+            detail::store_le(p + 12, h.sorted ? flag_sorted : 0, 4);
+            detail::store_le(p + 16, h.count, 8);
+            detail::store_le(p + 24, h.checksum, 8);
+            detail::store_le(p + 32, h.offset, 4);
+            detail::store_le(p + 36, sizeof(guid), 4);
+        }
+
+        // The header of a file of `file_size` bytes beginning with `p`
+        header read_header(const unsigned char* p, std::uint64_t file_size)
+        {
+            if (file_size < header_size ||
+                std::memcmp(p, magic, sizeof magic) != 0) {
+                detail::throw_invalid(
+                    "xg::guid_column: not a GUID column file");
+            }
+            if (detail::load_le(p + 8, 4) != format_version) {
+                detail::throw_invalid("xg::guid_column: unsupported version");
+            }
+            header h;
+            h.sorted = (detail::load_le(p + 12, 4) & flag_sorted) != 0;
+            h.count = detail::load_le(p + 16, 8);
+            h.checksum = detail::load_le(p + 24, 8);
+            h.offset = detail::load_le(p + 32, 4);
+            if (detail::load_le(p + 36, 4) != sizeof(guid) ||
+                h.offset % 64 != 0 || h.offset < header_size ||
+                h.offset > file_size ||
+                h.count > (file_size - h.offset) / sizeof(guid)) {
+                detail::throw_invalid("xg::guid_column: invalid header");
+            }
+            return h;
+        }
+
+        // Multiplies and folds the 128-bit product, like xg::mix_hash
+        std::uint64_t mix(std::uint64_t a, std::uint64_t b) noexcept
+        {
+            std::uint64_t lo, hi;
+            detail::mul_u128(a, b, lo, hi);
+            return lo ^ hi;
+        }
+
+        // The checksum of `n` GUIDs at position `first` onwards, added to
+        // the checksum `sum` of the ones before them. Every GUID is hashed
+        // with its position independently, so the hashes are computed in
+        // parallel by the CPU, and appending continues the sum.
+        std::uint64_t checksum(const guid* data,
+                               std::size_t n,
+                               std::uint64_t first,
+                               std::uint64_t sum) noexcept
+        {
+            const std::uint64_t k0 = 0x9e3779b97f4a7c15;
+            const std::uint64_t k1 = 0xbf58476d1ce4e5b9;
+            for (std::size_t i = 0; i < n; ++i) {
+                const auto lo = detail::load_le(data[i].data(), 8);
+                const auto hi = detail::load_le(data[i].data() + 8, 8);
+                sum += mix(lo ^ k0, hi ^ (k1 + (first + i) * k0));
+            }
+            return sum;
+        }
+
+        bool seek(std::FILE* f, std::uint64_t offset) noexcept
+        {
+#ifdef _WIN32
+            return _fseeki64(f, static_cast<long long>(offset), SEEK_SET) == 0;
+#else
+            return fseeko(f, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+        }
+
+        std::uint64_t file_size(std::FILE* f)
+        {
+#ifdef _WIN32
+            if (_fseeki64(f, 0, SEEK_END) != 0) {
+                throw_errno("xg::guid_column_writer: seek failed");
+            }
+            const long long size = _ftelli64(f);
+#else
+            if (fseeko(f, 0, SEEK_END) != 0) {
+                throw_errno("xg::guid_column_writer: seek failed");
+            }
+            const off_t size = ftello(f);
+#endif
+            if (size < 0) {
+                throw_errno("xg::guid_column_writer: seek failed");
+            }
+            return static_cast<std::uint64_t>(size);
+        }
+    }  // namespace
+
+    guid_column::guid_column(const char* path) : _file(path)
+    {
+        const auto* bytes =
+            reinterpret_cast<const unsigned char*>(_file.data());
+        const header h = read_header(bytes, _file.size());
+        _data = static_cast<const guid*>(
+            static_cast<const void*>(bytes + h.offset));
+        _size = static_cast<std::size_t>(h.count);
+        _checksum = h.checksum;
+        _sorted = h.sorted;
+    }
+
+    guid_column::guid_column(guid_column&& other) noexcept
+        : _file(std::move(other._file)),
+          _data(other._data),
+          _size(other._size),
+          _checksum(other._checksum),
+          _sorted(other._sorted)
+    {
+        other._data = nullptr;
+        other._size = 0;
+        other._checksum = 0;
+        other._sorted = true;
+    }
+
+    guid_column& guid_column::operator=(guid_column&& other) noexcept
+    {
+        if (this != &other) {
+            _file = std::move(other._file);
+            _data = other._data;
+            _size = other._size;
+            _checksum = other._checksum;
+            _sorted = other._sorted;
+            other._data = nullptr;
+            other._size = 0;
+            other._checksum = 0;
+            other._sorted = true;
+        }
+        return *this;
+    }
+
+    bool guid_column::verify() const noexcept
+    {
+        return checksum(_data, _size, 0, 0) == _checksum;
+    }
+
+    guid_column_writer::guid_column_writer(const char* path, column_mode mode)
+    {
+        std::uint64_t offset = header_size;
+        if (mode == column_mode::append) {
+            _file = std::fopen(path, "r+b");
+            if (_file == nullptr && errno != ENOENT) {
+                throw_errno("xg::guid_column_writer: open failed");
+            }
+        }
+        if (_file != nullptr) {
+            try {
+                const std::uint64_t size = file_size(_file);
+                unsigned char bytes[header_size] = {};
+                if (size != 0) {
+                    if (!seek(_file, 0) ||
+                        std::fread(bytes, 1, header_size, _file) !=
+                            header_size) {
+                        detail::throw_invalid(
+                            "xg::guid_column: not a GUID column file");
+                    }
+                    const header h = read_header(bytes, size);
+                    if (h.count > std::numeric_limits<std::size_t>::max() /
+                                      sizeof(guid)) {
+                        detail::throw_invalid(
+                            "xg::guid_column_writer: file too large");
+                    }
+                    _size = static_cast<std::size_t>(h.count);
+                    _checksum = h.checksum;
+                    _sorted = h.sorted;
+                    offset = h.offset;
+                    if (_size != 0 &&
+                        (!seek(_file, offset + (_size - 1) * sizeof(guid)) ||
+                         std::fread(&_last, sizeof(guid), 1, _file) != 1)) {
+                        throw_errno("xg::guid_column_writer: read failed");
+                    }
+                }
+            }
+            catch (...) {
+                std::fclose(_file);
+                throw;
+            }
+        }
+        else {
+            _file = std::fopen(path, "wb");
+            if (_file == nullptr) {
+                throw_errno("xg::guid_column_writer: open failed");
+            }
+        }
+        _offset = offset;
+
+        // Write the header of a new file, and position at the end of the
+        // GUIDs, overwriting any bytes after them
+        try {
+            flush();
+        }
+        catch (...) {
+            std::fclose(_file);
+            _file = nullptr;
+            throw;
+        }
+    }
+
+    guid_column_writer::guid_column_writer(guid_column_writer&& other) noexcept
+        : _file(other._file),
+          _offset(other._offset),
+          _size(other._size),
+          _checksum(other._checksum),
+          _last(other._last),
+          _sorted(other._sorted)
+    {
+        other._file = nullptr;
+    }
+
+    guid_column_writer& guid_column_writer::operator=(
+        guid_column_writer&& other) noexcept
+    {
+        if (this != &other) {
+            // Closes the current file
+            guid_column_writer old(std::move(*this));
+            _file = other._file;
+            _offset = other._offset;
+            _size = other._size;
+            _checksum = other._checksum;
+            _last = other._last;
+            _sorted = other._sorted;
+            other._file = nullptr;
+        }
+        return *this;
+    }
+
+    guid_column_writer::~guid_column_writer() noexcept
+    {
+        if (_file != nullptr) {
+            try {
+                flush();
+            }
+            catch (...) {
+            }
+            std::fclose(_file);
+            _file = nullptr;
+        }
+    }
+
+    void guid_column_writer::append(const guid* first, const guid* last)
+    {
+        if (_file == nullptr) {
+            throw std::system_error(
+                std::make_error_code(std::errc::bad_file_descriptor),
+                "xg::guid_column_writer: not open");
+        }
+        const auto n = static_cast<std::size_t>(last - first);
+        if (n == 0) {
+            return;
+        }
+        if (std::fwrite(first, sizeof(guid), n, _file) != n) {
+            throw_errno("xg::guid_column_writer: write failed");
+        }
+        if (_sorted) {
+            if (_size != 0 && *first < _last) {
+                _sorted = false;
+            }
+            for (const guid* g = first + 1; _sorted && g != last; ++g) {
+                _sorted = !(*g < g[-1]);
+            }
+        }
+        _checksum = checksum(first, n, _size, _checksum);
+        _size += n;
+        _last = last[-1];
+    }
+
+    void guid_column_writer::flush()
+    {
+        if (_file == nullptr) {
+            return;
+        }
+        header h;
+        h.count = _size;
+        h.checksum = _checksum;
+        h.offset = _offset;
+        h.sorted = _sorted;
+        unsigned char bytes[header_size];
+        write_header(bytes, h);
+        if (!seek(_file, 0) ||
+            std::fwrite(bytes, 1, header_size, _file) != header_size ||
+            !seek(_file, _offset + _size * sizeof(guid)) ||
+            std::fflush(_file) != 0) {
+            throw_errno("xg::guid_column_writer: write failed");
+        }
+    }
+
+    void guid_column_writer::close()
+    {
+        if (_file == nullptr) {
+            return;
+        }
+        std::FILE* f = _file;
+        try {
+            flush();
+        }
+        catch (...) {
+            std::fclose(f);
+            _file = nullptr;
+            throw;
+        }
+        _file = nullptr;
+        if (std::fclose(f) != 0) {
+            throw_errno("xg::guid_column_writer: close failed");
+        }
+    }
+}  // namespace xg
@@ -0,0 +1,432 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#include "crossguid/guid_filter.hpp"
+
+#include "serialization.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <system_error>
+#include <utility>
+
+namespace xg {
+    namespace {
+        // A magic number ("xgbloom" or "xgxor8" and NULs), then the format
+        // version, a reserved word, and two 64-bit words: the number of
+        // blocks and a reserved one, or the number of GUIDs and the seed.
+        // Little-endian, like the words of the blocks.
+        const char bloom_magic[8] = {'x', 'g', 'b', 'l', 'o', 'o', 'm', '\0'};
+        const char xor_magic[8] = {'x', 'g', 'x', 'o', 'r', '8', '\0', '\0'};
+        const std::uint32_t format_version = 1;
+        const std::size_t header_size = 32;
+
+        void write_header(std::ostream& out,
+                          const char (&magic)[8],
+                          std::uint64_t a,
+                          std::uint64_t b)
+        {
+            unsigned char header[header_size] = {};
+            std::memcpy(header, magic, sizeof magic);
+            detail::store_le(header + 8, format_version, 4);
+            detail::store_le(header + 16, a, 8);
+            detail::store_le(header + 24, b, 8);
+            out.write(reinterpret_cast<const char*>(header), header_size);
+        }
+
+        // Checks the magic number and version of `header`, and returns its
+        // two 64-bit words
+        std::pair<std::uint64_t, std::uint64_t> parse_header(
+            const unsigned char* header,
+            const char (&magic)[8],
+            const char* not_a_filter,
+            const char* unsupported_version)
+        {
+            if (std::memcmp(header, magic, sizeof magic) != 0) {
+                detail::throw_invalid(not_a_filter);
+            }
+            if (detail::load_le(header + 8, 4) != format_version) {
+                detail::throw_invalid(unsupported_version);
+            }
+            return {detail::load_le(header + 16, 8),
+                    detail::load_le(header + 24, 8)};
+        }
+
+        std::size_t parse_block_count(const unsigned char* header)
+        {
+            const auto words = parse_header(
+                header, bloom_magic,
+                "xg::guid_bloom_filter::load: not a Bloom filter",
+                "xg::guid_bloom_filter::load: unsupported version");
+            if (words.first >
+                std::numeric_limits<std::size_t>::max() / 64 - 1) {
+                detail::throw_invalid(
+                    "xg::guid_bloom_filter::load: invalid size");
+            }
+            return static_cast<std::size_t>(words.first);
+        }
+
+        // The number of GUIDs and the seed of a serialized xor filter
+        std::pair<std::size_t, std::uint64_t> parse_xor_header(
+            const unsigned char* header)
+        {
+            const auto words =
+                parse_header(header, xor_magic,
+                             "xg::guid_xor_filter::load: not an xor filter",
+                             "xg::guid_xor_filter::load: unsupported version");
+            if (words.first > std::numeric_limits<std::size_t>::max() / 4) {
+                detail::throw_invalid(
+                    "xg::guid_xor_filter::load: invalid size");
+            }
+            return {static_cast<std::size_t>(words.first), words.second};
+        }
+
+        // The length of each third of the fingerprints of an xor filter of
+        // `n` GUIDs: 1.23 bytes per GUID and 32 more, for a high probability
+        // of peeling the hypergraph on the first try
+        std::size_t xor_block_length(std::size_t n) noexcept
+        {
+            return n == 0 ? 0 : (32 + n / 100 * 123 + n % 100 * 123 / 100) / 3;
+        }
+
+        // The seeds tried by guid_xor_filter, from splitmix64, so that the
+        // same GUIDs always give the same filter
+        std::uint64_t next_seed(std::uint64_t& state) noexcept
+        {
+            std::uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            return z ^ (z >> 31);
+        }
+    }  // namespace
+
+    guid_bloom_filter::guid_bloom_filter(std::size_t capacity,
+                                         unsigned bits_per_key)
+    {
+        allocate(std::max<std::size_t>(
+            (capacity * bits_per_key + 511) / 512, 1));
+    }
+
+    guid_bloom_filter::guid_bloom_filter(const guid_bloom_filter& other)
+    {
+        allocate(other._blocks);
+        std::copy(other._words, other._words + 8 * _blocks, _words);
+    }
+
+    guid_bloom_filter& guid_bloom_filter::operator=(
+        const guid_bloom_filter& other)
+    {
+        if (this != &other) {
+            guid_bloom_filter tmp(other);
+            *this = std::move(tmp);
+        }
+        return *this;
+    }
+
+    guid_bloom_filter::guid_bloom_filter(guid_bloom_filter&& other) noexcept
+        : _storage(std::move(other._storage)),
+          _words(other._words),
+          _blocks(other._blocks)
+    {
+        other._storage.clear();
+        other._words = nullptr;
+        other._blocks = 0;
+    }
+
+    guid_bloom_filter& guid_bloom_filter::operator=(
+        guid_bloom_filter&& other) noexcept
+    {
+        _storage = std::move(other._storage);
+        _words = other._words;
+        _blocks = other._blocks;
+        other._storage.clear();
+        other._words = nullptr;
+        other._blocks = 0;
+        return *this;
+    }
+
+    void guid_bloom_filter::insert(const guid* first, const guid* last) noexcept
+    {
+        // Hash a group of GUIDs and prefetch their blocks first, so that
+        // the cache misses overlap
+        const std::size_t group = 16;
+        std::uint64_t keys[group];
+        while (first != last) {
+            const auto n = std::min<std::size_t>(
+                group, static_cast<std::size_t>(last - first));
+            for (std::size_t i = 0; i < n; ++i) {
+                keys[i] = detail::filter_key(first[i]);
+                detail::prefetch(block(keys[i]));
+            }
+            for (std::size_t i = 0; i < n; ++i) {
+                std::uint64_t* words = block(keys[i]);
+                const auto x = static_cast<std::uint32_t>(keys[i]);
+                for (unsigned j = 0; j < 8; ++j) {
+                    words[j] |= detail::bloom_bit(x, j);
+                }
+            }
+            first += n;
+        }
+    }
+
+    void guid_bloom_filter::clear() noexcept
+    {
+        std::fill(_words, _words + 8 * _blocks, std::uint64_t{0});
+    }
+
+    void guid_bloom_filter::allocate(std::size_t blocks)
+    {
+        _blocks = blocks;
+        if (blocks == 0) {
+            _storage.clear();
+            _words = nullptr;
+            return;
+        }
+        // Up to 7 words skipped to align the first block to a cache line
+        _storage.assign(8 * blocks + 7, 0);
+        _words =
+            _storage.data() + detail::cache_line_offset(_storage.data(), 7);
+    }
+
+    void guid_bloom_filter::save(std::ostream& out) const
+    {
+        write_header(out, bloom_magic, _blocks, 0);
+        // Little-endian words, a block at a time
+        unsigned char buf[64];
+        for (std::size_t b = 0; b < _blocks && out; ++b) {
+            for (std::size_t i = 0; i < 8; ++i) {
+                detail::store_le(buf + 8 * i, _words[8 * b + i], 8);
+            }
+            out.write(reinterpret_cast<const char*>(buf), sizeof buf);
+        }
+    }
+
+    guid_bloom_filter guid_bloom_filter::load(std::istream& in)
+    {
+        unsigned char header[header_size];
+        if (!in.read(reinterpret_cast<char*>(header), header_size)) {
+            detail::throw_invalid(
+                "xg::guid_bloom_filter::load: truncated header");
+        }
+        const std::size_t blocks = parse_block_count(header);
+        // After room for the padding, as allocate() lays it out, then
+        // converted from little-endian and moved down to the aligned
+        // position
+        std::vector<std::uint64_t> storage;
+        if (!detail::read_chunked(in, storage, 7, 8 * blocks)) {
+            detail::throw_invalid(
+                "xg::guid_bloom_filter::load: truncated data");
+        }
+        guid_bloom_filter filter;
+        if (blocks != 0) {
+            const auto offset = detail::cache_line_offset(storage.data(), 7);
+            for (std::size_t i = 0; i < 8 * blocks; ++i) {
+                storage[offset + i] = detail::load_le(
+                    reinterpret_cast<const unsigned char*>(&storage[7 + i]),
+                    8);
+            }
+            filter._blocks = blocks;
+            filter._words = storage.data() + offset;
+            filter._storage = std::move(storage);
+        }
+        return filter;
+    }
+
+    guid_bloom_filter guid_bloom_filter::load(const void* data,
+                                              std::size_t size)
+    {
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        if (size < header_size) {
+            detail::throw_invalid(
+                "xg::guid_bloom_filter::load: truncated header");
+        }
+        const std::size_t blocks = parse_block_count(bytes);
+        if ((size - header_size) / 64 != blocks ||
+            (size - header_size) % 64 != 0) {
+            detail::throw_invalid(
+                "xg::guid_bloom_filter::load: size doesn't match header");
+        }
+        guid_bloom_filter filter;
+        filter.allocate(blocks);
+        bytes += header_size;
+        for (std::size_t i = 0; i < 8 * blocks; ++i, bytes += 8) {
+            filter._words[i] = detail::load_le(bytes, 8);
+        }
+        return filter;
+    }
+
+    guid_xor_filter::guid_xor_filter(const std::vector<guid>& guids)
+    {
+        std::vector<std::uint64_t> keys(guids.size());
+        std::transform(guids.begin(), guids.end(), keys.begin(),
+                       detail::filter_key);
+        build(std::move(keys));
+    }
+
+    void guid_xor_filter::resize(std::size_t n)
+    {
+        _size = n;
+        _block_length = xor_block_length(n);
+        _fingerprints.assign(3 * _block_length, 0);
+    }
+
+    void guid_xor_filter::build(std::vector<std::uint64_t> keys)
+    {
+        resize(keys.size());
+        if (_size == 0) {
+            return;
+        }
+
+        // The number of hashes mapping to each byte, and their xor
+        struct node {
+            std::uint64_t hashes;
+            std::size_t count;
+        };
+        std::vector<node> nodes(_fingerprints.size());
+        std::vector<std::size_t> queue;
+        // The bytes peeled, in order. Each keeps the hash it was peeled
+        // with in nodes[i].hashes.
+        std::vector<std::size_t> peeled;
+        peeled.reserve(_size);
+
+        bool distinct = false;
+        std::uint64_t seed_state = 0;
+        for (;;) {
+            _seed = next_seed(seed_state);
+            std::fill(nodes.begin(), nodes.end(), node{0, 0});
+            for (const auto key : keys) {
+                const auto h = detail::xor_filter_hash(key, _seed);
+                for (unsigned i = 0; i < 3; ++i) {
+                    auto& n = nodes[slot(h, i)];
+                    n.hashes ^= h;
+                    ++n.count;
+                }
+            }
+
+            // Repeatedly peel a byte only one hash maps to, removing the
+            // hash from its other two bytes
+            queue.clear();
+            for (std::size_t i = 0; i < nodes.size(); ++i) {
+                if (nodes[i].count == 1) {
+                    queue.push_back(i);
+                }
+            }
+            peeled.clear();
+            while (!queue.empty()) {
+                const auto i = queue.back();
+                queue.pop_back();
+                if (nodes[i].count != 1) {
+                    continue;
+                }
+                const auto h = nodes[i].hashes;
+                nodes[i].count = 0;
+                peeled.push_back(i);
+                for (unsigned j = 0; j < 3; ++j) {
+                    const auto s = slot(h, j);
+                    if (s != i) {
+                        nodes[s].hashes ^= h;
+                        if (--nodes[s].count == 1) {
+                            queue.push_back(s);
+                        }
+                    }
+                }
+            }
+            if (peeled.size() == _size) {
+                break;
+            }
+
+            // Equal keys map to the same bytes, and never peel. They're
+            // rare, so they're only removed if peeling fails.
+            if (!distinct) {
+                std::sort(keys.begin(), keys.end());
+                keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+                distinct = true;
+                if (keys.size() != _size) {
+                    resize(keys.size());
+                    nodes.resize(_fingerprints.size());
+                }
+            }
+        }
+
+        // In reverse, each peeled byte is the last of its hash's 3 bytes to
+        // be assigned
+        for (auto it = peeled.rbegin(); it != peeled.rend(); ++it) {
+            const auto h = nodes[*it].hashes;
+            _fingerprints[*it] = static_cast<std::uint8_t>(
+                fingerprint(h) ^ _fingerprints[slot(h, 0)] ^
+                _fingerprints[slot(h, 1)] ^ _fingerprints[slot(h, 2)]);
+        }
+    }
+
+    void guid_xor_filter::save(std::ostream& out) const
+    {
+        write_header(out, xor_magic, _size, _seed);
+        if (!_fingerprints.empty()) {
+            out.write(reinterpret_cast<const char*>(_fingerprints.data()),
+                      static_cast<std::streamsize>(_fingerprints.size()));
+        }
+    }
+
+    guid_xor_filter guid_xor_filter::load(std::istream& in)
+    {
+        unsigned char header[header_size];
+        if (!in.read(reinterpret_cast<char*>(header), header_size)) {
+            detail::throw_invalid(
+                "xg::guid_xor_filter::load: truncated header");
+        }
+        const auto words = parse_xor_header(header);
+        guid_xor_filter filter;
+        filter._size = words.first;
+        filter._block_length = xor_block_length(words.first);
+        filter._seed = words.second;
+        if (!detail::read_chunked(in, filter._fingerprints, 0,
+                                  3 * filter._block_length)) {
+            detail::throw_invalid("xg::guid_xor_filter::load: truncated data");
+        }
+        return filter;
+    }
+
+    guid_xor_filter guid_xor_filter::load(const void* data, std::size_t size)
+    {
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        if (size < header_size) {
+            detail::throw_invalid(
+                "xg::guid_xor_filter::load: truncated header");
+        }
+        const auto words = parse_xor_header(bytes);
+        if (size - header_size != 3 * xor_block_length(words.first)) {
+            detail::throw_invalid(
+                "xg::guid_xor_filter::load: size doesn't match header");
+        }
+        guid_xor_filter filter;
+        filter.resize(words.first);
+        filter._seed = words.second;
+        std::copy(bytes + header_size, bytes + size,
+                  filter._fingerprints.begin());
+        return filter;
+    }
+}  // namespace xg
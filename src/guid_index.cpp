@@ -0,0 +1,193 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#include "crossguid/guid_index.hpp"
+
+#include "crossguid/sort.hpp"
+
+#include "serialization.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <system_error>
+#include <utility>
+
+namespace xg {
+    namespace {
+        // "xgindex" and a NUL, then the format version, a reserved word, the
+        // number of GUIDs and a reserved word, little-endian
+        const char magic[8] = {'x', 'g', 'i', 'n', 'd', 'e', 'x', '\0'};
+        const std::uint32_t format_version = 1;
+        const std::size_t header_size = 32;
+
+        // The number of GUIDs of a serialized index, from its header
+        std::size_t parse_header(const unsigned char* header)
+        {
+            if (std::memcmp(header, magic, sizeof magic) != 0) {
+                detail::throw_invalid("xg::guid_index::load: not a GUID index");
+            }
+            if (detail::load_le(header + 8, 4) != format_version) {
+                detail::throw_invalid(
+                    "xg::guid_index::load: unsupported version");
+            }
+            const std::uint64_t count = detail::load_le(header + 16, 8);
+            if (count > std::numeric_limits<std::size_t>::max() /
+                            sizeof(guid) -
+                        1) {
+                detail::throw_invalid("xg::guid_index::load: invalid size");
+            }
+            return static_cast<std::size_t>(count);
+        }
+    }  // namespace
+
+    guid_index::guid_index(std::vector<guid> guids)
+    {
+        xg::sort(guids.data(), guids.data() + guids.size());
+        guids.erase(std::unique(guids.begin(), guids.end()), guids.end());
+
+        allocate(guids.size());
+        // An in-order traversal of the tree visits the nodes in sorted order
+        guid* nodes = _storage.data() + (_nodes - _storage.data());
+        auto it = guids.begin();
+        for (auto node = begin(); node != end(); ++node) {
+            nodes[node._node] = *it++;
+        }
+    }
+
+    guid_index::guid_index(const guid_index& other)
+    {
+        allocate(other._size);
+        std::copy(other._nodes + 1, other._nodes + 1 + _size,
+                  _storage.begin() + (_nodes - _storage.data()) + 1);
+    }
+
+    guid_index& guid_index::operator=(const guid_index& other)
+    {
+        if (this != &other) {
+            guid_index tmp(other);
+            *this = std::move(tmp);
+        }
+        return *this;
+    }
+
+    guid_index::guid_index(guid_index&& other) noexcept
+        : _storage(std::move(other._storage)),
+          _nodes(other._nodes),
+          _size(other._size)
+    {
+        other._storage.clear();
+        other._nodes = nullptr;
+        other._size = 0;
+    }
+
+    guid_index& guid_index::operator=(guid_index&& other) noexcept
+    {
+        _storage = std::move(other._storage);
+        _nodes = other._nodes;
+        _size = other._size;
+        other._storage.clear();
+        other._nodes = nullptr;
+        other._size = 0;
+        return *this;
+    }
+
+    void guid_index::allocate(std::size_t n)
+    {
+        _size = n;
+        if (n == 0) {
+            _storage.clear();
+            _nodes = nullptr;
+            return;
+        }
+        // Node 0 is unused, and up to 3 more GUIDs skipped to align node 0,
+        // and with it every group of 4 siblings, to a cache line
+        _storage.assign(n + 4, guid{});
+        _nodes =
+            _storage.data() + detail::cache_line_offset(_storage.data(), 3);
+    }
+
+    void guid_index::save(std::ostream& out) const
+    {
+        unsigned char header[header_size] = {};
+        std::memcpy(header, magic, sizeof magic);
+        detail::store_le(header + 8, format_version, 4);
+        detail::store_le(header + 16, _size, 8);
+        out.write(reinterpret_cast<const char*>(header), header_size);
+        if (_size != 0) {
+            out.write(reinterpret_cast<const char*>(_nodes + 1),
+                      static_cast<std::streamsize>(_size * sizeof(guid)));
+        }
+    }
+
+    guid_index guid_index::load(std::istream& in)
+    {
+        unsigned char header[header_size];
+        if (!in.read(reinterpret_cast<char*>(header), header_size)) {
+            detail::throw_invalid("xg::guid_index::load: truncated header");
+        }
+        const std::size_t n = parse_header(header);
+        // After room for node 0 and the padding, as allocate() lays them
+        // out, then moved down to the aligned position
+        std::vector<guid> storage;
+        if (!detail::read_chunked(in, storage, 4, n)) {
+            detail::throw_invalid("xg::guid_index::load: truncated data");
+        }
+        guid_index index;
+        if (n != 0) {
+            const auto offset = detail::cache_line_offset(storage.data(), 3);
+            std::copy(storage.data() + 4, storage.data() + 4 + n,
+                      storage.data() + offset + 1);
+            index._size = n;
+            index._nodes = storage.data() + offset;
+            index._storage = std::move(storage);
+        }
+        return index;
+    }
+
+    guid_index guid_index::load(const void* data, std::size_t size)
+    {
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        if (size < header_size) {
+            detail::throw_invalid("xg::guid_index::load: truncated header");
+        }
+        const std::size_t n = parse_header(bytes);
+        if ((size - header_size) / sizeof(guid) != n ||
+            (size - header_size) % sizeof(guid) != 0) {
+            detail::throw_invalid(
+                "xg::guid_index::load: size doesn't match header");
+        }
+        guid_index index;
+        index.allocate(n);
+        if (n != 0) {
+            auto* nodes = index._storage.data() +
+                          (index._nodes - index._storage.data()) + 1;
+            std::memcpy(static_cast<void*>(nodes), bytes + header_size,
+                        n * sizeof(guid));
+        }
+        return index;
+    }
+}  // namespace xg
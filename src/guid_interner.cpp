@@ -0,0 +1,168 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#include "crossguid/guid_interner.hpp"
+
+#include "crossguid/epoch.hpp"
+
+#include "serialization.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <system_error>
+
+namespace xg {
+    namespace {
+        // The capacity of the array of an empty interner
+        const std::size_t min_capacity = 1024;
+
+        std::size_t snapshot_size(const guid_column& snapshot)
+        {
+            if (snapshot.size() > guid_interner::max_size) {
+                detail::throw_invalid(
+                    "xg::guid_interner: too many GUIDs in snapshot");
+            }
+            return snapshot.size();
+        }
+    }  // namespace
+
+    const std::size_t guid_interner::max_size;
+
+    guid_interner::guid_interner(std::size_t capacity)
+        : _handles(capacity),
+          _guids(new table(
+              std::min(std::max(capacity, min_capacity), max_size)))
+    {
+    }
+
+    guid_interner::guid_interner(const guid_column& snapshot)
+        : guid_interner(snapshot_size(snapshot))
+    {
+        auto* t = _guids.load(std::memory_order_relaxed);
+        for (std::size_t i = 0; i < snapshot.size(); ++i) {
+            if (!_handles.insert(snapshot[i],
+                                 static_cast<handle_type>(i))) {
+                detail::throw_invalid(
+                    "xg::guid_interner: duplicate GUID in snapshot");
+            }
+        }
+        std::copy(snapshot.begin(), snapshot.end(), t->guids.get());
+        _size.store(snapshot.size(), std::memory_order_release);
+    }
+
+    guid_interner::~guid_interner()
+    {
+        delete _guids.load(std::memory_order_relaxed);
+    }
+
+    guid_interner::handle_type guid_interner::intern(const guid& g)
+    {
+        handle_type h = 0;
+        if (_handles.find(g, h)) {
+            return h;
+        }
+        return _handles.find_or_insert(g, [this, &g] { return assign(g); });
+    }
+
+    void guid_interner::intern(const guid* first, std::size_t n,
+                               handle_type* out)
+    {
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] = intern(first[i]);
+        }
+    }
+
+    guid_interner::handle_type guid_interner::assign(const guid& g)
+    {
+        // Already in a guard of _handles, but retiring requires one
+        detail::epoch_guard guard;
+        std::lock_guard<std::mutex> lock(_mutex);
+        const auto n = _size.load(std::memory_order_relaxed);
+        if (n == max_size) {
+            throw std::length_error(
+                "xg::guid_interner::intern: too many GUIDs");
+        }
+
+        auto* t = _guids.load(std::memory_order_relaxed);
+        if (n == t->capacity) {
+            // Readers keep using the old array until they see the new one,
+            // which holds the same GUIDs
+            auto* larger = new table(std::min(2 * t->capacity, max_size));
+            std::copy(t->guids.get(), t->guids.get() + n,
+                      larger->guids.get());
+            _guids.store(larger, std::memory_order_release);
+            detail::epoch_retire(t);
+            t = larger;
+        }
+        t->guids[n] = g;
+        _size.store(n + 1, std::memory_order_release);
+        return static_cast<handle_type>(n);
+    }
+
+    guid guid_interner::operator[](handle_type h) const
+    {
+        detail::epoch_guard guard;
+        return _guids.load(std::memory_order_acquire)->guids[h];
+    }
+
+    guid guid_interner::at(handle_type h) const
+    {
+        if (h >= size()) {
+            throw std::out_of_range("xg::guid_interner::at: invalid handle");
+        }
+        return (*this)[h];
+    }
+
+    void guid_interner::resolve(const handle_type* first, std::size_t n,
+                                guid* out) const
+    {
+        detail::epoch_guard guard;
+        const guid* guids = _guids.load(std::memory_order_acquire)->guids.get();
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] = guids[first[i]];
+        }
+    }
+
+    void guid_interner::save(const char* path) const
+    {
+        guid_column_writer writer(path);
+        save(writer);
+        writer.close();
+    }
+
+    void guid_interner::save(guid_column_writer& writer) const
+    {
+        // The array of the first `n` GUIDs stays alive in the guard, while
+        // GUIDs are interned concurrently
+        detail::epoch_guard guard;
+        const auto n = size();
+        const auto* t = _guids.load(std::memory_order_acquire);
+        if (writer.size() > n) {
+            detail::throw_invalid("xg::guid_interner::save: the file has more "
+                                  "GUIDs than the interner");
+        }
+        writer.append(t->guids.get() + writer.size(), t->guids.get() + n);
+        writer.flush();
+    }
+}  // namespace xg
@@ -0,0 +1,259 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#include "crossguid/guid_pool.hpp"
+
+#include <algorithm>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+namespace xg {
+    namespace {
+        // Incremented in the child after fork(), so that pools created
+        // before can tell that their GUIDs and refill thread are the
+        // parent's
+        std::atomic<unsigned> fork_generation{0};
+
+#ifndef _WIN32
+        void on_fork_child()
+        {
+            fork_generation.fetch_add(1, std::memory_order_relaxed);
+        }
+#endif
+
+        unsigned current_fork_generation()
+        {
+#ifndef _WIN32
+            static const int registered =
+                pthread_atfork(nullptr, nullptr, on_fork_child);
+            static_cast<void>(registered);
+#endif
+            return fork_generation.load(std::memory_order_relaxed);
+        }
+
+        // GUIDs created by make_guids at once by the refill thread
+        const std::size_t refill_batch = 64;
+
+        std::size_t round_up_to_power_of_2(std::size_t n) noexcept
+        {
+            std::size_t p = 2;
+            while (p < n) {
+                p *= 2;
+            }
+            return p;
+        }
+    }  // namespace
+
+    guid_pool::guid_pool(const guid_pool_options& options)
+        : _cells(new cell[round_up_to_power_of_2(options.capacity)]),
+          _mask(round_up_to_power_of_2(options.capacity) - 1),
+          _low_watermark(0),
+          _high_watermark(std::min(options.high_watermark, _mask + 1)),
+          _refill(new refill_sync),
+          _fork_generation(current_fork_generation())
+    {
+        _low_watermark = std::min(options.low_watermark, _high_watermark);
+        for (std::size_t i = 0; i <= _mask; ++i) {
+            _cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        _refill->thread = std::thread([this]() noexcept { refill_loop(); });
+    }
+
+    guid_pool::~guid_pool() noexcept
+    {
+        if (forked()) {
+            // The refill thread can't be joined, and its mutex and
+            // condition variable can't be destroyed safely: leak them
+            static_cast<void>(_refill.release());
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(_refill->mutex);
+            _refill->stop = true;
+        }
+        _refill->wake.notify_one();
+        _refill->thread.join();
+    }
+
+    guid guid_pool::get()
+    {
+        guid g;
+        if (try_get(g)) {
+            return g;
+        }
+        _misses.fetch_add(1, std::memory_order_relaxed);
+        if (!forked()) {
+            request_refill();
+        }
+        return make_guid();
+    }
+
+    bool guid_pool::try_get(guid& out) noexcept
+    {
+        if (forked()) {
+            return false;
+        }
+
+        // A cell is ready to be taken at position pos when its sequence is
+        // pos + 1, and ready to be stored into again when it's pos +
+        // capacity
+        std::size_t pos = _dequeue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell& c = _cells[pos & _mask];
+            const std::size_t sequence =
+                c.sequence.load(std::memory_order_acquire);
+            if (sequence == pos + 1) {
+                if (_dequeue_pos.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed)) {
+                    out = c.value;
+                    c.sequence.store(pos + _mask + 1,
+                                     std::memory_order_release);
+                    break;
+                }
+            }
+            else if (sequence == pos) {
+                // Not stored yet: empty
+                return false;
+            }
+            else {
+                // Taken by another thread
+                pos = _dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        if (size() < _low_watermark) {
+            request_refill();
+        }
+        return true;
+    }
+
+    std::size_t guid_pool::size() const noexcept
+    {
+        const auto taken = _dequeue_pos.load(std::memory_order_relaxed);
+        const auto stored = _enqueue_pos.load(std::memory_order_relaxed);
+        return stored > taken ? stored - taken : 0;
+    }
+
+    guid_pool_stats guid_pool::stats() const noexcept
+    {
+        guid_pool_stats s;
+        s.hits = _dequeue_pos.load(std::memory_order_relaxed);
+        s.misses = _misses.load(std::memory_order_relaxed);
+        s.refills = _refills.load(std::memory_order_relaxed);
+        s.refilled = _refilled.load(std::memory_order_relaxed);
+        s.refill_time = std::chrono::nanoseconds{
+            _refill_nanoseconds.load(std::memory_order_relaxed)};
+        return s;
+    }
+
+    bool guid_pool::forked() const noexcept
+    {
+        return fork_generation.load(std::memory_order_relaxed) !=
+               _fork_generation;
+    }
+
+    bool guid_pool::push(const guid& g) noexcept
+    {
+        // The refill thread is the only producer, so the position doesn't
+        // need a compare-and-swap
+        const std::size_t pos = _enqueue_pos.load(std::memory_order_relaxed);
+        cell& c = _cells[pos & _mask];
+        if (c.sequence.load(std::memory_order_acquire) != pos) {
+            // Full, or the GUID last stored there is still being read
+            return false;
+        }
+        c.value = g;
+        c.sequence.store(pos + 1, std::memory_order_release);
+        _enqueue_pos.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void guid_pool::request_refill() noexcept
+    {
+        if (_refill_requested.load(std::memory_order_relaxed) ||
+            _refill_requested.exchange(true)) {
+            return;
+        }
+        // Taking the lock orders the request before the refill thread's
+        // check of it, or after it waits
+        {
+            std::lock_guard<std::mutex> lock(_refill->mutex);
+        }
+        _refill->wake.notify_one();
+    }
+
+    void guid_pool::refill_loop() noexcept
+    {
+        auto& sync = *_refill;
+        std::unique_lock<std::mutex> lock(sync.mutex);
+        for (;;) {
+            sync.wake.wait(lock, [this, &sync] {
+                return sync.stop || _refill_requested.load();
+            });
+            if (sync.stop) {
+                return;
+            }
+            lock.unlock();
+
+            const auto start = std::chrono::steady_clock::now();
+            guid batch[refill_batch];
+            std::uint64_t created = 0;
+            bool failed = false;
+            bool full = false;
+            while (!full && size() < _high_watermark) {
+                const auto n =
+                    std::min(refill_batch, _high_watermark - size());
+                try {
+                    make_guids(batch, n);
+                }
+                catch (...) {
+                    // Leave it to the synchronous fallback to report
+                    failed = true;
+                    break;
+                }
+                created += n;
+                for (std::size_t i = 0; i < n && !full; ++i) {
+                    full = !push(batch[i]);
+                }
+            }
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+
+            _refills.fetch_add(1, std::memory_order_relaxed);
+            _refilled.fetch_add(created, std::memory_order_relaxed);
+            _refill_nanoseconds.fetch_add(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                    .count(),
+                std::memory_order_relaxed);
+
+            // Requests made while refilling were skipped, so check again
+            _refill_requested.store(false);
+            if (!failed && size() < _low_watermark) {
+                _refill_requested.store(true);
+            }
+            lock.lock();
+        }
+    }
+}  // namespace xg
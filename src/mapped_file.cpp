@@ -0,0 +1,141 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#include "crossguid/mapped_file.hpp"
+
+#include <system_error>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace xg {
+#ifdef _WIN32
+    mapped_file::mapped_file(const char* path)
+    {
+        const HANDLE file =
+            CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                        OPEN_EXISTING,
+                        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                        nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw std::system_error(static_cast<int>(GetLastError()),
+                                    std::system_category(),
+                                    "xg::mapped_file: CreateFile");
+        }
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size)) {
+            const auto err = GetLastError();
+            CloseHandle(file);
+            throw std::system_error(static_cast<int>(err),
+                                    std::system_category(),
+                                    "xg::mapped_file: GetFileSizeEx");
+        }
+        if (size.QuadPart == 0) {
+            CloseHandle(file);
+            return;
+        }
+
+        // The view keeps the file mapped after both handles are closed
+        const HANDLE mapping =
+            CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        const void* view = mapping != nullptr
+                               ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)
+                               : nullptr;
+        const auto err = GetLastError();
+        if (mapping != nullptr) {
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+        if (view == nullptr) {
+            throw std::system_error(static_cast<int>(err),
+                                    std::system_category(),
+                                    "xg::mapped_file: MapViewOfFile");
+        }
+        _data = static_cast<const char*>(view);
+        _size = static_cast<std::size_t>(size.QuadPart);
+    }
+
+    void mapped_file::unmap() noexcept
+    {
+        if (_data != nullptr) {
+            UnmapViewOfFile(_data);
+        }
+    }
+#else
+    mapped_file::mapped_file(const char* path)
+    {
+        const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(),
+                                    "xg::mapped_file: open");
+        }
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            const int err = errno;
+            ::close(fd);
+            throw std::system_error(err, std::generic_category(),
+                                    "xg::mapped_file: fstat");
+        }
+        if (st.st_size == 0) {
+            ::close(fd);
+            return;
+        }
+
+        const auto size = static_cast<std::size_t>(st.st_size);
+        void* p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        const int err = errno;
+        // The mapping stays valid after the descriptor is closed
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            throw std::system_error(err, std::generic_category(),
+                                    "xg::mapped_file: mmap");
+        }
+        ::madvise(p, size, MADV_SEQUENTIAL);
+        _data = static_cast<const char*>(p);
+        _size = size;
+    }
+
+    void mapped_file::unmap() noexcept
+    {
+        if (_data != nullptr) {
+            ::munmap(const_cast<char*>(_data), _size);
+        }
+    }
+#endif
+}  // namespace xg
@@ -0,0 +1,431 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#include "crossguid/guid.hpp"
+
+#include "simd.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace xg {
+    namespace detail {
+        namespace {
+            inline std::uint32_t rotl(std::uint32_t v, unsigned n) noexcept
+            {
+                return (v << n) | (v >> (32 - n));
+            }
+
+            inline std::uint32_t load_be32(const unsigned char* p) noexcept
+            {
+                return static_cast<std::uint32_t>(p[0]) << 24 |
+                       static_cast<std::uint32_t>(p[1]) << 16 |
+                       static_cast<std::uint32_t>(p[2]) << 8 |
+                       static_cast<std::uint32_t>(p[3]);
+            }
+
+            inline std::uint32_t load_le32(const unsigned char* p) noexcept
+            {
+                return static_cast<std::uint32_t>(p[0]) |
+                       static_cast<std::uint32_t>(p[1]) << 8 |
+                       static_cast<std::uint32_t>(p[2]) << 16 |
+                       static_cast<std::uint32_t>(p[3]) << 24;
+            }
+
+            // The message hashed for a name-based GUID is the namespace
+            // followed by the name. Instead of concatenating them, every
+            // 64-byte block, including the padding, is assembled on demand.
+            struct message {
+                const unsigned char* ns;
+                const char* name;
+                std::size_t size;  // namespace and name
+
+                message(const guid& n, const char* s, std::size_t len) noexcept
+                    : ns(n.data()), name(s), size(16 + len)
+                {
+                }
+
+                std::size_t blocks() const noexcept
+                {
+                    // At least 9 bytes of padding: 0x80 and the bit length
+                    return (size + 9 + 63) / 64;
+                }
+
+                void block(std::size_t index,
+                           bool big_endian_length,
+                           unsigned char* out) const noexcept
+                {
+                    const std::size_t begin = index * 64, end = begin + 64;
+                    std::memset(out, 0, 64);
+
+                    if (begin < 16) {
+                        std::memcpy(out, ns + begin, 16 - begin);
+                    }
+                    const auto name_begin = std::max(begin, std::size_t{16});
+                    const auto name_end = std::min(end, size);
+                    if (name_begin < name_end) {
+                        std::memcpy(out + (name_begin - begin),
+                                    name + (name_begin - 16),
+                                    name_end - name_begin);
+                    }
+                    if (size >= begin && size < end) {
+                        out[size - begin] = 0x80;
+                    }
+                    if (index + 1 == blocks()) {
+                        const auto bits = static_cast<std::uint64_t>(size) * 8;
+                        for (std::size_t i = 0; i < 8; ++i) {
+                            const auto shift =
+                                big_endian_length ? 56 - 8 * i : 8 * i;
+                            out[56 + i] = static_cast<unsigned char>(
+                                bits >> shift);
+                        }
+                    }
+                }
+            };
+
+            const std::uint32_t sha1_init[5] = {0x67452301, 0xefcdab89,
+                                                0x98badcfe, 0x10325476,
+                                                0xc3d2e1f0};
+
+            void sha1_compress(std::uint32_t (&h)[5],
+                               const unsigned char* block) noexcept
+            {
+                std::uint32_t w[80];
+                for (std::size_t t = 0; t < 16; ++t) {
+                    w[t] = load_be32(block + 4 * t);
+                }
+                for (std::size_t t = 16; t < 80; ++t) {
+                    w[t] = rotl(w[t - 3] ^ w[t - 8] ^ w[t - 14] ^ w[t - 16], 1);
+                }
+
+                std::uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+                auto step = [&](std::size_t t, std::uint32_t f,
+                                std::uint32_t k) {
+                    const auto temp = rotl(a, 5) + f + e + k + w[t];
+                    e = d;
+                    d = c;
+                    c = rotl(b, 30);
+                    b = a;
+                    a = temp;
+                };
+                for (std::size_t t = 0; t < 20; ++t) {
+                    step(t, (b & c) | (~b & d), 0x5a827999);
+                }
+                for (std::size_t t = 20; t < 40; ++t) {
+                    step(t, b ^ c ^ d, 0x6ed9eba1);
+                }
+                for (std::size_t t = 40; t < 60; ++t) {
+                    step(t, (b & c) | (b & d) | (c & d), 0x8f1bbcdc);
+                }
+                for (std::size_t t = 60; t < 80; ++t) {
+                    step(t, b ^ c ^ d, 0xca62c1d6);
+                }
+                h[0] += a;
+                h[1] += b;
+                h[2] += c;
+                h[3] += d;
+                h[4] += e;
+            }
+
+            void md5_compress(std::uint32_t (&h)[4],
+                              const unsigned char* block) noexcept
+            {
+                static const std::uint32_t k[64] = {
+                    0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf,
+                    0x4787c62a, 0xa8304613, 0xfd469501, 0x698098d8, 0x8b44f7af,
+                    0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e,
+                    0x49b40821, 0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa,
+                    0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8, 0x21e1cde6,
+                    0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8,
+                    0x676f02d9, 0x8d2a4c8a, 0xfffa3942, 0x8771f681, 0x6d9d6122,
+                    0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+                    0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039,
+                    0xe6db99e5, 0x1fa27cf8, 0xc4ac5665, 0xf4292244, 0x432aff97,
+                    0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d,
+                    0x85845dd1, 0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1,
+                    0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391};
+                static const unsigned shifts[16] = {
+                    7, 12, 17, 22, 5, 9, 14, 20, 4, 11, 16, 23, 6, 10, 15, 21};
+
+                std::uint32_t m[16];
+                for (std::size_t i = 0; i < 16; ++i) {
+                    m[i] = load_le32(block + 4 * i);
+                }
+
+                std::uint32_t a = h[0], b = h[1], c = h[2], d = h[3];
+                for (std::size_t i = 0; i < 64; ++i) {
+                    std::uint32_t f;
+                    std::size_t g;
+                    if (i < 16) {
+                        f = (b & c) | (~b & d);
+                        g = i;
+                    }
+                    else if (i < 32) {
+                        f = (d & b) | (~d & c);
+                        g = (5 * i + 1) % 16;
+                    }
+                    else if (i < 48) {
+                        f = b ^ c ^ d;
+                        g = (3 * i + 5) % 16;
+                    }
+                    else {
+                        f = c ^ (b | ~d);
+                        g = (7 * i) % 16;
+                    }
+                    const auto temp = d;
+                    d = c;
+                    c = b;
+                    b += rotl(a + f + k[i] + m[g],
+                              shifts[(i / 16) * 4 + i % 4]);
+                    a = temp;
+                }
+                h[0] += a;
+                h[1] += b;
+                h[2] += c;
+                h[3] += d;
+            }
+
+            guid make_name_based(const unsigned char* digest, unsigned version)
+            {
+                std::array<unsigned char, 16> bytes;
+                std::copy(digest, digest + 16, bytes.begin());
+                bytes[6] = static_cast<unsigned char>((bytes[6] & 0x0f) |
+                                                      version << 4);
+                bytes[8] = static_cast<unsigned char>((bytes[8] & 0x3f) | 0x80);
+                return guid{bytes};
+            }
+
+            guid sha1_guid(const message& msg)
+            {
+                std::uint32_t h[5];
+                std::copy(sha1_init, sha1_init + 5, h);
+                unsigned char block[64];
+                for (std::size_t i = 0; i < msg.blocks(); ++i) {
+                    msg.block(i, true, block);
+                    sha1_compress(h, block);
+                }
+
+                unsigned char digest[16];
+                for (std::size_t i = 0; i < 4; ++i) {
+                    for (std::size_t j = 0; j < 4; ++j) {
+                        digest[4 * i + j] =
+                            static_cast<unsigned char>(h[i] >> (24 - 8 * j));
+                    }
+                }
+                return make_name_based(digest, 5);
+            }
+
+#if XG_HAS_X86_SIMD
+            // Multi-buffer SHA-1: eight messages are hashed side by side, one
+            // per 32-bit lane. Lanes whose message has fewer blocks than the
+            // longest one keep their state unchanged for the extra rounds.
+            constexpr std::size_t lanes = 8;
+
+            template <int N>
+            XG_TARGET_AVX2 inline __m256i rotl256(__m256i v) noexcept
+            {
+                return _mm256_or_si256(_mm256_slli_epi32(v, N),
+                                       _mm256_srli_epi32(v, 32 - N));
+            }
+
+            XG_TARGET_AVX2 void sha1_guids_avx2(const message* msgs,
+                                                std::size_t count,
+                                                guid* out) noexcept
+            {
+                std::size_t blocks[lanes] = {};
+                std::size_t max_blocks = 0;
+                for (std::size_t l = 0; l < count; ++l) {
+                    blocks[l] = msgs[l].blocks();
+                    max_blocks = std::max(max_blocks, blocks[l]);
+                }
+
+                __m256i h[5];
+                for (std::size_t i = 0; i < 5; ++i) {
+                    h[i] = _mm256_set1_epi32(static_cast<int>(sha1_init[i]));
+                }
+
+                alignas(32) std::uint32_t words[16][lanes];
+                unsigned char block[64];
+                for (std::size_t b = 0; b < max_blocks; ++b) {
+                    alignas(32) std::int32_t active[lanes] = {};
+                    for (std::size_t l = 0; l < count; ++l) {
+                        if (b < blocks[l]) {
+                            msgs[l].block(b, true, block);
+                            active[l] = -1;
+                        }
+                        else {
+                            std::memset(block, 0, 64);
+                        }
+                        for (std::size_t t = 0; t < 16; ++t) {
+                            words[t][l] = load_be32(block + 4 * t);
+                        }
+                    }
+                    for (std::size_t l = count; l < lanes; ++l) {
+                        for (std::size_t t = 0; t < 16; ++t) {
+                            words[t][l] = 0;
+                        }
+                    }
+
+                    __m256i w[16];
+                    for (std::size_t t = 0; t < 16; ++t) {
+                        w[t] = _mm256_load_si256(
+                            static_cast<const __m256i*>(
+                                static_cast<const void*>(words[t])));
+                    }
+
+                    __m256i a = h[0], bb = h[1], c = h[2], d = h[3], e = h[4];
+                    for (std::size_t t = 0; t < 80; ++t) {
+                        __m256i wt;
+                        if (t < 16) {
+                            wt = w[t];
+                        }
+                        else {
+                            wt = rotl256<1>(_mm256_xor_si256(
+                                _mm256_xor_si256(w[(t - 3) % 16],
+                                                 w[(t - 8) % 16]),
+                                _mm256_xor_si256(w[(t - 14) % 16], w[t % 16])));
+                            w[t % 16] = wt;
+                        }
+
+                        __m256i f, k;
+                        if (t < 20) {
+                            f = _mm256_or_si256(_mm256_and_si256(bb, c),
+                                                _mm256_andnot_si256(bb, d));
+                            k = _mm256_set1_epi32(0x5a827999);
+                        }
+                        else if (t < 40) {
+                            f = _mm256_xor_si256(_mm256_xor_si256(bb, c), d);
+                            k = _mm256_set1_epi32(0x6ed9eba1);
+                        }
+                        else if (t < 60) {
+                            f = _mm256_or_si256(
+                                _mm256_and_si256(bb, c),
+                                _mm256_and_si256(_mm256_or_si256(bb, c), d));
+                            k = _mm256_set1_epi32(
+                                static_cast<int>(0x8f1bbcdcu));
+                        }
+                        else {
+                            f = _mm256_xor_si256(_mm256_xor_si256(bb, c), d);
+                            k = _mm256_set1_epi32(
+                                static_cast<int>(0xca62c1d6u));
+                        }
+
+                        const __m256i temp = _mm256_add_epi32(
+                            _mm256_add_epi32(rotl256<5>(a), f),
+                            _mm256_add_epi32(_mm256_add_epi32(e, k), wt));
+                        e = d;
+                        d = c;
+                        c = rotl256<30>(bb);
+                        bb = a;
+                        a = temp;
+                    }
+
+                    const __m256i mask = _mm256_load_si256(
+                        static_cast<const __m256i*>(
+                            static_cast<const void*>(active)));
+                    const __m256i next[5] = {a, bb, c, d, e};
+                    for (std::size_t i = 0; i < 5; ++i) {
+                        h[i] = _mm256_blendv_epi8(
+                            h[i], _mm256_add_epi32(h[i], next[i]), mask);
+                    }
+                }
+
+                alignas(32) std::uint32_t digest_words[4][lanes];
+                for (std::size_t i = 0; i < 4; ++i) {
+                    _mm256_store_si256(static_cast<__m256i*>(static_cast<void*>(
+                                           digest_words[i])),
+                                       h[i]);
+                }
+                for (std::size_t l = 0; l < count; ++l) {
+                    unsigned char digest[16];
+                    for (std::size_t i = 0; i < 4; ++i) {
+                        for (std::size_t j = 0; j < 4; ++j) {
+                            digest[4 * i + j] = static_cast<unsigned char>(
+                                digest_words[i][l] >> (24 - 8 * j));
+                        }
+                    }
+                    out[l] = make_name_based(digest, 5);
+                }
+            }
+#endif  // XG_HAS_X86_SIMD
+        }  // namespace
+    }  // namespace detail
+
+    guid make_guid_v5(const guid& ns, const char* name, std::size_t len)
+    {
+        return detail::sha1_guid(detail::message{ns, name, len});
+    }
+
+    guid make_guid_v3(const guid& ns, const char* name, std::size_t len)
+    {
+        const detail::message msg{ns, name, len};
+        std::uint32_t h[4] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476};
+        unsigned char block[64];
+        for (std::size_t i = 0; i < msg.blocks(); ++i) {
+            msg.block(i, false, block);
+            detail::md5_compress(h, block);
+        }
+
+        unsigned char digest[16];
+        for (std::size_t i = 0; i < 4; ++i) {
+            for (std::size_t j = 0; j < 4; ++j) {
+                digest[4 * i + j] = static_cast<unsigned char>(h[i] >> (8 * j));
+            }
+        }
+        return detail::make_name_based(digest, 3);
+    }
+
+    guid* make_guids_v5(const guid& ns,
+                        const char* const* names,
+                        const std::size_t* lengths,
+                        std::size_t n,
+                        guid* out)
+    {
+#if XG_HAS_X86_SIMD
+        if (detail::cpu().avx2) {
+            while (n > 0) {
+                const auto count = std::min(n, detail::lanes);
+                detail::message msgs[detail::lanes] = {
+                    {ns, nullptr, 0}, {ns, nullptr, 0}, {ns, nullptr, 0},
+                    {ns, nullptr, 0}, {ns, nullptr, 0}, {ns, nullptr, 0},
+                    {ns, nullptr, 0}, {ns, nullptr, 0}};
+                for (std::size_t i = 0; i < count; ++i) {
+                    msgs[i] = detail::message{ns, names[i], lengths[i]};
+                }
+                detail::sha1_guids_avx2(msgs, count, out);
+                names += count;
+                lengths += count;
+                out += count;
+                n -= count;
+            }
+            return out;
+        }
+#endif
+        for (std::size_t i = 0; i < n; ++i) {
+            *out++ = make_guid_v5(ns, names[i], lengths[i]);
+        }
+        return out;
+    }
+}  // namespace xg
@@ -0,0 +1,88 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+// Private header: a minimal thread pool for the multi-threaded drivers.
+// Not installed.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace xg {
+    namespace detail {
+        /// The number of threads to use for `tasks` tasks, when `requested`
+        /// were asked for. `0` requests one per hardware thread.
+        inline unsigned thread_count(unsigned requested,
+                                     std::size_t tasks) noexcept
+        {
+            const unsigned threads =
+                requested != 0
+                    ? requested
+                    : std::max(1u, std::thread::hardware_concurrency());
+            return static_cast<unsigned>(std::min<std::size_t>(
+                threads, std::max<std::size_t>(tasks, 1)));
+        }
+
+        /// Calls `task(i)` for every `i` in `[0, tasks)`, on `threads`
+        /// threads including the calling one. Tasks are handed out in order.
+        /// If a thread can't be started, the tasks are run on the threads
+        /// started so far and the calling one instead, so this never throws
+        /// by itself.
+        /// \requires `task` doesn't throw: that would terminate the program,
+        /// as it does on the other threads.
+        template <typename Task>
+        void parallel_for(std::size_t tasks, unsigned threads, Task task)
+        {
+            std::atomic<std::size_t> next{0};
+            auto work = [&]() noexcept {
+                for (;;) {
+                    const auto i = next.fetch_add(1, std::memory_order_relaxed);
+                    if (i >= tasks) {
+                        return;
+                    }
+                    task(i);
+                }
+            };
+
+            std::vector<std::thread> pool;
+            try {
+                pool.reserve(threads - 1);
+                for (unsigned t = 1; t < threads; ++t) {
+                    pool.emplace_back(work);
+                }
+            }
+            catch (...) {
+                // Out of threads or memory: make do with what's running.
+            }
+            work();
+            for (auto& t : pool) {
+                t.join();
+            }
+        }
+    }  // namespace detail
+}  // namespace xg
@@ -0,0 +1,469 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#include "crossguid/guid.hpp"
+
+#include "parse.hpp"
+#include "simd.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace xg {
+    namespace detail {
+        namespace {
+            const unsigned char hex_values[256] = {
+            0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+            0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+            0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+            0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+            0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+            0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+            0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+            0x08, 0x09, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+            0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0xff,
+            0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+            0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+            0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+            0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0xff,
+            0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+            0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+            0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+            0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+            0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+            0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+            0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+            0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+            0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+            0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+            0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+            0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+            0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+            0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+            0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+            0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+            0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+            0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+            0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+            };
+
+            // Offsets of the first digit of every byte in the canonical form
+            const unsigned char canonical_offsets[16] = {
+                0, 2, 4, 6, 9, 11, 14, 16, 19, 21, 24, 26, 28, 30, 32, 34};
+
+            bool parse_canonical_scalar(const char* s,
+                                        unsigned char* out) noexcept
+            {
+                if (s[8] != '-' || s[13] != '-' || s[18] != '-' ||
+                    s[23] != '-') {
+                    return false;
+                }
+
+                // Invalid digits have the high nibble set
+                unsigned char invalid = 0;
+                for (std::size_t i = 0; i < 16; ++i) {
+                    const auto p = s + canonical_offsets[i];
+                    const auto hi =
+                        hex_values[static_cast<unsigned char>(p[0])];
+                    const auto lo =
+                        hex_values[static_cast<unsigned char>(p[1])];
+                    invalid = static_cast<unsigned char>(invalid | hi | lo);
+                    out[i] = static_cast<unsigned char>((hi << 4) | lo);
+                }
+                return (invalid & 0xf0) == 0;
+            }
+
+#if XG_HAS_X86_SIMD
+            // Both vector kernels gather the 32 digits into two (SSE) or one
+            // (AVX2) registers with byte shuffles, dropping the hyphens.
+            // Every digit is then validated and converted to a nibble with
+            // compares, and adjacent nibbles are combined into bytes with a
+            // multiply-add: hi * 16 + lo.
+
+            XG_TARGET_SSE41 XG_NO_SANITIZE_ADDRESS inline __m128i load128(
+                const char* p) noexcept
+            {
+                return _mm_loadu_si128(
+                    static_cast<const __m128i*>(static_cast<const void*>(p)));
+            }
+
+            // Converts 16 hexadecimal digits to nibbles.
+            // `valid` gets a bit set for every valid digit.
+            XG_TARGET_SSE41 inline __m128i nibbles128(__m128i v,
+                                                      int& valid) noexcept
+            {
+                const __m128i digit = _mm_and_si128(
+                    _mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+                    _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+                const __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+                const __m128i alpha = _mm_and_si128(
+                    _mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                    _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+                valid = _mm_movemask_epi8(_mm_or_si128(digit, alpha));
+                return _mm_add_epi8(_mm_and_si128(v, _mm_set1_epi8(0x0f)),
+                                    _mm_and_si128(alpha, _mm_set1_epi8(9)));
+            }
+
+            XG_TARGET_SSE41 XG_NO_SANITIZE_ADDRESS bool parse_canonical_sse41(
+                const char* s,
+                unsigned char* out) noexcept
+            {
+                const __m128i a = load128(s);
+                const __m128i b = load128(s + 16);
+                const __m128i c = load128(s + 20);
+
+                // Hyphens at 8 and 13 in `a`, 18 and 23 in `b`
+                const __m128i dash = _mm_set1_epi8('-');
+                const int dash_a = _mm_movemask_epi8(_mm_cmpeq_epi8(a, dash));
+                const int dash_b = _mm_movemask_epi8(_mm_cmpeq_epi8(b, dash));
+
+                // Digits 0-15: s[0-7], s[9-12], s[14-17]
+                const __m128i lo = _mm_or_si128(
+                    _mm_shuffle_epi8(a, _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 9,
+                                                      10, 11, 12, 14, 15, -1,
+                                                      -1)),
+                    _mm_shuffle_epi8(b, _mm_setr_epi8(-1, -1, -1, -1, -1, -1,
+                                                      -1, -1, -1, -1, -1, -1,
+                                                      -1, -1, 0, 1)));
+                // Digits 16-31: s[19-22], s[24-35]
+                const __m128i hi = _mm_or_si128(
+                    _mm_shuffle_epi8(b, _mm_setr_epi8(3, -1, -1, -1, -1, -1,
+                                                      -1, -1, -1, -1, -1, -1,
+                                                      -1, -1, -1, -1)),
+                    _mm_shuffle_epi8(c, _mm_setr_epi8(-1, 0, 1, 2, 4, 5, 6, 7,
+                                                      8, 9, 10, 11, 12, 13, 14,
+                                                      15)));
+
+                int valid_lo = 0, valid_hi = 0;
+                const __m128i nib_lo = nibbles128(lo, valid_lo);
+                const __m128i nib_hi = nibbles128(hi, valid_hi);
+
+                const __m128i weights = _mm_set1_epi16(0x0110);
+                const __m128i bytes =
+                    _mm_packus_epi16(_mm_maddubs_epi16(nib_lo, weights),
+                                     _mm_maddubs_epi16(nib_hi, weights));
+                _mm_storeu_si128(
+                    static_cast<__m128i*>(static_cast<void*>(out)), bytes);
+
+                return (dash_a & 0x2100) == 0x2100 &&
+                       (dash_b & 0x84) == 0x84 && valid_lo == 0xffff &&
+                       valid_hi == 0xffff;
+            }
+
+            XG_TARGET_AVX2 XG_NO_SANITIZE_ADDRESS bool parse_canonical_avx2(
+                const char* s,
+                unsigned char* out) noexcept
+            {
+                const __m128i a = load128(s);
+                const __m128i b = load128(s + 16);
+                const __m128i c = load128(s + 20);
+
+                const int dash = _mm256_movemask_epi8(_mm256_cmpeq_epi8(
+                    _mm256_inserti128_si256(_mm256_castsi128_si256(a), b, 1),
+                    _mm256_set1_epi8('-')));
+
+                // Low lane: digits 0-15, high lane: digits 16-31,
+                // see parse_canonical_sse41
+                const __m256i ac =
+                    _mm256_inserti128_si256(_mm256_castsi128_si256(a), c, 1);
+                const __m256i bb = _mm256_broadcastsi128_si256(b);
+                const __m256i v = _mm256_or_si256(
+                    _mm256_shuffle_epi8(
+                        ac, _mm256_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 9, 10, 11,
+                                             12, 14, 15, -1, -1, -1, 0, 1, 2, 4,
+                                             5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+                                             15)),
+                    _mm256_shuffle_epi8(
+                        bb, _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                             -1, -1, -1, -1, -1, 0, 1, 3, -1,
+                                             -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                             -1, -1, -1, -1, -1)));
+
+                const __m256i digit = _mm256_and_si256(
+                    _mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)),
+                    _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v));
+                const __m256i lower =
+                    _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+                const __m256i alpha = _mm256_and_si256(
+                    _mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+                    _mm256_cmpgt_epi8(_mm256_set1_epi8('f' + 1), lower));
+                const int valid =
+                    _mm256_movemask_epi8(_mm256_or_si256(digit, alpha));
+                const __m256i nib = _mm256_add_epi8(
+                    _mm256_and_si256(v, _mm256_set1_epi8(0x0f)),
+                    _mm256_and_si256(alpha, _mm256_set1_epi8(9)));
+
+                const __m256i words =
+                    _mm256_maddubs_epi16(nib, _mm256_set1_epi16(0x0110));
+                // Packing works per lane, so gather qwords 0 and 2
+                const __m256i packed = _mm256_permute4x64_epi64(
+                    _mm256_packus_epi16(words, words), 0x08);
+                _mm_storeu_si128(
+                    static_cast<__m128i*>(static_cast<void*>(out)),
+                    _mm256_castsi256_si128(packed));
+
+                return (dash & 0x842100) == 0x842100 && valid == -1;
+            }
+#endif  // XG_HAS_X86_SIMD
+
+            using canonical_kernel = bool (*)(const char*, unsigned char*);
+
+            canonical_kernel select_canonical_kernel() noexcept
+            {
+#if XG_HAS_X86_SIMD
+                if (cpu().avx2) {
+                    return parse_canonical_avx2;
+                }
+                if (cpu().sse41) {
+                    return parse_canonical_sse41;
+                }
+#endif
+                return parse_canonical_scalar;
+            }
+
+#if XG_HAS_X86_SIMD
+            // Whether parse_canonical() uses a vector kernel, which may read
+            // past the terminator of a short string within its page. The
+            // scalar one may not.
+            bool vector_canonical() noexcept
+            {
+                static const bool vector =
+                    select_canonical_kernel() != parse_canonical_scalar;
+                return vector;
+            }
+#endif
+        }  // namespace
+
+        unsigned char hex_value(unsigned char ch) noexcept
+        {
+            return hex_values[ch];
+        }
+
+        bool parse_canonical(const char* s, unsigned char* out) noexcept
+        {
+            static const canonical_kernel kernel = select_canonical_kernel();
+            return kernel(s, out);
+        }
+
+        std::size_t parse_canonical_rows(const char* text,
+                                         std::size_t stride,
+                                         std::size_t n,
+                                         guid* out,
+                                         std::uint8_t* valid) noexcept
+        {
+            static const canonical_kernel kernel = select_canonical_kernel();
+            std::size_t count = 0;
+            unsigned bits = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                std::array<unsigned char, 16> bytes;
+                const bool ok = kernel(text + i * stride, bytes.data());
+                out[i] = ok ? guid{bytes} : guid{};
+                count += ok;
+                bits |= static_cast<unsigned>(ok) << (i % 8);
+                if (i % 8 == 7 || i + 1 == n) {
+                    if (valid != nullptr) {
+                        valid[i / 8] = static_cast<std::uint8_t>(bits);
+                    }
+                    bits = 0;
+                }
+            }
+            return count;
+        }
+
+        const char* parse_digits(const char* first,
+                                 const char* last,
+                                 unsigned char* out) noexcept
+        {
+            std::size_t digits = 0;
+            for (; first != last; ++first) {
+                const auto ch = static_cast<unsigned char>(*first);
+                if (ch == '-') {
+                    continue;
+                }
+
+                const auto value = hex_values[ch];
+                if (value > 15) {
+                    return nullptr;
+                }
+                if (digits % 2 == 0) {
+                    out[digits / 2] = static_cast<unsigned char>(value << 4);
+                }
+                else {
+                    out[digits / 2] =
+                        static_cast<unsigned char>(out[digits / 2] | value);
+                }
+                if (++digits == 32) {
+                    return first + 1;
+                }
+            }
+            return nullptr;
+        }
+
+        bool parse_lenient(const char* first,
+                           const char* last,
+                           unsigned char* out) noexcept
+        {
+            const auto end = parse_digits(first, last, out);
+            return end != nullptr && std::all_of(end, last, [](char ch) {
+                       return ch == '-';
+                   });
+        }
+
+        bool parse_c_string(const char* s, unsigned char* out) noexcept
+        {
+#if XG_HAS_X86_SIMD
+            // Canonical input is by far the most common, so try it before
+            // measuring the string. The loads can't fault when they stay on
+            // one page, and a successful parse proves that there's no null
+            // terminator within the first 36 characters.
+            if (vector_canonical() && within_page(s, 36)) {
+                if (parse_canonical(s, out) && s[36] == '\0') {
+                    return true;
+                }
+                return parse_lenient(s, s + std::strlen(s), out);
+            }
+#endif
+            const auto len = std::strlen(s);
+            if (len == 36 && parse_canonical(s, out)) {
+                return true;
+            }
+            return parse_lenient(s, s + len, out);
+        }
+
+        bool parse_guid(const char* first,
+                        const char* last,
+                        guid& out) noexcept
+        {
+            std::array<unsigned char, 16> bytes;
+            if ((last - first == 36 && parse_canonical(first, bytes.data())) ||
+                parse_lenient(first, last, bytes.data())) {
+                out = guid{bytes};
+                return true;
+            }
+            return false;
+        }
+    }  // namespace detail
+
+    namespace {
+        // Parses the canonical form at the beginning of [first, last)
+        const char* parse_strict(const char* first,
+                                 const char* last,
+                                 unsigned char* out) noexcept
+        {
+            if (last - first < 36 || !detail::parse_canonical(first, out)) {
+                return nullptr;
+            }
+            return first + 36;
+        }
+
+        // Consumes `prefix` at the beginning of [first, last), in any case
+        const char* skip_prefix(const char* first,
+                                const char* last,
+                                const char* prefix,
+                                std::size_t len) noexcept
+        {
+            if (static_cast<std::size_t>(last - first) < len) {
+                return nullptr;
+            }
+            for (std::size_t i = 0; i < len; ++i) {
+                const char ch = first[i] >= 'A' && first[i] <= 'Z'
+                                    ? static_cast<char>(first[i] - 'A' + 'a')
+                                    : first[i];
+                if (ch != prefix[i]) {
+                    return nullptr;
+                }
+            }
+            return first + len;
+        }
+
+        const char urn_prefix[] = "urn:uuid:";
+        const std::size_t urn_prefix_len = sizeof(urn_prefix) - 1;
+    }  // namespace
+
+    parse_result parse(const char* first,
+                       const char* last,
+                       parse_mode mode) noexcept
+    {
+        std::array<unsigned char, 16> bytes;
+        const char* end = nullptr;
+        switch (mode) {
+            case parse_mode::strict:
+                end = parse_strict(first, last, bytes.data());
+                break;
+
+            case parse_mode::braced:
+                if (first != last && *first == '{') {
+                    end = parse_strict(first + 1, last, bytes.data());
+                    end = end != nullptr && end != last && *end == '}'
+                              ? end + 1
+                              : nullptr;
+                }
+                break;
+
+            case parse_mode::urn:
+                end = skip_prefix(first, last, urn_prefix, urn_prefix_len);
+                if (end != nullptr) {
+                    end = parse_strict(end, last, bytes.data());
+                }
+                break;
+
+            case parse_mode::lenient: {
+                const bool braced = first != last && *first == '{';
+                auto begin = braced ? first + 1 : first;
+                if (!braced) {
+                    const auto after_urn =
+                        skip_prefix(first, last, urn_prefix, urn_prefix_len);
+                    begin = after_urn != nullptr ? after_urn : first;
+                }
+                // Most input is canonical, which has a vectorized path
+                end = parse_strict(begin, last, bytes.data());
+                if (end == nullptr) {
+                    end = detail::parse_digits(begin, last, bytes.data());
+                }
+                if (end != nullptr && braced) {
+                    end = std::find_if(end, last,
+                                       [](char ch) { return ch != '-'; });
+                    end = end != last && *end == '}' ? end + 1 : nullptr;
+                }
+                break;
+            }
+
+            default:
+                break;
+        }
+
+        if (end == nullptr) {
+            return {guid{}, first, std::errc::invalid_argument};
+        }
+        return {guid{bytes}, end, std::errc{}};
+    }
+
+    guid::guid(const char* s) : _bytes{{0}}
+    {
+        if (!detail::parse_c_string(s, _bytes.data())) {
+            zeroify();
+        }
+    }
+}  // namespace xg
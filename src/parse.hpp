@@ -0,0 +1,75 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+// Private header: text parsing kernels shared between the translation units
+// of the library. Not installed.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace xg {
+    class guid;
+
+    namespace detail {
+        /// Value of the hexadecimal digit `ch`, or `0xff` if `ch` isn't one.
+        unsigned char hex_value(unsigned char ch) noexcept;
+
+        /// Parses the canonical 8-4-4-4-12 textual representation beginning
+        /// at `s` into `out`.
+        /// \requires `s` must point to at least 36 readable characters.
+        /// \returns `false` if the characters aren't in the canonical form.
+        /// `out` is unspecified in that case.
+        bool parse_canonical(const char* s, unsigned char* out) noexcept;
+
+        /// Parses the first 32 hexadecimal digits of `[first, last)`,
+        /// skipping any hyphens before and between them.
+        /// \returns Pointer past the last digit, or `nullptr` if there
+        /// aren't 32 digits before the first other character.
+        const char* parse_digits(const char* first,
+                                 const char* last,
+                                 unsigned char* out) noexcept;
+
+        /// Parses `n` canonical rows beginning `stride` bytes apart at `text`
+        /// into `out`, and sets bit `i` of `valid` (if not null) for every
+        /// valid row `i`. Invalid rows are parsed as nil.
+        /// \returns The number of valid rows.
+        std::size_t parse_canonical_rows(const char* text,
+                                         std::size_t stride,
+                                         std::size_t n,
+                                         guid* out,
+                                         std::uint8_t* valid) noexcept;
+
+        /// Parses `[first, last)` with the rules of `guid(const char*)`:
+        /// exactly 32 hexadecimal digits, with any number of hyphens anywhere.
+        bool parse_lenient(const char* first,
+                           const char* last,
+                           unsigned char* out) noexcept;
+
+        /// Parses the null-terminated string `s` with the rules of
+        /// `guid(const char*)`, taking the vectorized path for canonical input.
+        bool parse_c_string(const char* s, unsigned char* out) noexcept;
+    }  // namespace detail
+}  // namespace xg
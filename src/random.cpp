@@ -0,0 +1,264 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#include "random.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <system_error>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace xg {
+    namespace detail {
+        namespace {
+            void read_urandom(unsigned char* p, std::size_t n)
+            {
+                int fd;
+                do {
+                    fd = ::open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+                } while (fd < 0 && errno == EINTR);
+                if (fd < 0) {
+                    throw std::system_error(errno, std::generic_category(),
+                                            "open(/dev/urandom)");
+                }
+
+                while (n > 0) {
+                    const auto r = ::read(fd, p, n);
+                    if (r < 0) {
+                        if (errno == EINTR) {
+                            continue;
+                        }
+                        const auto err = errno;
+                        ::close(fd);
+                        throw std::system_error(err, std::generic_category(),
+                                                "read(/dev/urandom)");
+                    }
+                    p += r;
+                    n -= static_cast<std::size_t>(r);
+                }
+                ::close(fd);
+            }
+
+            constexpr std::size_t block_size = 64;
+            constexpr std::size_t blocks_per_refill =
+                chacha20_blocks_size / block_size;
+            constexpr std::size_t buffer_size = chacha20_blocks_size;
+            constexpr std::size_t key_size = 32;
+            // Fresh entropy is mixed into the key after this many refills
+            // (~8 MiB of output)
+            constexpr std::uint32_t refills_per_reseed = 16384;
+
+            inline std::uint32_t rotl(std::uint32_t v, unsigned n) noexcept
+            {
+                return (v << n) | (v >> (32 - n));
+            }
+
+            inline std::uint32_t load_le32(const unsigned char* p) noexcept
+            {
+                return static_cast<std::uint32_t>(p[0]) |
+                       static_cast<std::uint32_t>(p[1]) << 8 |
+                       static_cast<std::uint32_t>(p[2]) << 16 |
+                       static_cast<std::uint32_t>(p[3]) << 24;
+            }
+
+            inline void store_le32(unsigned char* p, std::uint32_t v) noexcept
+            {
+                p[0] = static_cast<unsigned char>(v);
+                p[1] = static_cast<unsigned char>(v >> 8);
+                p[2] = static_cast<unsigned char>(v >> 16);
+                p[3] = static_cast<unsigned char>(v >> 24);
+            }
+
+            // Incremented in the child after fork(), so that the child
+            // doesn't repeat the parent's output
+            std::atomic<unsigned> fork_generation{0};
+
+            void on_fork_child()
+            {
+                fork_generation.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            // Zero-initialized, so that thread_local needs no constructor
+            // call or guard
+            struct chacha20_generator {
+                std::uint32_t key[8];
+                unsigned char buffer[buffer_size];
+                std::size_t pos;
+                std::uint32_t refills;
+                unsigned fork_seen;
+                bool seeded;
+
+                void seed()
+                {
+                    static const int registered =
+                        pthread_atfork(nullptr, nullptr, on_fork_child);
+                    static_cast<void>(registered);
+
+                    unsigned char entropy[key_size];
+                    os_random_bytes(entropy, key_size);
+                    for (std::size_t i = 0; i < 8; ++i) {
+                        // Keeps whatever entropy the old key had
+                        key[i] ^= load_le32(entropy + i * 4);
+                    }
+                    std::fill(entropy, entropy + key_size,
+                              static_cast<unsigned char>(0));
+
+                    fork_seen =
+                        fork_generation.load(std::memory_order_relaxed);
+                    refills = 0;
+                    pos = buffer_size;
+                    seeded = true;
+                }
+
+                void refill()
+                {
+                    if (++refills == refills_per_reseed) {
+                        seed();
+                    }
+                    chacha20_blocks(key, buffer);
+                    // Fast key erasure: the first bytes of the output become
+                    // the next key, and are never handed out
+                    for (std::size_t i = 0; i < 8; ++i) {
+                        key[i] = load_le32(buffer + i * 4);
+                    }
+                    std::fill(buffer, buffer + key_size,
+                              static_cast<unsigned char>(0));
+                    pos = key_size;
+                }
+
+                void generate(unsigned char* p, std::size_t n)
+                {
+                    if (!seeded ||
+                        fork_seen !=
+                            fork_generation.load(std::memory_order_relaxed)) {
+                        seed();
+                    }
+
+                    while (n > 0) {
+                        if (pos == buffer_size) {
+                            refill();
+                        }
+                        const auto len = std::min(n, buffer_size - pos);
+                        std::memcpy(p, buffer + pos, len);
+                        std::memset(buffer + pos, 0, len);
+                        pos += len;
+                        p += len;
+                        n -= len;
+                    }
+                }
+            };
+
+            thread_local chacha20_generator generator;
+        }  // namespace
+
+        void os_random_bytes(unsigned char* p, std::size_t n)
+        {
+#ifdef SYS_getrandom
+            while (n > 0) {
+                const auto r = ::syscall(SYS_getrandom, p, n, 0);
+                if (r < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    if (errno == ENOSYS) {
+                        break;
+                    }
+                    throw std::system_error(errno, std::generic_category(),
+                                            "getrandom");
+                }
+                p += r;
+                n -= static_cast<std::size_t>(r);
+            }
+            if (n == 0) {
+                return;
+            }
+#endif
+            read_urandom(p, n);
+        }
+
+        void chacha20_blocks(const std::uint32_t (&key)[8],
+                             unsigned char* out) noexcept
+        {
+            using lanes = std::uint32_t[blocks_per_refill];
+            lanes x[16], init[16];
+
+            const std::uint32_t constants[4] = {0x61707865, 0x3320646e,
+                                                0x79622d32, 0x6b206574};
+            for (std::size_t l = 0; l < blocks_per_refill; ++l) {
+                for (std::size_t i = 0; i < 4; ++i) {
+                    init[i][l] = constants[i];
+                }
+                for (std::size_t i = 0; i < 8; ++i) {
+                    init[4 + i][l] = key[i];
+                }
+                init[12][l] = static_cast<std::uint32_t>(l);
+                init[13][l] = init[14][l] = init[15][l] = 0;
+            }
+            std::memcpy(x, init, sizeof(x));
+
+            auto quarter_round = [&x](std::size_t a, std::size_t b,
+                                      std::size_t c, std::size_t d) {
+                for (std::size_t l = 0; l < blocks_per_refill; ++l) {
+                    x[a][l] += x[b][l];
+                    x[d][l] = rotl(x[d][l] ^ x[a][l], 16);
+                    x[c][l] += x[d][l];
+                    x[b][l] = rotl(x[b][l] ^ x[c][l], 12);
+                    x[a][l] += x[b][l];
+                    x[d][l] = rotl(x[d][l] ^ x[a][l], 8);
+                    x[c][l] += x[d][l];
+                    x[b][l] = rotl(x[b][l] ^ x[c][l], 7);
+                }
+            };
+            for (int round = 0; round < 10; ++round) {
+                quarter_round(0, 4, 8, 12);
+                quarter_round(1, 5, 9, 13);
+                quarter_round(2, 6, 10, 14);
+                quarter_round(3, 7, 11, 15);
+                quarter_round(0, 5, 10, 15);
+                quarter_round(1, 6, 11, 12);
+                quarter_round(2, 7, 8, 13);
+                quarter_round(3, 4, 9, 14);
+            }
+
+            for (std::size_t l = 0; l < blocks_per_refill; ++l) {
+                for (std::size_t i = 0; i < 16; ++i) {
+                    store_le32(out + l * block_size + i * 4,
+                               x[i][l] + init[i][l]);
+                }
+            }
+        }
+
+        void chacha20_random_bytes(unsigned char* p, std::size_t n)
+        {
+            generator.generate(p, n);
+        }
+    }  // namespace detail
+}  // namespace xg
@@ -0,0 +1,107 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+// Private header: random byte generation used by the generators that don't
+// go through a platform GUID API. Not installed.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace xg {
+    namespace detail {
+        /// Fills `[p, p + n)` with bytes from the operating system's
+        /// cryptographically secure random number generator (`getrandom`,
+        /// or `/dev/urandom` on kernels without it).
+        /// \throws `std::system_error` if no random source is available.
+        void os_random_bytes(unsigned char* p, std::size_t n);
+
+        /// The size of the output of [chacha20_blocks]().
+        constexpr std::size_t chacha20_blocks_size = 512;
+
+        /// Computes the ChaCha20 blocks (RFC 8439) of `key` with an all-zero
+        /// nonce and the block counters 0 to 7, into the
+        /// `chacha20_blocks_size` bytes at `out`. The blocks are computed
+        /// side by side, so that compilers can vectorize across them.
+        void chacha20_blocks(const std::uint32_t (&key)[8],
+                             unsigned char* out) noexcept;
+
+        /// Fills `[p, p + n)` with bytes from a ChaCha20 generator private to
+        /// the calling thread.
+        ///
+        /// The generator is seeded with `os_random_bytes` on first use, after
+        /// `fork()` and periodically after that. The key is replaced after
+        /// every refill of the output buffer, and handed-out bytes are wiped,
+        /// so earlier output can't be recovered from the state.
+        ///
+        /// \throws `std::system_error` if seeding fails.
+        void chacha20_random_bytes(unsigned char* p, std::size_t n);
+
+        /// Fills the `count` GUIDs at `p` with random bytes, for the
+        /// generators built on top of make_guid: from ChaCha20 where the
+        /// platform API is libuuid, which makes a system call per GUID, and
+        /// from make_guids otherwise.
+        ///
+        /// \throws `std::system_error` if no random source is available.
+        void random_guid_bytes(unsigned char* p, std::size_t count);
+
+        /// Sets the version (4) and variant (RFC 4122) bits of the GUID in
+        /// `[p, p + 16)`.
+        inline void set_v4_bits(unsigned char* p) noexcept
+        {
+            p[6] = static_cast<unsigned char>((p[6] & 0x0f) | 0x40);
+            p[8] = static_cast<unsigned char>((p[8] & 0x3f) | 0x80);
+        }
+
+        /// Sets the version (4) and variant (RFC 4122) bits of the `count`
+        /// consecutive GUIDs beginning at `p`.
+        inline void set_v4_bits(unsigned char* p, std::size_t count) noexcept
+        {
+#if defined(__SSE2__) || defined(_M_X64)
+            const __m128i keep =
+                _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 0x0f, -1, 0x3f, -1, -1,
+                              -1, -1, -1, -1, -1);
+            const __m128i set = _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0x40, 0,
+                                              static_cast<char>(0x80), 0, 0, 0,
+                                              0, 0, 0, 0);
+            for (std::size_t i = 0; i < count; ++i, p += 16) {
+                auto v = static_cast<__m128i*>(static_cast<void*>(p));
+                _mm_storeu_si128(v, _mm_or_si128(
+                                        _mm_and_si128(_mm_loadu_si128(v), keep),
+                                        set));
+            }
+#else
+            for (std::size_t i = 0; i < count; ++i, p += 16) {
+                set_v4_bits(p);
+            }
+#endif
+        }
+    }  // namespace detail
+}  // namespace xg
@@ -0,0 +1,250 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#include "crossguid/scan.hpp"
+
+#include "parallel.hpp"
+#include "parse.hpp"
+#include "simd.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace xg {
+    namespace {
+        // A candidate is a position followed by hyphens at offsets 8, 13, 18
+        // and 23, like the canonical form. The kernels advance `p` to the
+        // next candidate before `stop` and return `true`, reading no further
+        // than `limit`. Otherwise they return `false` with `p` at the first
+        // position they didn't rule out.
+        using candidate_kernel = bool (*)(const char*& p,
+                                          const char* stop,
+                                          const char* limit);
+
+        bool next_candidate_scalar(const char*& p,
+                                   const char* stop,
+                                   const char* limit) noexcept
+        {
+            while (p < stop) {
+                // Every candidate begins 8 characters before a hyphen
+                const auto from = p + 8;
+                const auto to = std::min(stop + 8, limit);
+                const auto hyphen = static_cast<const char*>(std::memchr(
+                    from, '-', static_cast<std::size_t>(to - from)));
+                if (hyphen == nullptr) {
+                    p = stop;
+                    return false;
+                }
+                const auto c = hyphen - 8;
+                if (c[13] == '-' && c[18] == '-' && c[23] == '-') {
+                    p = c;
+                    return true;
+                }
+                p = c + 1;
+            }
+            return false;
+        }
+
+#if XG_HAS_X86_SIMD
+        // Both vector kernels build a 64-bit mask of the hyphens at
+        // [p, p + 64), and shift it onto itself to get the candidates at
+        // [p, p + 32): bit i is set if bits i + 8, i + 13, i + 18 and i + 23
+        // are.
+        inline std::uint32_t candidates(std::uint64_t hyphens) noexcept
+        {
+            return static_cast<std::uint32_t>((hyphens >> 8) &
+                                              (hyphens >> 13) &
+                                              (hyphens >> 18) &
+                                              (hyphens >> 23));
+        }
+
+        inline std::uint32_t below(std::uint32_t mask,
+                                   const char* p,
+                                   const char* stop) noexcept
+        {
+            return stop - p < 32
+                       ? mask & ((std::uint32_t{1} << (stop - p)) - 1)
+                       : mask;
+        }
+
+        XG_TARGET_SSE41 std::uint32_t hyphens16(const char* p) noexcept
+        {
+            const __m128i v = _mm_loadu_si128(
+                static_cast<const __m128i*>(static_cast<const void*>(p)));
+            return static_cast<std::uint32_t>(
+                _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('-'))));
+        }
+
+        XG_TARGET_SSE41 bool next_candidate_sse41(const char*& p,
+                                                  const char* stop,
+                                                  const char* limit) noexcept
+        {
+            for (; p < stop && limit - p >= 64; p += 32) {
+                const std::uint64_t hyphens =
+                    std::uint64_t{hyphens16(p)} |
+                    std::uint64_t{hyphens16(p + 16)} << 16 |
+                    std::uint64_t{hyphens16(p + 32)} << 32 |
+                    std::uint64_t{hyphens16(p + 48)} << 48;
+                const auto c = below(candidates(hyphens), p, stop);
+                if (c != 0) {
+                    p += detail::count_trailing_zeros(c);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        XG_TARGET_AVX2 std::uint32_t hyphens32(const char* p) noexcept
+        {
+            const __m256i v = _mm256_loadu_si256(
+                static_cast<const __m256i*>(static_cast<const void*>(p)));
+            return static_cast<std::uint32_t>(_mm256_movemask_epi8(
+                _mm256_cmpeq_epi8(v, _mm256_set1_epi8('-'))));
+        }
+
+        XG_TARGET_AVX2 bool next_candidate_avx2(const char*& p,
+                                                const char* stop,
+                                                const char* limit) noexcept
+        {
+            if (p >= stop || limit - p < 64) {
+                return false;
+            }
+            // The upper half of one mask is the lower half of the next
+            std::uint32_t lo = hyphens32(p);
+            for (;;) {
+                const std::uint32_t hi = hyphens32(p + 32);
+                const auto c = below(
+                    candidates(std::uint64_t{lo} | std::uint64_t{hi} << 32),
+                    p, stop);
+                if (c != 0) {
+                    p += detail::count_trailing_zeros(c);
+                    return true;
+                }
+                p += 32;
+                if (p >= stop || limit - p < 64) {
+                    return false;
+                }
+                lo = hi;
+            }
+        }
+#endif  // XG_HAS_X86_SIMD
+
+        candidate_kernel select_candidate_kernel() noexcept
+        {
+#if XG_HAS_X86_SIMD
+            if (detail::cpu().avx2) {
+                return next_candidate_avx2;
+            }
+            if (detail::cpu().sse41) {
+                return next_candidate_sse41;
+            }
+#endif
+            return next_candidate_scalar;
+        }
+
+        bool is_hex_digit(char ch) noexcept
+        {
+            return detail::hex_value(static_cast<unsigned char>(ch)) <= 15;
+        }
+
+        // Emits the GUIDs beginning in [from, to), reading [first, last)
+        template <typename Emit>
+        void scan_range(const char* first,
+                        const char* last,
+                        const char* from,
+                        const char* to,
+                        Emit emit)
+        {
+            static const candidate_kernel kernel = select_candidate_kernel();
+            if (last - from < 36) {
+                return;
+            }
+            const auto stop = std::min(to, last - 35);
+
+            std::array<unsigned char, 16> bytes;
+            auto p = from;
+            while (kernel(p, stop, last) ||
+                   next_candidate_scalar(p, stop, last)) {
+                if (detail::parse_canonical(p, bytes.data()) &&
+                    (p == first || !is_hex_digit(p[-1])) &&
+                    (p + 36 == last || !is_hex_digit(p[36]))) {
+                    emit(scan_match{guid{bytes},
+                                    static_cast<std::size_t>(p - first)});
+                    p += 36;
+                }
+                else {
+                    ++p;
+                }
+            }
+        }
+    }  // namespace
+
+    void scan_each(const char* first,
+                   const char* last,
+                   const std::function<void(const scan_match&)>& on_match)
+    {
+        scan_range(first, last, first, last, on_match);
+    }
+
+    std::vector<scan_match> scan(const char* first,
+                                 const char* last,
+                                 const scan_options& options)
+    {
+        const auto size = static_cast<std::size_t>(last - first);
+        const auto chunk_size = std::max<std::size_t>(options.chunk_size, 1);
+        const auto chunks = (size + chunk_size - 1) / chunk_size;
+        const auto threads = detail::thread_count(options.threads, chunks);
+
+        std::vector<scan_match> matches;
+        auto append = [&matches](const scan_match& m) {
+            matches.push_back(m);
+        };
+        if (threads <= 1) {
+            scan_range(first, last, first, last, append);
+            return matches;
+        }
+
+        // Every chunk has its own results, which are concatenated at the
+        // end to keep them ordered by offset
+        std::vector<std::vector<scan_match>> results(chunks);
+        detail::parallel_for(chunks, threads, [&](std::size_t i) {
+            const auto from = first + i * chunk_size;
+            const auto to = first + std::min(size, (i + 1) * chunk_size);
+            auto& out = results[i];
+            scan_range(first, last, from, to,
+                       [&out](const scan_match& m) { out.push_back(m); });
+        });
+
+        std::size_t total = 0;
+        for (const auto& r : results) {
+            total += r.size();
+        }
+        matches.reserve(total);
+        for (const auto& r : results) {
+            matches.insert(matches.end(), r.begin(), r.end());
+        }
+        return matches;
+    }
+}  // namespace xg
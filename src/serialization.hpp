@@ -0,0 +1,116 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+
+// Private header: helpers for the binary formats of the GUID files and
+// containers. Not installed.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <system_error>
+#include <vector>
+
+namespace xg {
+    namespace detail {
+        /// Stores the `n` low bytes of `v` at `p`, little-endian.
+        inline void store_le(unsigned char* p,
+                             std::uint64_t v,
+                             std::size_t n) noexcept
+        {
+            for (std::size_t i = 0; i < n; ++i) {
+                p[i] = static_cast<unsigned char>(v >> (8 * i));
+            }
+        }
+
+        /// Loads `n` bytes at `p`, little-endian.
+        inline std::uint64_t load_le(const unsigned char* p,
+                                     std::size_t n) noexcept
+        {
+            std::uint64_t v = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                v |= std::uint64_t{p[i]} << (8 * i);
+            }
+            return v;
+        }
+
+        inline bool cache_aligned(const void* p) noexcept
+        {
+            return reinterpret_cast<std::uintptr_t>(p) % 64 == 0;
+        }
+
+        /// The number of elements, at most `max`, to skip from `p` to a
+        /// 64-byte boundary, or `max` if there's none.
+        template <typename T>
+        std::size_t cache_line_offset(const T* p, std::size_t max) noexcept
+        {
+            std::size_t offset = 0;
+            while (offset < max && !cache_aligned(p + offset)) {
+                ++offset;
+            }
+            return offset;
+        }
+
+        /// The most bytes read from a stream at once by [read_chunked]().
+        constexpr std::size_t read_chunk_size = std::size_t{1} << 20;
+
+        /// Resizes `out` to `skip` value-initialized elements, and appends
+        /// `n` objects read from `in` a chunk at a time, so that a count
+        /// from a corrupt header fails when the data ends, rather than by
+        /// allocating all of it first.
+        /// \returns `false` if the data ends early.
+        /// \requires `T` is trivially copyable.
+        template <typename T>
+        bool read_chunked(std::istream& in,
+                          std::vector<T>& out,
+                          std::size_t skip,
+                          std::size_t n)
+        {
+            const std::size_t chunk =
+                std::max<std::size_t>(read_chunk_size / sizeof(T), 1);
+            out.resize(skip);
+            for (std::size_t done = 0; done < n;) {
+                const std::size_t count = std::min(n - done, chunk);
+                out.resize(skip + done + count);
+                if (!in.read(reinterpret_cast<char*>(out.data() + skip + done),
+                             static_cast<std::streamsize>(count * sizeof(T)))) {
+                    return false;
+                }
+                done += count;
+            }
+            return true;
+        }
+
+        /// Throws `std::system_error` with `std::errc::invalid_argument`,
+        /// for malformed data.
+        [[noreturn]] inline void throw_invalid(const char* what)
+        {
+            throw std::system_error(
+                std::make_error_code(std::errc::invalid_argument), what);
+        }
+    }  // namespace detail
+}  // namespace xg
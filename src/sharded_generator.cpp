@@ -0,0 +1,195 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#include "crossguid/sharded_generator.hpp"
+
+#include "random.hpp"
+
+#include <algorithm>
+#include <system_error>
+
+namespace xg {
+    namespace {
+        // The largest block of sequence numbers a thread reserves at once
+        const std::uint64_t max_block = 256;
+
+        // The sequence numbers reserved by the calling thread, from the last
+        // generator it used
+        struct thread_block {
+            std::uint64_t generator{0};
+            std::uint64_t next{0};
+            std::uint64_t last{0};
+            std::uint64_t size{1};
+        };
+        thread_local thread_block block;
+
+        std::atomic<std::uint64_t> next_generator_id{1};
+
+        std::uint64_t low_mask(unsigned bits) noexcept
+        {
+            return bits >= 64 ? ~std::uint64_t{0}
+                              : (std::uint64_t{1} << bits) - 1;
+        }
+
+        void store_u64_be(unsigned char* p, std::uint64_t v) noexcept
+        {
+            for (std::size_t i = 0; i < 8; ++i) {
+                p[i] = static_cast<unsigned char>(v >> (56 - 8 * i));
+            }
+        }
+
+        // Sets bits [offset, offset + width) of the payload (a, b), laid out
+        // as in detail::payload_bits, to `value`
+        void set_payload_bits(std::uint64_t& a,
+                              std::uint64_t& b,
+                              unsigned offset,
+                              unsigned width,
+                              std::uint64_t value) noexcept
+        {
+            if (width == 0) {
+                return;
+            }
+            const std::uint64_t mask = low_mask(width);
+            value &= mask;
+            const unsigned shift = 122 - offset - width;
+            const std::uint64_t b_mask = 0x3fffffffffffffff;
+            if (shift >= 62) {
+                a = (a & ~(mask << (shift - 62))) | (value << (shift - 62));
+                return;
+            }
+            b = (b & ~((mask << shift) & b_mask)) | ((value << shift) & b_mask);
+            a = (a & ~(mask >> (62 - shift))) | (value >> (62 - shift));
+        }
+    }  // namespace
+
+    sharded_generator::sharded_generator(std::uint64_t node,
+                                         const sharded_layout& layout)
+        : _layout(layout),
+          _node(node),
+          _id(next_generator_id.fetch_add(1, std::memory_order_relaxed))
+    {
+        const auto fixed = std::uint64_t{layout.timestamp_bits} +
+                           layout.node_bits + layout.sequence_bits;
+        if (fixed > 122 || layout.node_bits > 64 ||
+            layout.timestamp_bits + std::uint64_t{layout.sequence_bits} > 64 ||
+            layout.sequence_bits > 63 || layout.tick.count() <= 0 ||
+            (node & ~low_mask(layout.node_bits)) != 0) {
+            throw std::system_error(
+                std::make_error_code(std::errc::invalid_argument),
+                "xg::sharded_generator: invalid layout or node ID");
+        }
+    }
+
+    guid sharded_generator::operator()()
+    {
+        guid g;
+        generate(&g, 1);
+        return g;
+    }
+
+    guid* sharded_generator::generate(guid* first, std::size_t n)
+    {
+        auto* p = static_cast<unsigned char*>(static_cast<void*>(first));
+        if (_layout.random_bits() != 0) {
+            detail::random_guid_bytes(p, n);
+        }
+
+        const std::uint64_t current = now();
+        for (std::size_t i = 0; i < n; ++i, p += 16) {
+            // A block of an earlier tick is abandoned, so that the GUIDs of
+            // different threads stay ordered by time
+            if (block.generator != _id || block.next == block.last ||
+                block.next < current) {
+                const bool used_up = block.generator == _id &&
+                                     block.next == block.last &&
+                                     block.last > current;
+                block.size =
+                    used_up ? std::min(block.size * 2, max_block) : 1;
+                const auto wanted =
+                    std::max<std::uint64_t>(block.size, n - i);
+                reserve(current, wanted, block.next, block.last);
+                block.generator = _id;
+            }
+            encode(p, block.next++);
+        }
+        return first;
+    }
+
+    std::uint64_t sharded_generator::now() const noexcept
+    {
+        using namespace std::chrono;
+        const auto since_epoch = duration_cast<microseconds>(
+            system_clock::now() - _layout.epoch);
+        const auto ticks =
+            since_epoch.count() < 0
+                ? std::uint64_t{0}
+                : static_cast<std::uint64_t>(since_epoch.count() /
+                                             _layout.tick.count());
+        return (ticks & low_mask(_layout.timestamp_bits))
+               << _layout.sequence_bits;
+    }
+
+    void sharded_generator::reserve(std::uint64_t now,
+                                    std::uint64_t n,
+                                    std::uint64_t& first,
+                                    std::uint64_t& last) noexcept
+    {
+        const std::uint64_t per_tick = std::uint64_t{1}
+                                       << _layout.sequence_bits;
+        auto prev = _state.load(std::memory_order_relaxed);
+        for (;;) {
+            first = std::max(prev, now);
+            // Within one tick
+            const auto left = per_tick - (first & (per_tick - 1));
+            last = first + std::min(n, left);
+            if (_state.compare_exchange_weak(prev, last,
+                                             std::memory_order_relaxed)) {
+                return;
+            }
+        }
+    }
+
+    void sharded_generator::encode(unsigned char* p,
+                                   std::uint64_t position) const noexcept
+    {
+        const auto& l = _layout;
+        std::uint64_t a = 0;
+        std::uint64_t b = 0;
+        if (l.random_bits() != 0) {
+            const std::uint64_t hi = detail::load_u64_be(p);
+            const std::uint64_t lo = detail::load_u64_be(p + 8);
+            a = ((hi >> 16) << 12) | (hi & 0xfff);
+            b = lo & 0x3fffffffffffffff;
+        }
+        set_payload_bits(a, b, 0, l.timestamp_bits,
+                         position >> l.sequence_bits);
+        set_payload_bits(a, b, l.timestamp_bits, l.node_bits, _node);
+        set_payload_bits(a, b, l.timestamp_bits + l.node_bits,
+                         l.sequence_bits, position);
+
+        // Version 8 and the RFC variant
+        store_u64_be(p, ((a >> 12) << 16) | 0x8000 | (a & 0xfff));
+        store_u64_be(p + 8, 0x8000000000000000 | b);
+    }
+}  // namespace xg
@@ -0,0 +1,152 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+// Private header: CPU feature detection and SIMD helpers shared by the
+// vectorized kernels. Not installed.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || \
+    defined(_M_IX86)
+#define XG_X86 1
+#else
+#define XG_X86 0
+#endif
+
+// XG_NO_SIMD is set by CMake when CROSSGUID_SIMD is OFF
+#if XG_X86 && !defined(XG_NO_SIMD) && \
+    (defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER))
+#define XG_HAS_X86_SIMD 1
+#else
+#define XG_HAS_X86_SIMD 0
+#endif
+
+#if XG_HAS_X86_SIMD
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// GCC and Clang need the instruction set enabled per function to use the
+// intrinsics without compiling the whole library with -mavx2.
+// MSVC allows them everywhere.
+#if defined(__GNUC__) || defined(__clang__)
+#define XG_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define XG_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define XG_TARGET_SSE41
+#define XG_TARGET_AVX2
+#endif
+
+// Kernels reading past the end of a string, but never past the end of its
+// memory page (see within_page), are invisible to AddressSanitizer
+#if defined(__GNUC__) || defined(__clang__)
+#define XG_NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#else
+#define XG_NO_SANITIZE_ADDRESS
+#endif
+#endif  // XG_HAS_X86_SIMD
+
+namespace xg {
+    namespace detail {
+        struct cpu_features {
+            bool sse41{false};
+            bool avx2{false};
+        };
+
+        inline cpu_features detect_cpu_features() noexcept
+        {
+            cpu_features f{};
+#if XG_HAS_X86_SIMD
+#if defined(__GNUC__) || defined(__clang__)
+            __builtin_cpu_init();
+            f.sse41 = __builtin_cpu_supports("sse4.1") != 0;
+            f.avx2 = __builtin_cpu_supports("avx2") != 0;
+#else
+            int regs[4];
+            __cpuid(regs, 0);
+            const int max_leaf = regs[0];
+            if (max_leaf >= 1) {
+                __cpuid(regs, 1);
+                f.sse41 = (regs[2] & (1 << 19)) != 0;
+                const bool osxsave = (regs[2] & (1 << 27)) != 0;
+                const bool ymm_enabled =
+                    osxsave && (_xgetbv(0) & 0x6) == 0x6;
+                if (max_leaf >= 7 && ymm_enabled) {
+                    __cpuidex(regs, 7, 0);
+                    f.avx2 = (regs[1] & (1 << 5)) != 0;
+                }
+            }
+#endif
+#endif
+            return f;
+        }
+
+        /// CPU features of the running machine, detected once.
+        inline const cpu_features& cpu() noexcept
+        {
+            static const cpu_features f = detect_cpu_features();
+            return f;
+        }
+
+#if XG_HAS_X86_SIMD
+        /// Index of the lowest set bit of `x`.
+        /// \requires `x != 0`
+        inline unsigned count_trailing_zeros(std::uint32_t x) noexcept
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return static_cast<unsigned>(__builtin_ctz(x));
+#else
+            unsigned long i;
+            _BitScanForward(&i, x);
+            return static_cast<unsigned>(i);
+#endif
+        }
+
+        /// Number of set bits of `x`.
+        inline unsigned popcount(std::uint32_t x) noexcept
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return static_cast<unsigned>(__builtin_popcount(x));
+#else
+            x = x - ((x >> 1) & 0x55555555);
+            x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+            return static_cast<unsigned>(
+                (((x + (x >> 4)) & 0x0f0f0f0f) * 0x01010101) >> 24);
+#endif
+        }
+#endif
+
+        /// \returns `true` if the `n` bytes beginning at `p` are on the same
+        /// memory page, so a vector load of them can't fault even if the
+        /// object ends earlier.
+        inline bool within_page(const void* p, std::size_t n) noexcept
+        {
+            return (reinterpret_cast<std::uintptr_t>(p) & 4095) <= 4096 - n;
+        }
+    }  // namespace detail
+}  // namespace xg
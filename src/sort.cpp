@@ -0,0 +1,330 @@
+// Copyright (c) 2014 Graeme Hill (http://graemehill.ca)
+// Copyright (c) 2018 Elias Kosunen (https://eliaskosunen.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// This file is a part of crossguid:
+//   https://github.com/eliaskosunen/crossguid
+
+#include "crossguid/sort.hpp"
+
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace xg {
+    namespace {
+        using histogram = std::array<std::size_t, 256>;
+
+        // Below this many GUIDs, the fixed costs of a radix sort don't pay
+        // off
+        const std::size_t small_sort = 256;
+        // Up to this many GUIDs, 2 arrays of them fit in the cache, and are
+        // sorted one byte at a time
+        const std::size_t cache_sort = std::size_t{1} << 14;
+        // Fewest GUIDs worth a thread in a pass
+        const std::size_t min_block = std::size_t{1} << 16;
+
+        unsigned char byte_at(const guid& g, std::size_t k) noexcept
+        {
+            return g.data()[k];
+        }
+
+        // Offsets of the beginning of every bucket
+        histogram bucket_offsets(const histogram& counts) noexcept
+        {
+            histogram offsets;
+            std::size_t sum = 0;
+            for (std::size_t b = 0; b < 256; ++b) {
+                offsets[b] = sum;
+                sum += counts[b];
+            }
+            return offsets;
+        }
+
+        struct buffer_deleter {
+            void operator()(guid* p) const noexcept
+            {
+                ::operator delete(p);
+            }
+        };
+
+        // The buckets ordered by size, largest first, to balance the threads
+        std::array<unsigned char, 256> largest_first(const histogram& counts)
+        {
+            std::array<unsigned char, 256> order;
+            for (std::size_t d = 0; d < 256; ++d) {
+                order[d] = static_cast<unsigned char>(d);
+            }
+            std::stable_sort(order.begin(), order.end(),
+                             [&counts](unsigned char a, unsigned char b) {
+                                 return counts[a] > counts[b];
+                             });
+            return order;
+        }
+
+        bool all_equal(const histogram& counts, std::size_t n) noexcept
+        {
+            return std::find(counts.begin(), counts.end(), n) != counts.end();
+        }
+
+        histogram count_byte(const guid* first,
+                             const guid* last,
+                             std::size_t k) noexcept
+        {
+            histogram counts{};
+            for (; first != last; ++first) {
+                ++counts[byte_at(*first, k)];
+            }
+            return counts;
+        }
+
+        // Stably distributes [first, last) to `dst` by byte `k`, at
+        // `offsets`, which are advanced
+        void scatter(const guid* first,
+                     const guid* last,
+                     guid* dst,
+                     std::size_t k,
+                     histogram& offsets) noexcept
+        {
+            for (; first != last; ++first) {
+                dst[offsets[byte_at(*first, k)]++] = *first;
+            }
+        }
+
+        // Sorts [a, a + n), small enough for both it and `b` to stay in
+        // cache, by bytes k to 15 with one pass per byte from the last one,
+        // back and forth between `a` and the buffer `b`.
+        void lsd_sort(guid* a, guid* b, std::size_t n, std::size_t k) noexcept
+        {
+            // The histograms don't change between passes, so they're all
+            // counted at once, and tell which bytes are the same in every
+            // GUID
+            histogram counts[16] = {};
+            for (std::size_t i = 0; i < n; ++i) {
+                for (std::size_t j = k; j < 16; ++j) {
+                    ++counts[j][byte_at(a[i], j)];
+                }
+            }
+
+            guid* src = a;
+            guid* dst = b;
+            for (std::size_t j = 16; j-- > k;) {
+                if (all_equal(counts[j], n)) {
+                    continue;
+                }
+                histogram offsets = bucket_offsets(counts[j]);
+                scatter(src, src + n, dst, j, offsets);
+                std::swap(src, dst);
+            }
+            if (src != a) {
+                std::copy(src, src + n, a);
+            }
+        }
+
+        // Sorts [a, a + n) by bytes k to 15, with the buffer `b`.
+        // Inputs too large for the cache are first distributed to `b` by
+        // byte `k`, and every bucket is sorted on its own back in `a`.
+        void radix_sort(guid* a, guid* b, std::size_t n, std::size_t k) noexcept
+        {
+            for (; k < 16; ++k) {
+                if (n <= small_sort) {
+                    std::sort(a, a + n);
+                    return;
+                }
+                if (n <= cache_sort) {
+                    lsd_sort(a, b, n, k);
+                    return;
+                }
+
+                const histogram counts = count_byte(a, a + n, k);
+                if (all_equal(counts, n)) {
+                    continue;
+                }
+                histogram offsets = bucket_offsets(counts);
+                scatter(a, a + n, b, k, offsets);
+                std::size_t first = 0;
+                for (std::size_t d = 0; d < 256; ++d) {
+                    radix_sort(b + first, a + first, counts[d], k + 1);
+                    std::copy(b + first, b + first + counts[d], a + first);
+                    first += counts[d];
+                }
+                return;
+            }
+        }
+
+        // radix_sort on `threads` threads: the first distribution is divided
+        // into a contiguous block per thread, each counting and distributing
+        // its own GUIDs, and then the buckets are divided between them
+        void radix_sort_parallel(guid* a,
+                                 guid* b,
+                                 std::size_t n,
+                                 unsigned threads)
+        {
+            const std::size_t blocks = threads;
+            const std::size_t block_size = (n + blocks - 1) / blocks;
+            const auto block_first = [=](std::size_t i) {
+                return std::min(i * block_size, n);
+            };
+
+            std::vector<histogram> offsets(blocks);
+            for (std::size_t k = 0; k < 16; ++k) {
+                detail::parallel_for(blocks, threads, [&](std::size_t i) {
+                    offsets[i] = count_byte(a + block_first(i),
+                                            a + block_first(i + 1), k);
+                });
+                histogram counts{};
+                for (const auto& h : offsets) {
+                    for (std::size_t d = 0; d < 256; ++d) {
+                        counts[d] += h[d];
+                    }
+                }
+                if (all_equal(counts, n)) {
+                    continue;
+                }
+
+                // Every block distributes its GUIDs to its own part of
+                // every bucket, after those of the previous blocks
+                std::size_t sum = 0;
+                for (std::size_t d = 0; d < 256; ++d) {
+                    for (auto& h : offsets) {
+                        const auto count = h[d];
+                        h[d] = sum;
+                        sum += count;
+                    }
+                }
+                detail::parallel_for(blocks, threads, [&](std::size_t i) {
+                    scatter(a + block_first(i), a + block_first(i + 1), b, k,
+                            offsets[i]);
+                });
+
+                const histogram firsts = bucket_offsets(counts);
+                const auto order = largest_first(counts);
+                detail::parallel_for(256, threads, [&](std::size_t i) {
+                    const auto d = order[i];
+                    radix_sort(b + firsts[d], a + firsts[d], counts[d], k + 1);
+                    std::copy(b + firsts[d], b + firsts[d] + counts[d],
+                              a + firsts[d]);
+                });
+                return;
+            }
+        }
+
+        // Permutes [first, first + n) into the buckets of byte `k` in place.
+        // \returns The counts of the buckets.
+        histogram partition_in_place(guid* first,
+                                     std::size_t n,
+                                     std::size_t k) noexcept
+        {
+            const histogram counts = count_byte(first, first + n, k);
+            if (all_equal(counts, n)) {
+                return counts;
+            }
+
+            // Every GUID is swapped straight to the next free place of its
+            // bucket, until the one in hand belongs to the current bucket
+            histogram heads = bucket_offsets(counts);
+            histogram tails;
+            for (std::size_t d = 0; d < 256; ++d) {
+                tails[d] = heads[d] + counts[d];
+            }
+            for (std::size_t d = 0; d < 256; ++d) {
+                while (heads[d] < tails[d]) {
+                    guid g = first[heads[d]];
+                    for (auto b = byte_at(g, k); b != d; b = byte_at(g, k)) {
+                        std::swap(g, first[heads[b]++]);
+                    }
+                    first[heads[d]++] = g;
+                }
+            }
+            return counts;
+        }
+
+        void msd_sort(guid* first, std::size_t n, std::size_t k) noexcept
+        {
+            if (n <= small_sort || k == 16) {
+                std::sort(first, first + n);
+                return;
+            }
+            const histogram counts = partition_in_place(first, n, k);
+            for (std::size_t d = 0; d < 256; ++d) {
+                if (counts[d] > 1) {
+                    msd_sort(first, counts[d], k + 1);
+                }
+                first += counts[d];
+            }
+        }
+
+        void msd_sort_parallel(guid* first, std::size_t n, unsigned threads)
+        {
+            // Partition by the leading bytes until there are buckets to
+            // divide between the threads
+            for (std::size_t k = 0; k < 16; ++k) {
+                const histogram counts = partition_in_place(first, n, k);
+                if (all_equal(counts, n)) {
+                    continue;
+                }
+                const histogram offsets = bucket_offsets(counts);
+                const auto order = largest_first(counts);
+                detail::parallel_for(256, threads, [&](std::size_t i) {
+                    const auto d = order[i];
+                    msd_sort(first + offsets[d], counts[d], k + 1);
+                });
+                return;
+            }
+        }
+    }  // namespace
+
+    void sort(guid* first, guid* last, const sort_options& options)
+    {
+        const auto n = static_cast<std::size_t>(last - first);
+        if (n <= small_sort) {
+            std::sort(first, last);
+            return;
+        }
+        const auto threads =
+            detail::thread_count(options.threads, n / min_block);
+
+        // Uninitialized, since every GUID in it is written before it's read
+        std::unique_ptr<guid, buffer_deleter> buf;
+        if (!options.in_place) {
+            buf.reset(static_cast<guid*>(
+                ::operator new(n * sizeof(guid), std::nothrow)));
+        }
+        if (!buf) {
+            if (threads <= 1) {
+                msd_sort(first, n, 0);
+            }
+            else {
+                msd_sort_parallel(first, n, threads);
+            }
+            return;
+        }
+        if (threads <= 1) {
+            radix_sort(first, buf.get(), n, 0);
+        }
+        else {
+            radix_sort_parallel(first, buf.get(), n, threads);
+        }
+    }
+}  // namespace xg
@@ -22,14 +22,57 @@
 // This file is a part of crossguid:
 //   https://github.com/eliaskosunen/crossguid
 
+// Before <crossguid/format.hpp>, which then specializes fmt::formatter
+#ifdef CROSSGUID_TEST_FMT
+#include <fmt/format.h>
+#endif
+
+#include <crossguid/batch.hpp>
+#include <crossguid/concurrent_guid_map.hpp>
+#include <crossguid/encoding.hpp>
+#include <crossguid/format.hpp>
 #include <crossguid/guid.hpp>
+#include <crossguid/guid_column.hpp>
+#include <crossguid/guid_filter.hpp>
+#include <crossguid/guid_index.hpp>
+#include <crossguid/guid_interner.hpp>
+#include <crossguid/guid_map.hpp>
+#include <crossguid/guid_pool.hpp>
+#include <crossguid/mapped_file.hpp>
+#include <crossguid/scan.hpp>
+#include <crossguid/sharded_generator.hpp>
+#include <crossguid/sort.hpp>
 
 #include <doctest.h>
 
+#ifdef CROSSGUID_TEST_RANDOM
+#include <random.hpp>
+#endif
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
 #include <iostream>
+#include <memory>
+#include <random>
+#include <set>
 #include <sstream>
+#include <string>
+#include <thread>
 #include <type_traits>
 #include <unordered_map>
+#include <vector>
 
 TEST_CASE("construction")
 {
@@ -45,6 +88,14 @@ TEST_CASE("construction")
         CHECK(g);
         CHECK(g != xg::make_guid());
     }
+    SUBCASE("make_guid version and variant")
+    {
+        for (int i = 0; i < 100; ++i) {
+            auto g = xg::make_guid();
+            CHECK((g.bytes()[6] & 0xf0) == 0x40);
+            CHECK((g.bytes()[8] & 0xc0) == 0x80);
+        }
+    }
     SUBCASE("string")
     {
         auto str = "7bcd757f-5b10-4f9b-af69-1a1f226f3b3e";
@@ -55,6 +106,417 @@ TEST_CASE("construction")
     }
 }
 
+TEST_CASE("bulk generation")
+{
+    auto check_all = [](const xg::guid* first, const xg::guid* last) {
+        std::vector<xg::guid> sorted(first, last);
+        std::sort(sorted.begin(), sorted.end(), std::less<xg::guid>{});
+        CHECK(std::adjacent_find(sorted.begin(), sorted.end()) ==
+              sorted.end());
+        for (const auto& g : sorted) {
+            CHECK((g.bytes()[6] & 0xf0) == 0x40);
+            CHECK((g.bytes()[8] & 0xc0) == 0x80);
+        }
+    };
+
+    SUBCASE("pointer")
+    {
+        std::vector<xg::guid> v(10000);
+        auto end = xg::make_guids(v.data(), v.size());
+        CHECK(end == v.data() + v.size());
+        check_all(v.data(), end);
+
+        auto range_end = xg::make_guids(v.data(), v.data() + 10);
+        CHECK(range_end == v.data() + 10);
+        check_all(v.data(), v.data() + v.size());
+
+        // A literal 0 is a count, not a null pointer
+        CHECK(xg::make_guids(v.data(), 0) == v.data());
+    }
+    SUBCASE("iterator range")
+    {
+        std::vector<xg::guid> v(1000);
+        CHECK(xg::make_guids(v.begin(), v.end()) == v.end());
+        check_all(v.data(), v.data() + v.size());
+    }
+    SUBCASE("arrays")
+    {
+        std::array<xg::guid, 100> arr;
+        xg::make_guids(arr);
+        check_all(arr.data(), arr.data() + arr.size());
+
+        xg::guid c_arr[100];
+        xg::make_guids(c_arr);
+        check_all(c_arr, c_arr + 100);
+    }
+    SUBCASE("output iterator")
+    {
+        std::vector<xg::guid> v;
+        xg::make_guids(std::back_inserter(v), 1000);
+        CHECK(v.size() == 1000);
+        check_all(v.data(), v.data() + v.size());
+
+        v.clear();
+        xg::make_guids(std::back_inserter(v), 0);
+        CHECK(v.empty());
+    }
+}
+
+#ifdef CROSSGUID_TEST_RANDOM
+TEST_CASE("ChaCha20")
+{
+    SUBCASE("RFC 8439 block function")
+    {
+        // Test vectors #1 and #2 of appendix A.1: an all-zero key and
+        // nonce, and the block counters 0 and 1
+        const unsigned char block0[64] = {
+            0x76, 0xb8, 0xe0, 0xad, 0xa0, 0xf1, 0x3d, 0x90, 0x40, 0x5d, 0x6a,
+            0xe5, 0x53, 0x86, 0xbd, 0x28, 0xbd, 0xd2, 0x19, 0xb8, 0xa0, 0x8d,
+            0xed, 0x1a, 0xa8, 0x36, 0xef, 0xcc, 0x8b, 0x77, 0x0d, 0xc7, 0xda,
+            0x41, 0x59, 0x7c, 0x51, 0x57, 0x48, 0x8d, 0x77, 0x24, 0xe0, 0x3f,
+            0xb8, 0xd8, 0x4a, 0x37, 0x6a, 0x43, 0xb8, 0xf4, 0x15, 0x18, 0xa1,
+            0x1c, 0xc3, 0x87, 0xb6, 0x69, 0xb2, 0xee, 0x65, 0x86};
+        const unsigned char block1[64] = {
+            0x9f, 0x07, 0xe7, 0xbe, 0x55, 0x51, 0x38, 0x7a, 0x98, 0xba, 0x97,
+            0x7c, 0x73, 0x2d, 0x08, 0x0d, 0xcb, 0x0f, 0x29, 0xa0, 0x48, 0xe3,
+            0x65, 0x69, 0x12, 0xc6, 0x53, 0x3e, 0x32, 0xee, 0x7a, 0xed, 0x29,
+            0xb7, 0x21, 0x76, 0x9c, 0xe6, 0x4e, 0x43, 0xd5, 0x71, 0x33, 0xb0,
+            0x74, 0xd8, 0x39, 0xd5, 0x31, 0xed, 0x1f, 0x28, 0x51, 0x0a, 0xfb,
+            0x45, 0xac, 0xe1, 0x0a, 0x1f, 0x4b, 0x79, 0x4d, 0x6f};
+
+        const std::uint32_t key[8] = {0};
+        unsigned char out[xg::detail::chacha20_blocks_size];
+        xg::detail::chacha20_blocks(key, out);
+        CHECK(std::equal(block0, block0 + 64, out));
+        CHECK(std::equal(block1, block1 + 64, out + 64));
+    }
+    SUBCASE("reseeded after fork")
+    {
+        // Without reseeding, the child would continue the parent's stream
+        unsigned char parent[32];
+        xg::detail::chacha20_random_bytes(parent, sizeof parent);
+
+        int fds[2];
+        REQUIRE(::pipe(fds) == 0);
+        const pid_t pid = ::fork();
+        REQUIRE(pid >= 0);
+        if (pid == 0) {
+            ::close(fds[0]);
+            unsigned char child[32];
+            xg::detail::chacha20_random_bytes(child, sizeof child);
+            const bool ok =
+                ::write(fds[1], child, sizeof child) == sizeof child;
+            ::_exit(ok ? 0 : 1);
+        }
+        ::close(fds[1]);
+        unsigned char child[32];
+        const auto r = ::read(fds[0], child, sizeof child);
+        ::close(fds[0]);
+        int status = 0;
+        REQUIRE(::waitpid(pid, &status, 0) == pid);
+        CHECK(WIFEXITED(status));
+        CHECK(WEXITSTATUS(status) == 0);
+        REQUIRE(r == sizeof child);
+
+        xg::detail::chacha20_random_bytes(parent, sizeof parent);
+        CHECK(!std::equal(parent, parent + sizeof parent, child));
+    }
+}
+#endif
+
+TEST_CASE("time-ordered generation")
+{
+    auto now_ms = []() {
+        using namespace std::chrono;
+        return static_cast<std::uint64_t>(
+            duration_cast<milliseconds>(system_clock::now().time_since_epoch())
+                .count());
+    };
+
+    SUBCASE("fields")
+    {
+        const auto before = now_ms();
+        const auto g = xg::make_guid_v7();
+        const auto after = now_ms();
+
+        CHECK(g);
+        CHECK(g.version() == 7);
+        CHECK((g.bytes()[8] & 0xc0) == 0x80);
+        CHECK(xg::v7_timestamp(g) >= before);
+        // The counter may run ahead of the clock, but not by much
+        CHECK(xg::v7_timestamp(g) <= after + 1000);
+        CHECK(xg::make_guid().version() == 4);
+    }
+    SUBCASE("ordering")
+    {
+        auto prev = xg::make_guid_v7();
+        for (int i = 0; i < 100000; ++i) {
+            auto next = xg::make_guid_v7();
+            REQUIRE(std::less<xg::guid>{}(prev, next));
+            prev = next;
+        }
+    }
+    SUBCASE("ordering across threads")
+    {
+        const std::size_t thread_count = 8, per_thread = 50000;
+        std::vector<std::vector<xg::guid>> results(thread_count);
+        std::vector<std::thread> threads;
+        for (std::size_t t = 0; t < thread_count; ++t) {
+            threads.emplace_back([&results, t, per_thread]() {
+                auto& out = results[t];
+                out.reserve(per_thread);
+                for (std::size_t i = 0; i < per_thread; ++i) {
+                    out.push_back(xg::make_guid_v7());
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+
+        std::vector<xg::guid> all;
+        for (const auto& r : results) {
+            CHECK(std::is_sorted(r.begin(), r.end(), std::less<xg::guid>{}));
+            CHECK(std::adjacent_find(r.begin(), r.end()) == r.end());
+            all.insert(all.end(), r.begin(), r.end());
+        }
+        std::sort(all.begin(), all.end(), std::less<xg::guid>{});
+        CHECK(std::adjacent_find(all.begin(), all.end()) == all.end());
+    }
+}
+
+TEST_CASE("sharded generation")
+{
+    auto now_ms = []() {
+        using namespace std::chrono;
+        return static_cast<std::uint64_t>(
+            duration_cast<milliseconds>(system_clock::now().time_since_epoch())
+                .count());
+    };
+
+    SUBCASE("fields")
+    {
+        xg::sharded_generator gen{1234};
+        const auto before = now_ms();
+        const auto g = gen();
+        const auto after = now_ms();
+
+        CHECK(g.version() == 8);
+        CHECK((g.bytes()[8] & 0xc0) == 0x80);
+        const auto& layout = gen.layout();
+        CHECK(layout.random_bits() == 42);
+        CHECK(layout.node(g) == 1234);
+        CHECK(layout.timestamp(g) >= before);
+        CHECK(layout.timestamp(g) <= after + 1000);
+        CHECK(layout.time(g) <=
+              std::chrono::system_clock::now() + std::chrono::seconds(1));
+        CHECK(xg::sharded_generator{0}().version() == 8);
+    }
+    SUBCASE("custom layouts")
+    {
+        xg::sharded_layout layout;
+        layout.timestamp_bits = 41;
+        layout.node_bits = 64;
+        layout.sequence_bits = 17;
+        layout.tick = std::chrono::microseconds{100};
+        layout.epoch = std::chrono::system_clock::now() - std::chrono::hours(1);
+        CHECK(layout.random_bits() == 0);
+        const std::uint64_t node = 0xfedcba9876543210;
+        xg::sharded_generator gen{node, layout};
+        std::vector<xg::guid> v(1000);
+        gen.generate(v.data(), v.size());
+        for (const auto& g : v) {
+            CHECK(g.version() == 8);
+            CHECK((g.bytes()[8] & 0xc0) == 0x80);
+            CHECK(layout.node(g) == node);
+            CHECK(layout.timestamp(g) >= 36000000);
+            CHECK(layout.timestamp(g) < 36000000 + 100000);
+        }
+        CHECK(std::is_sorted(v.begin(), v.end()));
+        CHECK(std::adjacent_find(v.begin(), v.end()) == v.end());
+
+        // Every field at every offset
+        for (unsigned ts_bits : {0u, 1u, 13u, 47u, 60u}) {
+            for (unsigned node_bits : {0u, 3u, 33u, 62u}) {
+                xg::sharded_layout l;
+                l.timestamp_bits = ts_bits;
+                l.node_bits = node_bits;
+                l.sequence_bits = 64 - ts_bits > 20 ? 20 : 64 - ts_bits;
+                if (ts_bits + node_bits + l.sequence_bits > 122) {
+                    continue;
+                }
+                const std::uint64_t mask =
+                    node_bits == 0 ? 0 : (std::uint64_t{1} << node_bits) - 1;
+                xg::sharded_generator g{0x5555555555555555 & mask, l};
+                const auto id = g();
+                CHECK(l.node(id) == g.node());
+                CHECK(id.version() == 8);
+            }
+        }
+    }
+    SUBCASE("sequence overflow")
+    {
+        xg::sharded_layout layout;
+        layout.sequence_bits = 2;
+        xg::sharded_generator gen{7, layout};
+        const auto first = gen();
+        auto prev = first;
+        for (int i = 0; i < 1000; ++i) {
+            const auto next = gen();
+            REQUIRE(prev < next);
+            CHECK(layout.sequence(next) < 4);
+            prev = next;
+        }
+        // At most 4 GUIDs per tick, so the timestamp ran ahead
+        CHECK(layout.timestamp(prev) - layout.timestamp(first) >= 249);
+    }
+    SUBCASE("threads")
+    {
+        xg::sharded_generator gen{42};
+        const std::size_t thread_count = 8, per_thread = 50000;
+        std::vector<std::vector<xg::guid>> results(thread_count);
+        std::vector<std::thread> threads;
+        for (std::size_t t = 0; t < thread_count; ++t) {
+            threads.emplace_back([&results, &gen, t, per_thread]() {
+                auto& out = results[t];
+                out.resize(per_thread);
+                for (std::size_t i = 0; i < per_thread; i += 1000) {
+                    if (i % 2000 == 0) {
+                        gen.generate(out.data() + i, 1000);
+                    }
+                    else {
+                        for (std::size_t j = i; j < i + 1000; ++j) {
+                            out[j] = gen();
+                        }
+                    }
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+
+        std::vector<xg::guid> all;
+        for (const auto& r : results) {
+            CHECK(std::is_sorted(r.begin(), r.end()));
+            CHECK(std::adjacent_find(r.begin(), r.end()) == r.end());
+            all.insert(all.end(), r.begin(), r.end());
+        }
+        std::sort(all.begin(), all.end());
+        CHECK(std::adjacent_find(all.begin(), all.end()) == all.end());
+        std::set<std::pair<std::uint64_t, std::uint64_t>> positions;
+        for (const auto& g : all) {
+            CHECK(gen.layout().node(g) == 42);
+            positions.emplace(gen.layout().timestamp(g),
+                              gen.layout().sequence(g));
+        }
+        CHECK(positions.size() == all.size());
+    }
+    SUBCASE("invalid layouts")
+    {
+        xg::sharded_layout layout;
+        CHECK_THROWS_AS(xg::sharded_generator(1 << 16, layout),
+                        std::system_error);
+        layout.node_bits = 60;
+        CHECK_THROWS_AS(xg::sharded_generator(0, layout), std::system_error);
+        layout.node_bits = 16;
+        layout.sequence_bits = 17;
+        CHECK_THROWS_AS(xg::sharded_generator(0, layout), std::system_error);
+        layout.sequence_bits = 16;
+        layout.tick = std::chrono::microseconds{0};
+        CHECK_THROWS_AS(xg::sharded_generator(0, layout), std::system_error);
+    }
+}
+
+TEST_CASE("name-based generation")
+{
+    SUBCASE("namespaces")
+    {
+        constexpr xg::guid dns = xg::namespace_dns;
+        CHECK(dns == xg::guid{"6ba7b810-9dad-11d1-80b4-00c04fd430c8"});
+        CHECK(xg::namespace_url ==
+              xg::guid{"6ba7b811-9dad-11d1-80b4-00c04fd430c8"});
+        CHECK(xg::namespace_oid ==
+              xg::guid{"6ba7b812-9dad-11d1-80b4-00c04fd430c8"});
+        CHECK(xg::namespace_x500 ==
+              xg::guid{"6ba7b814-9dad-11d1-80b4-00c04fd430c8"});
+    }
+
+    struct vector {
+        std::string name;
+        const char* v5;
+        const char* v3;
+    };
+    const std::vector<vector> vectors = {
+        {"www.example.com", "2ed6657d-e927-568b-95e1-2665a8aea6a2",
+         "5df41881-3aed-3515-88a7-2f4a814cf09e"},
+        {"", "4ebd0208-8328-5d69-8c44-ec50939c0967",
+         "c87ee674-4ddc-3efe-a74e-dfe25da5d7b3"},
+        {std::string(47, 'a'), "660c273c-8a00-5941-b6f4-8d0afed88966",
+         "f41abfa0-01e6-34a5-ad0c-0c9835688c00"},
+        {std::string(48, 'a'), "7280cc42-274a-5c4a-91fc-ae23f853eeb7",
+         "12adee6c-b187-318d-82d2-f934bf55422b"},
+        {std::string(100, 'a'), "56596f37-716c-57a9-a735-2561f8608390",
+         "9e765498-aa7f-338a-9c78-08f217cd658f"},
+        {"python.org", "886313e1-3b8a-5372-9b90-0c9aee199e5d",
+         "6fa459ea-ee8a-3ca4-894e-db77e160355e"}};
+
+    SUBCASE("v5")
+    {
+        for (const auto& v : vectors) {
+            auto g = xg::make_guid_v5(xg::namespace_dns, v.name);
+            CHECK(g.str() == v.v5);
+            CHECK(g.version() == 5);
+        }
+        CHECK(xg::make_guid_v5(xg::namespace_url, "https://example.com/") ==
+              xg::guid{"dd2c1780-811a-5296-81c5-178a0ef488bc"});
+    }
+    SUBCASE("v3")
+    {
+        for (const auto& v : vectors) {
+            auto g = xg::make_guid_v3(xg::namespace_dns, v.name);
+            CHECK(g.str() == v.v3);
+            CHECK(g.version() == 3);
+        }
+    }
+    SUBCASE("batch")
+    {
+        std::vector<std::string> names;
+        for (const auto& v : vectors) {
+            names.push_back(v.name);
+        }
+        for (std::size_t i = 0; i < 300; ++i) {
+            names.push_back(std::string(i, static_cast<char>('a' + i % 26)));
+        }
+
+        std::vector<xg::guid> batch;
+        xg::make_guids_v5(xg::namespace_dns, names.begin(), names.end(),
+                          std::back_inserter(batch));
+        REQUIRE(batch.size() == names.size());
+        for (std::size_t i = 0; i < names.size(); ++i) {
+            CHECK(batch[i] == xg::make_guid_v5(xg::namespace_dns, names[i]));
+        }
+        for (std::size_t i = 0; i < vectors.size(); ++i) {
+            CHECK(batch[i].str() == vectors[i].v5);
+        }
+    }
+    SUBCASE("batch from an input iterator")
+    {
+        // The names don't outlive the next increment
+        std::istringstream words{"alpha beta gamma delta"};
+        std::vector<xg::guid> batch;
+        xg::make_guids_v5(xg::namespace_dns,
+                          std::istream_iterator<std::string>{words},
+                          std::istream_iterator<std::string>{},
+                          std::back_inserter(batch));
+        REQUIRE(batch.size() == 4);
+        CHECK(batch[0] == xg::make_guid_v5(xg::namespace_dns, "alpha"));
+        CHECK(batch[1] == xg::make_guid_v5(xg::namespace_dns, "beta"));
+        CHECK(batch[2] == xg::make_guid_v5(xg::namespace_dns, "gamma"));
+        CHECK(batch[3] == xg::make_guid_v5(xg::namespace_dns, "delta"));
+    }
+}
+
 TEST_CASE("textual representation")
 {
     SUBCASE("str return")
@@ -100,6 +562,205 @@ TEST_CASE("textual representation")
     }
 }
 
+TEST_CASE("formatting")
+{
+    // The snprintf-based formatter that str_to replaced
+    auto reference = [](const xg::guid& g, bool upper, bool hyphens) {
+        const auto& b = g.bytes();
+        std::string s;
+        for (std::size_t i = 0; i < 16; ++i) {
+            if (hyphens && (i == 4 || i == 6 || i == 8 || i == 10)) {
+                s += '-';
+            }
+            char buf[3];
+            if (upper) {
+                std::snprintf(buf, 3, "%02X", b[i]);
+            }
+            else {
+                std::snprintf(buf, 3, "%02x", b[i]);
+            }
+            s.append(buf, 2);
+        }
+        return s;
+    };
+
+    std::vector<xg::guid> guids = {
+        xg::guid{},
+        xg::guid{std::array<unsigned char, 16>{
+            {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+             0xff, 0xff, 0xff, 0xff, 0xff}}},
+        xg::guid{std::array<unsigned char, 16>{
+            {0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef, 0xfe, 0xdc, 0xba,
+             0x98, 0x76, 0x54, 0x32, 0x10}}}};
+    for (int i = 0; i < 1000; ++i) {
+        guids.push_back(xg::make_guid());
+    }
+
+    SUBCASE("canonical")
+    {
+        for (const auto& g : guids) {
+            CHECK(g.str() == reference(g, false, true));
+            CHECK(g.str(xg::format_flags::none) == g.str());
+        }
+    }
+    SUBCASE("uppercase")
+    {
+        for (const auto& g : guids) {
+            CHECK(g.str(xg::format_flags::uppercase) ==
+                  reference(g, true, true));
+        }
+    }
+    SUBCASE("no hyphens")
+    {
+        for (const auto& g : guids) {
+            CHECK(g.str(xg::format_flags::no_hyphens) ==
+                  reference(g, false, false));
+            CHECK(g.str(xg::format_flags::uppercase |
+                        xg::format_flags::no_hyphens) ==
+                  reference(g, true, false));
+        }
+    }
+    SUBCASE("str_to")
+    {
+        const auto flags = xg::format_flags::no_hyphens;
+        CHECK(xg::formatted_size(flags) == 32);
+        CHECK(xg::formatted_size(xg::format_flags::uppercase) == 36);
+
+        std::string s;
+        guids[2].str_to(std::back_inserter(s), flags);
+        CHECK(s == "0123456789abcdeffedcba9876543210");
+
+        char buf[33] = {};
+        auto end = guids[2].str_to(buf, flags | xg::format_flags::uppercase);
+        CHECK(end == buf + 32);
+        CHECK(std::string{buf} == "0123456789ABCDEFFEDCBA9876543210");
+    }
+    SUBCASE("parse back")
+    {
+        for (const auto& g : guids) {
+            CHECK(xg::guid{g.str(xg::format_flags::uppercase).c_str()} == g);
+            CHECK(xg::guid{g.str(xg::format_flags::no_hyphens).c_str()} == g);
+            CHECK(xg::parse(g.str(xg::format_flags::braces),
+                            xg::parse_mode::braced)
+                      .value == g);
+        }
+    }
+    SUBCASE("braces")
+    {
+        const auto braces = xg::format_flags::braces;
+        CHECK(xg::formatted_size(braces) == 38);
+        CHECK(xg::formatted_size(braces | xg::format_flags::no_hyphens) ==
+              34);
+        for (const auto& g : guids) {
+            CHECK(g.str(braces) == "{" + g.str() + "}");
+            CHECK(g.str(braces | xg::format_flags::uppercase |
+                        xg::format_flags::no_hyphens) ==
+                  "{" + reference(g, true, false) + "}");
+        }
+    }
+    SUBCASE("streams")
+    {
+        std::ostringstream out;
+        for (const auto& g : guids) {
+            out << g << ' ';
+        }
+        std::istringstream in{out.str()};
+        for (const auto& g : guids) {
+            xg::guid read;
+            REQUIRE(in >> read);
+            CHECK(read == g);
+        }
+        xg::guid read;
+        CHECK(!(in >> read));
+        CHECK(in.eof());
+
+        out.str(std::string{});
+        out << std::uppercase << guids[2] << std::nouppercase << ' '
+            << std::setw(40) << std::setfill('*') << guids[2] << '|'
+            << std::left << std::setw(38) << guids[2] << '|'
+            << std::setw(10) << guids[2];
+        CHECK(out.str() ==
+              "01234567-89AB-CDEF-FEDC-BA9876543210 "
+              "****01234567-89ab-cdef-fedc-ba9876543210|"
+              "01234567-89ab-cdef-fedc-ba9876543210**|"
+              "01234567-89ab-cdef-fedc-ba9876543210");
+        // Streaming a GUID leaves the stream's state as it was
+        CHECK(out.fill() == '*');
+        out.str(std::string{});
+        out << std::setw(3) << 7;
+        CHECK(out.str() == "7**");
+
+        in.clear();
+        in.str("  {01234567-89ab-cdef-fedc-ba9876543210}\n"
+               "01234567-89AB-CDEF-FEDC-BA9876543210x");
+        xg::guid a, b;
+        char c;
+        CHECK(in >> a >> b >> c);
+        CHECK(a == guids[2]);
+        CHECK(b == guids[2]);
+        CHECK(c == 'x');
+
+        for (const char* bad :
+             {"01234567-89ab-cdef-fedc-ba987654321",
+              "0123456789abcdeffedcba9876543210aaaa",
+              "01234567-89ab-cdef-fedc-ba987654321g",
+              "{01234567-89ab-cdef-fedc-ba9876543210"}) {
+            std::istringstream bad_in{bad};
+            xg::guid g = guids[1];
+            CHECK(!(bad_in >> g));
+            CHECK(g == guids[1]);
+        }
+    }
+}
+
+TEST_CASE("format libraries")
+{
+    const xg::guid g{"01234567-89ab-cdef-fedc-ba9876543210"};
+
+#ifdef CROSSGUID_TEST_FMT
+    SUBCASE("fmt")
+    {
+        CHECK(fmt::format("{}", g) == g.str());
+        CHECK(fmt::format("{:x}", g) == g.str());
+        CHECK(fmt::format("{:X}", g) == "01234567-89AB-CDEF-FEDC-BA9876543210");
+        CHECK(fmt::format("{:n}", g) == "0123456789abcdeffedcba9876543210");
+        CHECK(fmt::format("{:b}", g) ==
+              "{01234567-89ab-cdef-fedc-ba9876543210}");
+        CHECK(fmt::format("id={:Xnb}.", g) ==
+              "id={0123456789ABCDEFFEDCBA9876543210}.");
+        CHECK_THROWS_AS(static_cast<void>(fmt::format(fmt::runtime("{:q}"), g)),
+                        fmt::format_error);
+    }
+#endif
+#if XG_HAS_STD_FORMAT
+    SUBCASE("std::format")
+    {
+        CHECK(std::format("{}", g) == g.str());
+        CHECK(std::format("{:X}", g) == "01234567-89AB-CDEF-FEDC-BA9876543210");
+        CHECK(std::format("{:nb}", g) == "{0123456789abcdeffedcba9876543210}");
+        CHECK_THROWS_AS(
+            static_cast<void>(std::vformat("{:q}", std::make_format_args(g))),
+            std::format_error);
+    }
+#endif
+    SUBCASE("format specs")
+    {
+        const char spec[] = "Xnb}";
+        auto flags = xg::format_flags::none;
+        bool valid = false;
+        CHECK(xg::detail::parse_format_spec(spec, spec + 4, flags, valid) ==
+              spec + 3);
+        CHECK(valid);
+        CHECK(flags == (xg::format_flags::uppercase |
+                        xg::format_flags::no_hyphens |
+                        xg::format_flags::braces));
+        const char bad[] = "xy}";
+        CHECK(xg::detail::parse_format_spec(bad, bad + 3, flags, valid) ==
+              bad + 1);
+        CHECK(!valid);
+    }
+}
+
 TEST_CASE("byte representation")
 {
     std::array<unsigned char, 16> bytes = {{0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
@@ -115,6 +776,69 @@ TEST_CASE("byte representation")
     CHECK(std::equal(from_bytes.data(), from_bytes.data() + 16, bytes.begin()));
 }
 
+TEST_CASE("Microsoft byte order")
+{
+    const xg::guid g{"00112233-4455-6677-8899-aabbccddeeff"};
+    // Like .NET new Guid("00112233-...").ToByteArray()
+    const std::array<unsigned char, 16> ms = {
+        {0x33, 0x22, 0x11, 0x00, 0x55, 0x44, 0x77, 0x66, 0x88, 0x99, 0xaa,
+         0xbb, 0xcc, 0xdd, 0xee, 0xff}};
+
+    SUBCASE("single")
+    {
+        CHECK(xg::to_ms_bytes(g) == ms);
+        CHECK(xg::from_ms_bytes(ms) == g);
+        CHECK(xg::from_ms_bytes(ms.data()) == g);
+        CHECK(xg::to_ms_bytes(xg::guid{}) == xg::guid{}.bytes());
+
+        const auto r = xg::make_guid();
+        CHECK(xg::from_ms_bytes(xg::to_ms_bytes(r)) == r);
+        CHECK(xg::from_ms_bytes(xg::to_ms_bytes(r)).version() == 4);
+#if XG_HAS_RELAXED_CONSTEXPR
+        static_assert(xg::to_ms_bytes(xg::guid{std::array<unsigned char, 16>{
+                          {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+                           16}}})[0] == 4,
+                      "converted at compile time");
+#endif
+    }
+
+    SUBCASE("batch")
+    {
+        // Every kernel's main loop and remainder
+        const std::size_t sizes[] = {0, 1, 2, 3, 4, 5, 7, 8, 9, 31, 33};
+        for (auto n : sizes) {
+            std::vector<xg::guid> guids(n);
+            xg::make_guids(guids.data(), n);
+            guids.push_back(g);
+
+            std::vector<unsigned char> bytes(16 * (n + 1) + 1, 0x5a);
+            xg::to_ms_bytes(guids.data(), n + 1, bytes.data());
+            for (std::size_t i = 0; i <= n; ++i) {
+                const auto expected = xg::to_ms_bytes(guids[i]);
+                CHECK(std::equal(expected.begin(), expected.end(),
+                                 bytes.begin() +
+                                     static_cast<std::ptrdiff_t>(16 * i)));
+            }
+            CHECK(std::equal(ms.begin(), ms.end(), bytes.end() - 17));
+            CHECK(bytes.back() == 0x5a);
+
+            std::vector<xg::guid> back(n + 2);
+            xg::from_ms_bytes(bytes.data(), n + 1, back.data());
+            CHECK(std::equal(guids.begin(), guids.end(), back.begin()));
+            CHECK(!back.back());
+
+            // In place
+            auto in_place = guids;
+            auto* p = static_cast<unsigned char*>(
+                static_cast<void*>(in_place.data()));
+            xg::to_ms_bytes(in_place.data(), n + 1, p);
+            CHECK(std::equal(p, p + 16 * (n + 1), bytes.begin()));
+            xg::from_ms_bytes(p, n + 1, in_place.data());
+            CHECK(in_place == guids);
+        }
+    }
+}
+
 TEST_CASE("misc operations")
 {
     SUBCASE("equality and swap")
@@ -132,6 +856,66 @@ TEST_CASE("misc operations")
         CHECK(first == fourth);
         CHECK(second == third);
         CHECK(first != second);
+
+        // Every byte takes part
+        for (std::size_t i = 0; i < 16; ++i) {
+            auto bytes = first.bytes();
+            bytes[i] = static_cast<unsigned char>(bytes[i] ^ 0x80);
+            CHECK(xg::guid{bytes} != first);
+            CHECK_FALSE(xg::guid{bytes} == first);
+        }
+    }
+    SUBCASE("ordering")
+    {
+        // Byte order, not the order of native integers
+        std::vector<xg::guid> guids(2000);
+        xg::make_guids(guids.data(), guids.size());
+        for (std::size_t i = 0; i < 16; ++i) {
+            std::array<unsigned char, 16> bytes{};
+            bytes[i] = 1;
+            guids.push_back(xg::guid{bytes});
+            bytes[i] = 0xff;
+            guids.push_back(xg::guid{bytes});
+        }
+        guids.push_back(guids[0]);
+        guids.push_back(xg::guid{});
+
+        for (std::size_t i = 0; i + 1 < guids.size(); ++i) {
+            const auto& a = guids[i];
+            const auto& b = guids[i + 1];
+            const bool less = a.bytes() < b.bytes();
+            CHECK((a < b) == less);
+            CHECK((b > a) == less);
+            CHECK((a >= b) == !less);
+            CHECK((b <= a) == !less);
+            CHECK(std::less<xg::guid>{}(a, b) == less);
+            CHECK_FALSE(a < a);
+            CHECK(a <= a);
+#if XG_HAS_THREE_WAY_COMPARISON
+            CHECK((a <=> b < 0) == less);
+            CHECK((a <=> a) == std::strong_ordering::equal);
+#endif
+        }
+
+        auto sorted = guids;
+        std::sort(sorted.begin(), sorted.end());
+        CHECK(std::is_sorted(sorted.begin(), sorted.end(),
+                             [](const xg::guid& a, const xg::guid& b) {
+                                 return a.bytes() < b.bytes();
+                             }));
+        CHECK(xg::guid{"00000000-0000-0000-0000-0000000000ff"} <
+              xg::guid{"01000000-0000-0000-0000-000000000000"});
+        CHECK(xg::guid{"00000000-0000-0000-0000-000000000001"} <
+              xg::guid{"00000000-0000-0000-0100-000000000000"});
+    }
+    SUBCASE("validity")
+    {
+        CHECK_FALSE(xg::guid{});
+        for (std::size_t i = 0; i < 16; ++i) {
+            std::array<unsigned char, 16> bytes{};
+            bytes[i] = 0x10;
+            CHECK(xg::guid{bytes});
+        }
     }
     SUBCASE("hashing")
     {
@@ -155,6 +939,1563 @@ TEST_CASE("misc operations")
     }
 }
 
+// Pearson's chi-squared over the low bits of the hashes, which is what a
+// power-of-two hash table uses
+template <typename Hash>
+static double chi_squared(const std::vector<xg::guid>& guids, Hash hash)
+{
+    const std::size_t buckets = 1024;
+    std::vector<double> counts(buckets);
+    for (const auto& g : guids) {
+        counts[hash(g) & (buckets - 1)] += 1;
+    }
+    const double expected =
+        static_cast<double>(guids.size()) / static_cast<double>(buckets);
+    double sum = 0;
+    for (auto c : counts) {
+        sum += (c - expected) * (c - expected) / expected;
+    }
+    return sum;
+}
+
+TEST_CASE("hash quality")
+{
+    // 1023 degrees of freedom: the mean is 1023, and 1200 is far in the
+    // tail
+    const double limit = 1200;
+
+    SUBCASE("avalanche")
+    {
+        // Flipping any input bit should flip every output bit with
+        // probability 1/2
+        const std::size_t rounds = 200;
+        const std::size_t out_bits = sizeof(std::size_t) * 8;
+        std::vector<xg::guid> inputs(rounds);
+        xg::make_guids(inputs.data(), inputs.size());
+
+        for (std::size_t in_bit = 0; in_bit < 128; ++in_bit) {
+            std::vector<std::size_t> flips(out_bits);
+            for (const auto& g : inputs) {
+                auto bytes = g.bytes();
+                bytes[in_bit / 8] = static_cast<unsigned char>(
+                    bytes[in_bit / 8] ^ (1u << (in_bit % 8)));
+                const auto diff = xg::mix_hash{}(g) ^
+                                  xg::mix_hash{}(xg::guid{bytes});
+                for (std::size_t o = 0; o < out_bits; ++o) {
+                    flips[o] += (diff >> o) & 1;
+                }
+            }
+            for (auto f : flips) {
+                const double p =
+                    static_cast<double>(f) / static_cast<double>(rounds);
+                CHECK(p > 0.3);
+                CHECK(p < 0.7);
+            }
+        }
+    }
+    SUBCASE("distribution")
+    {
+        std::vector<xg::guid> random(1 << 16);
+        xg::make_guids(random.data(), random.size());
+        CHECK(chi_squared(random, xg::fold_hash{}) < limit);
+        CHECK(chi_squared(random, xg::mix_hash{}) < limit);
+        CHECK(chi_squared(random, std::hash<xg::guid>{}) < limit);
+
+        // Time-ordered GUIDs share most of their bits
+        std::vector<xg::guid> ordered(1 << 16);
+        for (auto& g : ordered) {
+            g = xg::make_guid_v7();
+        }
+        CHECK(chi_squared(ordered, xg::mix_hash{}) < limit);
+
+        // Consecutive counters in the last byte, the worst case of a
+        // hash table keyed on the low bits
+        std::vector<xg::guid> sequential(1 << 16);
+        for (std::size_t i = 0; i < sequential.size(); ++i) {
+            std::array<unsigned char, 16> bytes{};
+            bytes[14] = static_cast<unsigned char>(i >> 8);
+            bytes[15] = static_cast<unsigned char>(i);
+            sequential[i] = xg::guid{bytes};
+        }
+        CHECK(chi_squared(sequential, xg::mix_hash{}) < limit);
+    }
+    SUBCASE("as a container hash")
+    {
+        auto g1 = xg::make_guid();
+        auto g2 = xg::make_guid();
+        std::unordered_map<xg::guid, int, xg::fold_hash> m = {{g1, 1},
+                                                              {g2, 2}};
+        CHECK(m.at(g1) == 1);
+        CHECK(m.at(g2) == 2);
+        CHECK(m.find(xg::make_guid()) == m.end());
+    }
+}
+
+TEST_CASE("guid_map")
+{
+    SUBCASE("insert and find")
+    {
+        xg::guid_map<int> m;
+        CHECK(m.empty());
+        CHECK(m.find(xg::make_guid()) == m.end());
+        CHECK(m.begin() == m.end());
+
+        std::vector<xg::guid> keys(1000);
+        xg::make_guids(keys.data(), keys.size());
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            auto r = m.insert({keys[i], static_cast<int>(i)});
+            CHECK(r.second);
+            CHECK(r.first->first == keys[i]);
+        }
+        CHECK(m.size() == keys.size());
+        CHECK(m.load_factor() <= m.max_load_factor());
+
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            auto it = m.find(keys[i]);
+            REQUIRE(it != m.end());
+            CHECK(it->second == static_cast<int>(i));
+        }
+        CHECK_FALSE(m.insert({keys[0], -1}).second);
+        CHECK(m.at(keys[0]) == 0);
+        CHECK_THROWS_AS(m.at(xg::make_guid()), std::out_of_range);
+        CHECK(std::distance(m.begin(), m.end()) ==
+              static_cast<std::ptrdiff_t>(keys.size()));
+
+        m[keys[1]] = 42;
+        CHECK(m.at(keys[1]) == 42);
+        CHECK_FALSE(m.insert_or_assign(keys[2], 43).second);
+        CHECK(m.at(keys[2]) == 43);
+        const auto g = xg::make_guid();
+        CHECK(m[g] == 0);
+        CHECK(m.size() == keys.size() + 1);
+    }
+    SUBCASE("string lookup")
+    {
+        const xg::guid g{"c405c66c-ccbb-4ffd-9b62-c286c0fd7a3b"};
+        xg::guid_map<int> m = {{g, 1}};
+
+        CHECK(m.find("c405c66c-ccbb-4ffd-9b62-c286c0fd7a3b") == m.begin());
+        CHECK(m.contains(std::string{"c405c66cccbb4ffd9b62c286c0fd7a3b"}));
+        CHECK(m.count("C405C66C-CCBB-4FFD-9B62-C286C0FD7A3B") == 1);
+        CHECK_FALSE(m.contains("c405c66c-ccbb-4ffd-9b62-c286c0fd7a3c"));
+        CHECK_FALSE(m.contains("not a guid"));
+        // The nil GUID is a key like any other, unlike invalid input
+        m[xg::guid{}] = 2;
+        CHECK(m.find("00000000-0000-0000-0000-000000000000")->second == 2);
+        CHECK(m.find("zz") == m.end());
+    }
+    SUBCASE("against std::unordered_map")
+    {
+        // Random inserts and erases from a small key space, so that
+        // tombstones and in-place rehashes happen all the time
+        std::vector<xg::guid> keys(300);
+        xg::make_guids(keys.data(), keys.size());
+        std::mt19937 rng{42};
+        std::uniform_int_distribution<std::size_t> pick(0, keys.size() - 1);
+
+        xg::guid_map<std::string, xg::mix_hash> m;
+        std::unordered_map<xg::guid, std::string> ref;
+        for (int i = 0; i < 100000; ++i) {
+            const auto& k = keys[pick(rng)];
+            if (rng() % 3 == 0) {
+                CHECK(m.erase(k) == ref.erase(k));
+            }
+            else {
+                const auto v = std::to_string(i);
+                CHECK(m.try_emplace(k, v).second ==
+                      ref.emplace(k, v).second);
+            }
+        }
+        REQUIRE(m.size() == ref.size());
+        for (const auto& e : m) {
+            auto it = ref.find(e.first);
+            REQUIRE(it != ref.end());
+            CHECK(it->second == e.second);
+        }
+
+        // Erase while iterating
+        for (auto it = m.begin(); it != m.end();) {
+            it = it->second.size() % 2 == 0 ? m.erase(it) : std::next(it);
+        }
+        for (const auto& e : m) {
+            CHECK(e.second.size() % 2 == 1);
+        }
+    }
+    SUBCASE("reserve, copy and move")
+    {
+        xg::guid_map<std::unique_ptr<int>> m;
+        m.reserve(1000);
+        const auto capacity = m.capacity();
+        CHECK(capacity >= 1000);
+        for (int i = 0; i < 1000; ++i) {
+            m.try_emplace(xg::make_guid(), new int{i});
+        }
+        CHECK(m.capacity() == capacity);
+
+        auto moved = std::move(m);
+        CHECK(moved.size() == 1000);
+        CHECK(m.empty());
+        CHECK(m.begin() == m.end());
+        m.clear();
+        moved.clear();
+        CHECK(moved.empty());
+        CHECK(moved.capacity() == capacity);
+
+        xg::guid_map<int> a = {{xg::make_guid(), 1}, {xg::make_guid(), 2}};
+        auto b = a;
+        CHECK(b.size() == 2);
+        for (const auto& e : a) {
+            CHECK(b.at(e.first) == e.second);
+        }
+    }
+}
+
+TEST_CASE("guid_set")
+{
+    std::vector<xg::guid> keys(1000);
+    xg::make_guids(keys.data(), keys.size());
+    xg::guid_set<> s;
+    s.insert(keys.begin(), keys.end());
+    s.insert(keys.begin(), keys.end());
+    CHECK(s.size() == keys.size());
+    for (const auto& k : keys) {
+        CHECK(s.contains(k));
+    }
+    CHECK(s.contains(keys[0].str()));
+    CHECK(s.erase(keys[0]) == 1);
+    CHECK(s.erase(keys[0]) == 0);
+    CHECK_FALSE(s.contains(keys[0]));
+    static_assert(std::is_same<decltype(*s.begin()), const xg::guid&>::value,
+                  "guid_set elements must be immutable");
+}
+
+// Tries every offset, for comparison with xg::scan
+static std::vector<xg::scan_match> reference_scan(const std::string& text)
+{
+    auto is_hex = [](char ch) {
+        return std::isxdigit(static_cast<unsigned char>(ch)) != 0;
+    };
+    std::vector<xg::scan_match> matches;
+    for (std::size_t i = 0; i + 36 <= text.size(); ++i) {
+        bool ok = (i == 0 || !is_hex(text[i - 1])) &&
+                  (i + 36 == text.size() || !is_hex(text[i + 36]));
+        for (std::size_t j = 0; ok && j < 36; ++j) {
+            const bool hyphen = j == 8 || j == 13 || j == 18 || j == 23;
+            ok = hyphen ? text[i + j] == '-' : is_hex(text[i + j]);
+        }
+        if (ok) {
+            matches.push_back({xg::guid{text.substr(i, 36).c_str()}, i});
+            i += 35;
+        }
+    }
+    return matches;
+}
+
+static bool same_matches(const std::vector<xg::scan_match>& a,
+                         const std::vector<xg::scan_match>& b)
+{
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(),
+                      [](const xg::scan_match& x, const xg::scan_match& y) {
+                          return x.value == y.value && x.offset == y.offset;
+                      });
+}
+
+TEST_CASE("scan")
+{
+    // Log-like text with GUIDs, near misses, and lots of hyphens
+    std::mt19937 rng{7};
+    std::string text;
+    while (text.size() < 200000) {
+        auto g = xg::make_guid().str();
+        switch (rng() % 8) {
+            case 0:
+                text += "2024-01-02 12:00:00 request ";
+                break;
+            case 1:
+                std::transform(g.begin(), g.end(), g.begin(), [](char ch) {
+                    return static_cast<char>(
+                        std::toupper(static_cast<unsigned char>(ch)));
+                });
+                break;
+            case 2:
+                // Part of a longer run of hex digits
+                g = "a" + g;
+                break;
+            case 3:
+                g[rng() % g.size()] = 'x';
+                break;
+            case 4:
+                g.erase(rng() % g.size(), 1);
+                break;
+            case 5:
+                text += "--------";
+                break;
+            default:
+                break;
+        }
+        text += g;
+        text += " \n-,{"[rng() % 5];
+    }
+
+    const auto expected = reference_scan(text);
+    REQUIRE(expected.size() > 1000);
+
+    SUBCASE("serial")
+    {
+        CHECK(same_matches(xg::scan(text.data(), text.data() + text.size()),
+                           expected));
+
+        std::vector<xg::scan_match> each;
+        xg::scan_each(text.data(), text.data() + text.size(),
+                      [&each](const xg::scan_match& m) { each.push_back(m); });
+        CHECK(same_matches(each, expected));
+    }
+    SUBCASE("parallel")
+    {
+        // Small chunks, so that many GUIDs cross chunk boundaries
+        for (std::size_t chunk : {1u, 37u, 100u, 4096u}) {
+            xg::scan_options options;
+            options.threads = 4;
+            options.chunk_size = chunk;
+            CHECK(same_matches(
+                xg::scan(text.data(), text.data() + text.size(), options),
+                expected));
+        }
+    }
+    SUBCASE("edges")
+    {
+        // Exactly sized heap buffers, so that AddressSanitizer catches any
+        // read past the end
+        const std::string g = xg::make_guid().str();
+        for (std::size_t pad = 0; pad < 80; ++pad) {
+            const std::string s = std::string(pad, ' ') + g;
+            std::unique_ptr<char[]> buf{new char[s.size()]};
+            std::copy(s.begin(), s.end(), buf.get());
+            const auto m = xg::scan(buf.get(), buf.get() + s.size());
+            REQUIRE(m.size() == 1);
+            CHECK(m[0].offset == pad);
+            CHECK(m[0].value == xg::guid{g.c_str()});
+            CHECK(xg::scan(buf.get(), buf.get() + s.size() - 1).empty());
+        }
+        CHECK(xg::scan(text.data(), text.data()).empty());
+    }
+    SUBCASE("mapped file")
+    {
+        const char* path = "crossguid_scan_test.txt";
+        {
+            std::ofstream out(path, std::ios::binary);
+            out << text;
+        }
+        {
+            const xg::mapped_file file{path};
+            REQUIRE(file.size() == text.size());
+            CHECK(same_matches(xg::scan(file.begin(), file.end()), expected));
+        }
+        std::remove(path);
+
+        CHECK_THROWS_AS(xg::mapped_file{"does/not/exist"}, std::system_error);
+    }
+}
+
+TEST_CASE("compact encodings")
+{
+    const xg::encoding encodings[] = {xg::encoding::base64url,
+                                      xg::encoding::base32,
+                                      xg::encoding::base58};
+
+    SUBCASE("known values")
+    {
+        struct known {
+            const char* canonical;
+            const char* base64url;
+            const char* base32;
+            const char* base58;
+        };
+        const known values[] = {
+            {"7bcd757f-5b10-4f9b-af69-1a1f226f3b3e", "e811f1sQT5uvaRofIm87Pg",
+             "3VSNTQYPRG9YDTYT8T3WH6YESY", "GHgioTMYZtpdudW67ajc1s"},
+            {"ffffffff-ffff-ffff-ffff-ffffffffffff", "_____________________w",
+             "7ZZZZZZZZZZZZZZZZZZZZZZZZZ", "YcVfxkQb6JRzqk5kF2tNLv"},
+            {"00000000-0000-0000-0000-000000000001", "AAAAAAAAAAAAAAAAAAAAAQ",
+             "00000000000000000000000001", "1111111111111111111112"},
+            {"00000000-0000-0000-0000-000000000000", "AAAAAAAAAAAAAAAAAAAAAA",
+             "00000000000000000000000000", "1111111111111111111111"},
+        };
+        for (const auto& v : values) {
+            const xg::guid g{v.canonical};
+            CHECK(xg::encode(g, xg::encoding::base64url) == v.base64url);
+            CHECK(xg::encode(g, xg::encoding::base32) == v.base32);
+            CHECK(xg::encode(g, xg::encoding::base58) == v.base58);
+            CHECK(xg::decode(std::string{v.base64url},
+                             xg::encoding::base64url)
+                      .value == g);
+            CHECK(xg::decode(std::string{v.base32}, xg::encoding::base32)
+                      .value == g);
+            CHECK(xg::decode(std::string{v.base58}, xg::encoding::base58)
+                      .value == g);
+        }
+    }
+    SUBCASE("round trip")
+    {
+        std::vector<xg::guid> guids(10000);
+        xg::make_guids(guids.data(), guids.size());
+        guids.push_back(xg::guid{});
+        for (auto e : encodings) {
+            for (const auto& g : guids) {
+                std::string s;
+                xg::encode_to(g, e, std::back_inserter(s));
+                REQUIRE(s.size() == xg::encoded_size(e));
+                const auto r = xg::decode(s, e);
+                REQUIRE(r);
+                CHECK(r.value.bytes() == g.bytes());
+                CHECK(r.ptr == s.data() + s.size());
+            }
+        }
+    }
+    SUBCASE("order")
+    {
+        std::vector<xg::guid> guids(1000);
+        xg::make_guids(guids.data(), guids.size());
+        std::sort(guids.begin(), guids.end(),
+                  [](const xg::guid& a, const xg::guid& b) {
+                      return a.bytes() < b.bytes();
+                  });
+        for (auto e : {xg::encoding::base32, xg::encoding::base58}) {
+            std::vector<std::string> encoded;
+            for (const auto& g : guids) {
+                encoded.push_back(xg::encode(g, e));
+            }
+            CHECK(std::is_sorted(encoded.begin(), encoded.end()));
+        }
+    }
+    SUBCASE("invalid")
+    {
+        const auto g = xg::make_guid();
+        for (auto e : encodings) {
+            const auto s = xg::encode(g, e);
+            for (std::size_t i = 0; i < s.size(); ++i) {
+                for (char ch : {'!', '=', '+', '/', ' ', '\0', '\x80'}) {
+                    auto t = s;
+                    t[i] = ch;
+                    const auto r = xg::decode(t, e);
+                    CHECK_FALSE(r);
+                    CHECK(r.ptr == t.data());
+                    CHECK(r.value == xg::guid{});
+                }
+            }
+            CHECK_FALSE(xg::decode(s.substr(0, s.size() - 1), e));
+            CHECK_FALSE(xg::decode(std::string{}, e));
+
+            // Anything can follow
+            const auto t = s + "-suffix";
+            const auto r = xg::decode(t, e);
+            CHECK(r.value == g);
+            CHECK(r.ptr == t.data() + s.size());
+        }
+
+        // Nonzero unused bits
+        CHECK_FALSE(xg::decode(std::string{"AAAAAAAAAAAAAAAAAAAAAB"},
+                               xg::encoding::base64url));
+        CHECK_FALSE(xg::decode(std::string{"AAAAAAAAAAAAAAAAAAAAA="},
+                               xg::encoding::base64url));
+        // Above 128 bits
+        CHECK_FALSE(xg::decode(std::string{"80000000000000000000000000"},
+                               xg::encoding::base32));
+        CHECK_FALSE(xg::decode(std::string{"YcVfxkQb6JRzqk5kF2tNLw"},
+                               xg::encoding::base58));
+        CHECK_FALSE(xg::decode(std::string{"zzzzzzzzzzzzzzzzzzzzzz"},
+                               xg::encoding::base58));
+        CHECK_FALSE(xg::decode(std::string{"0000000000000U000000000000"},
+                               xg::encoding::base32));
+        // Characters outside the base58 alphabet
+        for (const char* s :
+             {"0111111111111111111111", "I111111111111111111111",
+              "O111111111111111111111", "l111111111111111111111"}) {
+            CHECK_FALSE(xg::decode(std::string{s}, xg::encoding::base58));
+        }
+    }
+    SUBCASE("crockford aliases")
+    {
+        const xg::guid g{"7bcd757f-5b10-4f9b-af69-1a1f226f3b3e"};
+        CHECK(xg::decode(std::string{"3vsntqyprg9ydtyt8t3wh6yesy"},
+                         xg::encoding::base32)
+                  .value == g);
+        const xg::guid one{"00000000-0000-0000-0000-000000000001"};
+        for (const char* s :
+             {"0000000000000000000000000I", "0000000000000000000000000i",
+              "0000000000000000000000000L", "O000000000000000000000000l"}) {
+            CHECK(xg::decode(std::string{s}, xg::encoding::base32).value ==
+                  one);
+        }
+    }
+}
+
+TEST_CASE("batch conversion")
+{
+    std::vector<xg::guid> guids(1003);
+    for (auto& g : guids) {
+        g = xg::make_guid();
+    }
+
+    // Fixed-width rows with some padding after each GUID
+    const std::size_t stride = 40;
+    std::string text(guids.size() * stride, ' ');
+    for (std::size_t i = 0; i < guids.size(); ++i) {
+        guids[i].str_to(text.begin() + static_cast<std::ptrdiff_t>(i * stride));
+    }
+    // Some invalid rows
+    for (std::size_t i : {0u, 9u, 500u, 1002u}) {
+        text[i * stride + 13] = 'x';
+    }
+    const auto is_valid = [](std::size_t i) {
+        return i != 0 && i != 9 && i != 500 && i != 1002;
+    };
+
+    SUBCASE("parse")
+    {
+        std::vector<xg::guid> out(guids.size(), xg::make_guid());
+        std::vector<std::uint8_t> valid((guids.size() + 7) / 8, 0xff);
+        CHECK(xg::parse_batch(text.data(), stride, guids.size(), out.data(),
+                              valid.data()) == guids.size() - 4);
+        for (std::size_t i = 0; i < guids.size(); ++i) {
+            const bool bit = ((valid[i / 8] >> (i % 8)) & 1) != 0;
+            CHECK(bit == is_valid(i));
+            CHECK(out[i] == (is_valid(i) ? guids[i] : xg::guid{}));
+        }
+        // Bits past the last row are cleared
+        CHECK((valid.back() >> (guids.size() % 8)) == 0);
+
+        // Without a bitmap
+        std::vector<xg::guid> out2(guids.size());
+        CHECK(xg::parse_batch(text.data(), stride, guids.size(),
+                              out2.data()) == guids.size() - 4);
+        CHECK(out2 == out);
+    }
+    SUBCASE("parallel")
+    {
+        std::vector<xg::guid> serial(guids.size());
+        std::vector<std::uint8_t> serial_valid((guids.size() + 7) / 8);
+        xg::parse_batch(text.data(), stride, guids.size(), serial.data(),
+                        serial_valid.data());
+
+        xg::batch_options options;
+        options.threads = 4;
+        options.rows_per_task = 5;
+        std::vector<xg::guid> out(guids.size());
+        std::vector<std::uint8_t> valid((guids.size() + 7) / 8);
+        CHECK(xg::parse_batch(text.data(), stride, guids.size(), out.data(),
+                              valid.data(), options) == guids.size() - 4);
+        CHECK(out == serial);
+        CHECK(valid == serial_valid);
+
+        std::string formatted(guids.size() * 36, ' ');
+        xg::format_batch(guids.data(), guids.size(), &formatted[0], 36,
+                         xg::format_flags::none, options);
+        for (std::size_t i = 0; i < guids.size(); ++i) {
+            CHECK(formatted.compare(i * 36, 36, guids[i].str()) == 0);
+        }
+    }
+    SUBCASE("format")
+    {
+        for (auto flags :
+             {xg::format_flags::none, xg::format_flags::uppercase,
+              xg::format_flags::no_hyphens,
+              xg::format_flags::uppercase | xg::format_flags::no_hyphens,
+              xg::format_flags::braces,
+              xg::format_flags::braces | xg::format_flags::no_hyphens}) {
+            const auto width = xg::formatted_size(flags);
+            // Exactly sized, so that AddressSanitizer catches any write past
+            // the end
+            std::unique_ptr<char[]> buf{new char[guids.size() * width]};
+            xg::format_batch(guids.data(), guids.size(), buf.get(), width,
+                             flags);
+            for (std::size_t i = 0; i < guids.size(); ++i) {
+                CHECK(std::string(buf.get() + i * width, width) ==
+                      guids[i].str(flags));
+            }
+            if ((flags & (xg::format_flags::no_hyphens |
+                          xg::format_flags::braces)) ==
+                xg::format_flags::none) {
+                std::vector<xg::guid> back(guids.size());
+                CHECK(xg::parse_batch(buf.get(), width, guids.size(),
+                                      back.data()) == guids.size());
+                CHECK(back == guids);
+            }
+        }
+    }
+    SUBCASE("empty")
+    {
+        CHECK(xg::parse_batch(text.data(), stride, 0, nullptr) == 0);
+        xg::format_batch(guids.data(), 0, nullptr, 36);
+    }
+}
+
+TEST_CASE("batch search")
+{
+    std::vector<xg::guid> guids(67);
+    xg::make_guids(guids.data(), guids.size());
+    const auto other = xg::make_guid();
+
+    // Every length and position, so that both the vectorized part and the
+    // tail are covered
+    for (std::size_t n = 0; n <= guids.size(); ++n) {
+        const auto* first = guids.data();
+        const auto* last = first + n;
+        CHECK(xg::find(first, last, other) == last);
+        CHECK(xg::count(first, last, other) == 0);
+        for (std::size_t i = 0; i < n; ++i) {
+            CHECK(xg::find(first, last, guids[i]) == first + i);
+            CHECK(xg::count(first, last, guids[i]) == 1);
+        }
+    }
+
+    // Half matches don't count
+    auto near = guids;
+    for (std::size_t i = 0; i < near.size(); ++i) {
+        auto bytes = other.bytes();
+        const std::size_t j = i % 2 == 0 ? 3 : 12;
+        bytes[j] = static_cast<unsigned char>(~bytes[j]);
+        near[i] = xg::guid{bytes};
+    }
+    CHECK(xg::find(near.data(), near.data() + near.size(), other) ==
+          near.data() + near.size());
+    CHECK(xg::count(near.data(), near.data() + near.size(), other) == 0);
+
+    // Duplicates
+    for (std::size_t i = 5; i < near.size(); i += 7) {
+        near[i] = other;
+    }
+    CHECK(xg::find(near.data(), near.data() + near.size(), other) ==
+          near.data() + 5);
+    CHECK(xg::count(near.data(), near.data() + near.size(), other) ==
+          static_cast<std::size_t>(
+              std::count(near.begin(), near.end(), other)));
+}
+
+TEST_CASE("sort")
+{
+    const auto check_sort = [](std::vector<xg::guid> v) {
+        auto expected = v;
+        std::sort(expected.begin(), expected.end(),
+                  [](const xg::guid& a, const xg::guid& b) {
+                      return a.bytes() < b.bytes();
+                  });
+        for (unsigned threads : {1u, 4u}) {
+            for (bool in_place : {false, true}) {
+                auto sorted = v;
+                xg::sort_options options;
+                options.threads = threads;
+                options.in_place = in_place;
+                xg::sort(sorted.data(), sorted.data() + sorted.size(),
+                         options);
+                CHECK(sorted == expected);
+            }
+        }
+    };
+
+    SUBCASE("random")
+    {
+        for (std::size_t n : {0u, 1u, 2u, 100u, 257u, 5000u, 300000u}) {
+            std::vector<xg::guid> v(n);
+            xg::make_guids(v.data(), v.size());
+            check_sort(v);
+        }
+    }
+    SUBCASE("duplicates")
+    {
+        std::vector<xg::guid> v(1000);
+        xg::make_guids(v.data(), v.size());
+        std::mt19937 rng{3};
+        for (std::size_t i = 0; i < 200000; ++i) {
+            v.push_back(v[rng() % 1000]);
+        }
+        v.push_back(xg::guid{});
+        check_sort(v);
+    }
+    SUBCASE("shared prefixes")
+    {
+        // Bytes that are the same in every GUID are skipped, and an odd
+        // number of passes ends in the buffer
+        std::mt19937 rng{4};
+        for (std::size_t varying : {1u, 2u, 3u, 15u}) {
+            std::vector<xg::guid> v(200000);
+            for (auto& g : v) {
+                std::array<unsigned char, 16> bytes{};
+                for (std::size_t k = 16 - varying; k < 16; ++k) {
+                    bytes[k] = static_cast<unsigned char>(rng());
+                }
+                g = xg::guid{bytes};
+            }
+            check_sort(v);
+        }
+
+        std::vector<xg::guid> v(100000);
+        for (auto& g : v) {
+            g = xg::make_guid_v7();
+        }
+        std::shuffle(v.begin(), v.end(), rng);
+        check_sort(v);
+    }
+}
+
+TEST_CASE("guid_index")
+{
+    const auto check_index = [](const xg::guid_index& index,
+                                std::vector<xg::guid> sorted) {
+        std::sort(sorted.begin(), sorted.end());
+        sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+        REQUIRE(index.size() == sorted.size());
+        CHECK(std::equal(index.begin(), index.end(), sorted.begin()));
+        CHECK(std::distance(index.begin(), index.end()) ==
+              static_cast<std::ptrdiff_t>(sorted.size()));
+
+        std::vector<xg::guid> reversed(sorted.size());
+        std::reverse_copy(index.begin(), index.end(), reversed.begin());
+        std::reverse(reversed.begin(), reversed.end());
+        CHECK(reversed == sorted);
+
+        for (const auto& g : sorted) {
+            CHECK(index.contains(g));
+            CHECK(*index.find(g) == g);
+            CHECK(*index.lower_bound(g) == g);
+        }
+        std::vector<xg::guid> others(100);
+        xg::make_guids(others.data(), others.size());
+        others.push_back(xg::guid{});
+        others.push_back(xg::guid{std::array<unsigned char, 16>{
+            {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+             0xff, 0xff, 0xff, 0xff, 0xff, 0xff}}});
+        others.insert(others.end(), sorted.begin(), sorted.end());
+        for (const auto& g : others) {
+            const auto lower =
+                std::lower_bound(sorted.begin(), sorted.end(), g);
+            const auto upper =
+                std::upper_bound(sorted.begin(), sorted.end(), g);
+            CHECK(index.contains(g) == (lower != upper));
+            CHECK(std::distance(index.begin(), index.lower_bound(g)) ==
+                  lower - sorted.begin());
+            CHECK(std::distance(index.begin(), index.upper_bound(g)) ==
+                  upper - sorted.begin());
+            CHECK((index.find(g) == index.end()) == (lower == upper));
+        }
+    };
+
+    SUBCASE("sizes")
+    {
+        for (std::size_t n : {0u, 1u, 2u, 3u, 4u, 5u, 7u, 8u, 15u, 16u, 17u,
+                              100u, 1000u, 4097u}) {
+            std::vector<xg::guid> v(n);
+            xg::make_guids(v.data(), v.size());
+            check_index(xg::guid_index{v.begin(), v.end()}, v);
+        }
+    }
+    SUBCASE("duplicates")
+    {
+        std::vector<xg::guid> v(50);
+        xg::make_guids(v.data(), v.size());
+        for (std::size_t i = 0; i < 200; ++i) {
+            v.push_back(v[i % 50]);
+        }
+        const xg::guid_index index{v};
+        CHECK(index.size() == 50);
+        check_index(index, v);
+    }
+    SUBCASE("iterators")
+    {
+        const xg::guid a{"00000000-0000-0000-0000-000000000001"};
+        const xg::guid b{"00000000-0000-0000-0000-000000000002"};
+        const xg::guid c{"00000000-0000-0000-0000-000000000003"};
+        const xg::guid_index index{c, a, b, a};
+        CHECK(index.size() == 3);
+        auto it = index.begin();
+        CHECK(*it++ == a);
+        CHECK(*it == b);
+        CHECK(*++it == c);
+        CHECK(++it == index.end());
+        CHECK(*--it == c);
+        CHECK(*std::prev(index.end(), 3) == a);
+
+        const xg::guid_index empty;
+        CHECK(empty.empty());
+        CHECK(empty.begin() == empty.end());
+        CHECK(!empty.contains(a));
+        CHECK(empty.lower_bound(a) == empty.end());
+    }
+    SUBCASE("copy and move")
+    {
+        std::vector<xg::guid> v(1000);
+        xg::make_guids(v.data(), v.size());
+        const xg::guid_index index{v};
+        xg::guid_index copy{index};
+        check_index(copy, v);
+        xg::guid_index moved{std::move(copy)};
+        CHECK(copy.empty());
+        check_index(moved, v);
+        copy = moved;
+        check_index(copy, v);
+    }
+    SUBCASE("save and load")
+    {
+        for (std::size_t n : {0u, 1u, 1000u}) {
+            std::vector<xg::guid> v(n);
+            xg::make_guids(v.data(), v.size());
+            const xg::guid_index index{v};
+            std::stringstream stream;
+            index.save(stream);
+            const std::string saved = stream.str();
+            CHECK(saved.size() == 32 + 16 * n);
+
+            check_index(xg::guid_index::load(stream), v);
+            check_index(xg::guid_index::load(saved.data(), saved.size()), v);
+
+            CHECK_THROWS_AS(
+                xg::guid_index::load(saved.data(), saved.size() - 1),
+                std::system_error);
+            std::istringstream truncated{saved.substr(0, saved.size() - 1)};
+            CHECK_THROWS_AS(xg::guid_index::load(truncated),
+                            std::system_error);
+        }
+        std::string garbage(64, 'x');
+        CHECK_THROWS_AS(xg::guid_index::load(garbage.data(), garbage.size()),
+                        std::system_error);
+        CHECK_THROWS_AS(xg::guid_index::load(garbage.data(), 10),
+                        std::system_error);
+
+        // A count far larger than the data isn't allocated up front
+        std::stringstream stream;
+        xg::guid_index{xg::make_guid()}.save(stream);
+        std::string corrupt = stream.str();
+        corrupt[16 + 5] = '\x01';
+        std::istringstream in{corrupt};
+        CHECK_THROWS_AS(xg::guid_index::load(in), std::system_error);
+    }
+}
+
+template <typename Filter>
+static double false_positive_rate(const Filter& filter,
+                                  const xg::guid* first,
+                                  const xg::guid* last)
+{
+    std::size_t n = 0;
+    for (auto it = first; it != last; ++it) {
+        n += filter.may_contain(*it);
+    }
+    return static_cast<double>(n) / static_cast<double>(last - first);
+}
+
+TEST_CASE("membership filters")
+{
+    // Random and time-ordered GUIDs, which the filters hash differently
+    std::vector<xg::guid> in(20000);
+    xg::make_guids(in.data(), 10000);
+    for (std::size_t i = 10000; i < in.size(); ++i) {
+        in[i] = xg::make_guid_v7();
+    }
+    std::vector<xg::guid> out(20000);
+    xg::make_guids(out.data(), 10000);
+    for (std::size_t i = 10000; i < out.size(); ++i) {
+        out[i] = xg::make_guid_v7();
+    }
+
+    SUBCASE("Bloom filter")
+    {
+        xg::guid_bloom_filter filter{in.size()};
+        CHECK(filter.block_count() == (in.size() * 10 + 511) / 512);
+        CHECK(filter.size_in_bytes() == 64 * filter.block_count());
+        for (const auto& g : in) {
+            filter.insert(g);
+        }
+        CHECK(std::all_of(in.begin(), in.end(), [&](const xg::guid& g) {
+            return filter.may_contain(g);
+        }));
+        const auto* o = out.data();
+        CHECK(false_positive_rate(filter, o, o + 10000) < 0.02);
+        CHECK(false_positive_rate(filter, o + 10000, o + 20000) < 0.02);
+
+        // Inserting a range sets the same bits
+        xg::guid_bloom_filter bulk{in.size()};
+        bulk.insert(in.data(), in.data() + in.size());
+        std::ostringstream a, b;
+        filter.save(a);
+        bulk.save(b);
+        CHECK(a.str() == b.str());
+
+        filter.clear();
+        CHECK(filter.block_count() == bulk.block_count());
+        CHECK(!filter.may_contain(in[0]));
+
+        const xg::guid_bloom_filter empty;
+        CHECK(empty.block_count() == 0);
+        CHECK(!empty.may_contain(in[0]));
+        const xg::guid_bloom_filter tiny{0};
+        CHECK(tiny.block_count() == 1);
+    }
+    SUBCASE("Bloom filter copy, move, save and load")
+    {
+        xg::guid_bloom_filter filter{1000};
+        filter.insert(in.data(), in.data() + 1000);
+        const auto check = [&](const xg::guid_bloom_filter& f) {
+            CHECK(f.block_count() == filter.block_count());
+            CHECK(std::all_of(in.begin(), in.begin() + 1000,
+                              [&](const xg::guid& g) {
+                                  return f.may_contain(g);
+                              }));
+        };
+
+        xg::guid_bloom_filter copy{filter};
+        check(copy);
+        xg::guid_bloom_filter moved{std::move(copy)};
+        CHECK(copy.block_count() == 0);
+        check(moved);
+        copy = moved;
+        check(copy);
+
+        std::stringstream stream;
+        filter.save(stream);
+        const std::string saved = stream.str();
+        CHECK(saved.size() == 32 + filter.size_in_bytes());
+        check(xg::guid_bloom_filter::load(stream));
+        check(xg::guid_bloom_filter::load(saved.data(), saved.size()));
+
+        CHECK_THROWS_AS(
+            xg::guid_bloom_filter::load(saved.data(), saved.size() - 1),
+            std::system_error);
+        std::istringstream truncated{saved.substr(0, saved.size() - 1)};
+        CHECK_THROWS_AS(xg::guid_bloom_filter::load(truncated),
+                        std::system_error);
+        // A block count far larger than the data isn't allocated up front
+        std::string corrupt = saved;
+        corrupt[16 + 5] = '\x01';
+        std::istringstream corrupt_stream{corrupt};
+        CHECK_THROWS_AS(xg::guid_bloom_filter::load(corrupt_stream),
+                        std::system_error);
+        std::string garbage(96, 'x');
+        CHECK_THROWS_AS(
+            xg::guid_bloom_filter::load(garbage.data(), garbage.size()),
+            std::system_error);
+    }
+    SUBCASE("xor filter")
+    {
+        // Duplicates are stored once
+        auto with_duplicates = in;
+        with_duplicates.insert(with_duplicates.end(), in.begin(),
+                               in.begin() + 100);
+        const xg::guid_xor_filter filter{with_duplicates};
+        CHECK(filter.size() == in.size());
+        CHECK(filter.size_in_bytes() < in.size() * 124 / 100 + 33);
+        CHECK(std::all_of(in.begin(), in.end(), [&](const xg::guid& g) {
+            return filter.may_contain(g);
+        }));
+        const auto* o = out.data();
+        CHECK(false_positive_rate(filter, o, o + 10000) < 0.01);
+        CHECK(false_positive_rate(filter, o + 10000, o + 20000) < 0.01);
+
+        for (std::size_t n = 0; n < 40; ++n) {
+            const xg::guid_xor_filter small(in.begin(),
+                                            in.begin() +
+                                                static_cast<std::ptrdiff_t>(n));
+            CHECK(small.size() == n);
+            CHECK(small.empty() == (n == 0));
+            for (std::size_t i = 0; i < n; ++i) {
+                CHECK(small.may_contain(in[i]));
+            }
+        }
+        const xg::guid_xor_filter empty;
+        CHECK(!empty.may_contain(in[0]));
+        const xg::guid_xor_filter list{in[0], in[1]};
+        CHECK(list.size() == 2);
+        CHECK(list.may_contain(in[1]));
+    }
+    SUBCASE("xor filter save and load")
+    {
+        for (std::size_t n : {0u, 1u, 1000u}) {
+            const xg::guid_xor_filter filter(
+                in.begin(), in.begin() + static_cast<std::ptrdiff_t>(n));
+            std::stringstream stream;
+            filter.save(stream);
+            const std::string saved = stream.str();
+            CHECK(saved.size() == 32 + filter.size_in_bytes());
+
+            const auto check = [&](const xg::guid_xor_filter& f) {
+                CHECK(f.size() == n);
+                CHECK(f.size_in_bytes() == filter.size_in_bytes());
+                for (std::size_t i = 0; i < n; ++i) {
+                    CHECK(f.may_contain(in[i]));
+                }
+            };
+            check(xg::guid_xor_filter::load(stream));
+            check(xg::guid_xor_filter::load(saved.data(), saved.size()));
+
+            CHECK_THROWS_AS(
+                xg::guid_xor_filter::load(saved.data(), saved.size() + 1),
+                std::system_error);
+            std::istringstream truncated{saved.substr(0, saved.size() - 1)};
+            CHECK_THROWS_AS(xg::guid_xor_filter::load(truncated),
+                            std::system_error);
+            // A count far larger than the data isn't allocated up front
+            std::string corrupt = saved;
+            corrupt[16 + 5] = '\x01';
+            std::istringstream corrupt_stream{corrupt};
+            CHECK_THROWS_AS(xg::guid_xor_filter::load(corrupt_stream),
+                            std::system_error);
+        }
+        std::string garbage(64, 'x');
+        CHECK_THROWS_AS(
+            xg::guid_xor_filter::load(garbage.data(), garbage.size()),
+            std::system_error);
+    }
+}
+
+TEST_CASE("guid_column")
+{
+    const char* path = "crossguid_column_test.bin";
+    std::vector<xg::guid> v(10000);
+    xg::make_guids(v.data(), v.size());
+
+    SUBCASE("write and read")
+    {
+        {
+            xg::guid_column_writer writer{path};
+            writer.append(v[0]);
+            writer.append(v.data() + 1, v.data() + v.size());
+            CHECK(writer.size() == v.size());
+            CHECK(!writer.sorted());
+        }
+        const xg::guid_column column{path};
+        REQUIRE(column.size() == v.size());
+        CHECK(std::equal(column.begin(), column.end(), v.begin()));
+        CHECK(column[42] == v[42]);
+        CHECK(!column.sorted());
+        CHECK(column.verify());
+        CHECK(reinterpret_cast<std::uintptr_t>(column.data()) % 64 == 0);
+    }
+    SUBCASE("sorted and empty")
+    {
+        std::sort(v.begin(), v.end());
+        {
+            xg::guid_column_writer writer{path};
+            writer.close();
+        }
+        {
+            const xg::guid_column column{path};
+            CHECK(column.empty());
+            CHECK(column.sorted());
+            CHECK(column.verify());
+        }
+        {
+            xg::guid_column_writer writer{path};
+            writer.append(v.data(), v.data() + v.size());
+            writer.append(v.back());
+            CHECK(writer.sorted());
+        }
+        const xg::guid_column column{path};
+        CHECK(column.size() == v.size() + 1);
+        CHECK(column.sorted());
+        CHECK(std::binary_search(column.begin(), column.end(), v[1234]));
+    }
+    SUBCASE("append")
+    {
+        std::sort(v.begin(), v.end());
+        std::remove(path);
+        for (std::size_t i = 0; i < v.size(); i += 3000) {
+            xg::guid_column_writer writer{path, xg::column_mode::append};
+            CHECK(writer.size() == i);
+            writer.append(v.data() + i,
+                          v.data() + std::min(i + 3000, v.size()));
+        }
+        {
+            const xg::guid_column column{path};
+            REQUIRE(column.size() == v.size());
+            CHECK(std::equal(column.begin(), column.end(), v.begin()));
+            CHECK(column.sorted());
+            CHECK(column.verify());
+        }
+        {
+            xg::guid_column_writer writer{path, xg::column_mode::append};
+            writer.append(v.front());
+            CHECK(!writer.sorted());
+        }
+        const xg::guid_column column{path};
+        CHECK(column.size() == v.size() + 1);
+        CHECK(!column.sorted());
+        CHECK(column.verify());
+    }
+    SUBCASE("flush")
+    {
+        xg::guid_column_writer writer{path};
+        writer.append(v.data(), v.data() + 100);
+        writer.flush();
+        writer.append(v.data() + 100, v.data() + 200);
+        {
+            // Only the GUIDs before the flush
+            const xg::guid_column column{path};
+            CHECK(column.size() == 100);
+            CHECK(column.verify());
+        }
+        writer.close();
+        const xg::guid_column column{path};
+        CHECK(column.size() == 200);
+        CHECK(column.verify());
+    }
+    SUBCASE("invalid files")
+    {
+        {
+            xg::guid_column_writer writer{path};
+            writer.append(v.data(), v.data() + 10);
+        }
+        std::string contents;
+        {
+            std::ifstream in(path, std::ios::binary);
+            contents.assign(std::istreambuf_iterator<char>(in),
+                            std::istreambuf_iterator<char>());
+        }
+        const auto write = [&](const std::string& s) {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out << s;
+        };
+
+        // A corrupted GUID
+        auto corrupted = contents;
+        corrupted[64 + 5 * 16 + 3] ^= 1;
+        write(corrupted);
+        CHECK(!xg::guid_column{path}.verify());
+
+        // Swapped GUIDs
+        corrupted = contents;
+        std::swap_ranges(corrupted.begin() + 64, corrupted.begin() + 80,
+                         corrupted.begin() + 80);
+        write(corrupted);
+        CHECK(!xg::guid_column{path}.verify());
+
+        // Truncated
+        write(contents.substr(0, contents.size() - 1));
+        CHECK_THROWS_AS(xg::guid_column{path}, std::system_error);
+        CHECK_THROWS_AS((xg::guid_column_writer{path, xg::column_mode::append}),
+                        std::system_error);
+        write(contents.substr(0, 40));
+        CHECK_THROWS_AS(xg::guid_column{path}, std::system_error);
+
+        write(std::string(100, 'x'));
+        CHECK_THROWS_AS(xg::guid_column{path}, std::system_error);
+        CHECK_THROWS_AS((xg::guid_column_writer{path, xg::column_mode::append}),
+                        std::system_error);
+
+        CHECK_THROWS_AS(xg::guid_column{"does/not/exist"}, std::system_error);
+        CHECK_THROWS_AS(xg::guid_column_writer{"does/not/exist"},
+                        std::system_error);
+    }
+    std::remove(path);
+}
+
+TEST_CASE("guid_interner")
+{
+    const char* path = "crossguid_interner_test.bin";
+    std::vector<xg::guid> v(5000);
+    xg::make_guids(v.data(), v.size());
+
+    SUBCASE("handles")
+    {
+        xg::guid_interner interner;
+        CHECK(interner.empty());
+        for (std::size_t i = 0; i < v.size(); ++i) {
+            REQUIRE(interner.intern(v[i]) == i);
+        }
+        CHECK(interner.size() == v.size());
+        CHECK(interner.intern(v[42]) == 42);
+        CHECK(interner.size() == v.size());
+
+        xg::guid_interner::handle_type h = 7;
+        CHECK(interner.find(v[123], h));
+        CHECK(h == 123);
+        CHECK(!interner.find(xg::make_guid(), h));
+        CHECK(h == 123);
+        CHECK(interner[123] == v[123]);
+        CHECK(interner.at(4999) == v[4999]);
+        CHECK_THROWS_AS(interner.at(5000), std::out_of_range);
+
+        std::vector<xg::guid> repeated{v[3], v[1], v[3], xg::make_guid()};
+        std::vector<xg::guid_interner::handle_type> handles(repeated.size());
+        interner.intern(repeated.data(), repeated.size(), handles.data());
+        CHECK(handles[0] == 3);
+        CHECK(handles[1] == 1);
+        CHECK(handles[2] == 3);
+        CHECK(handles[3] == 5000);
+
+        std::vector<xg::guid> resolved(handles.size());
+        interner.resolve(handles.data(), handles.size(), resolved.data());
+        CHECK(resolved == repeated);
+    }
+    SUBCASE("threads")
+    {
+        // Every thread interns every GUID, in a different order: each must
+        // get one handle, the same in every thread
+        xg::guid_interner interner;
+        const std::size_t steps[] = {1, 3, 7, 9};
+        std::vector<std::vector<xg::guid_interner::handle_type>> handles(4);
+        std::vector<std::thread> threads;
+        for (std::size_t t = 0; t < handles.size(); ++t) {
+            threads.emplace_back([&, t] {
+                auto& out = handles[t];
+                out.resize(v.size());
+                for (std::size_t j = 0; j < v.size(); ++j) {
+                    const auto i = (j * steps[t] + 997 * t) % v.size();
+                    out[i] = interner.intern(v[i]);
+                    if (interner[out[i]] != v[i]) {
+                        out[i] = 0xffffffff;
+                    }
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        CHECK(interner.size() == v.size());
+        for (std::size_t t = 1; t < handles.size(); ++t) {
+            CHECK(handles[t] == handles[0]);
+        }
+        auto sorted = handles[0];
+        std::sort(sorted.begin(), sorted.end());
+        for (std::size_t i = 0; i < sorted.size(); ++i) {
+            REQUIRE(sorted[i] == i);
+        }
+    }
+    SUBCASE("snapshots")
+    {
+        {
+            xg::guid_interner interner;
+            std::vector<xg::guid_interner::handle_type> handles(v.size());
+            interner.intern(v.data(), 3000, handles.data());
+            interner.save(path);
+
+            // Only the GUIDs interned since are appended
+            interner.intern(v.data(), v.size(), handles.data());
+            xg::guid_column_writer writer{path, xg::column_mode::append};
+            CHECK(writer.size() == 3000);
+            interner.save(writer);
+            CHECK(writer.size() == v.size());
+        }
+        {
+            const xg::guid_column column{path};
+            CHECK(column.verify());
+            xg::guid_interner restored{column};
+            CHECK(restored.size() == v.size());
+            for (std::size_t i = 0; i < v.size(); ++i) {
+                REQUIRE(restored.intern(v[i]) == i);
+                REQUIRE(restored[static_cast<std::uint32_t>(i)] == v[i]);
+            }
+            const auto g = xg::make_guid();
+            CHECK(restored.intern(g) == v.size());
+            CHECK(restored[5000] == g);
+
+            xg::guid_interner smaller;
+            smaller.intern(v[0]);
+            xg::guid_column_writer writer{path, xg::column_mode::append};
+            CHECK_THROWS_AS(smaller.save(writer), std::system_error);
+        }
+        {
+            xg::guid_column_writer writer{path};
+            writer.append(v[0]);
+            writer.append(v[1]);
+            writer.append(v[0]);
+        }
+        const xg::guid_column column{path};
+        CHECK_THROWS_AS(xg::guid_interner{column}, std::system_error);
+    }
+    std::remove(path);
+}
+
+TEST_CASE("guid_pool")
+{
+    const auto wait_for_size = [](const xg::guid_pool& pool, std::size_t n) {
+        for (int i = 0; i < 10000 && pool.size() < n; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return pool.size() >= n;
+    };
+
+    SUBCASE("refill")
+    {
+        xg::guid_pool_options options;
+        options.capacity = 100;
+        options.low_watermark = 32;
+        options.high_watermark = 96;
+        xg::guid_pool pool{options};
+        CHECK(wait_for_size(pool, 96));
+        CHECK(pool.size() == 96);
+
+        std::vector<xg::guid> taken;
+        for (int i = 0; i < 64; ++i) {
+            xg::guid g;
+            REQUIRE(pool.try_get(g));
+            taken.push_back(g);
+        }
+        // Below the low watermark, so refilled to the high one
+        xg::guid g;
+        REQUIRE(pool.try_get(g));
+        taken.push_back(g);
+        CHECK(wait_for_size(pool, 96));
+
+        for (int i = 0; i < 1000; ++i) {
+            taken.push_back(pool.get());
+        }
+        for (const auto& t : taken) {
+            CHECK(t);
+        }
+        std::sort(taken.begin(), taken.end());
+        CHECK(std::adjacent_find(taken.begin(), taken.end()) == taken.end());
+
+        const auto stats = pool.stats();
+        CHECK(stats.hits + stats.misses == taken.size());
+        CHECK(stats.refills >= 2);
+        CHECK(stats.refilled >= stats.hits);
+        CHECK(stats.refill_time.count() > 0);
+    }
+    SUBCASE("empty")
+    {
+        xg::guid_pool_options options;
+        options.capacity = 16;
+        options.low_watermark = 0;
+        options.high_watermark = 0;
+        xg::guid_pool pool{options};
+        xg::guid g;
+        CHECK(!pool.try_get(g));
+        CHECK(pool.get());
+        CHECK(pool.size() == 0);
+        CHECK(pool.stats().hits == 0);
+        CHECK(pool.stats().misses == 1);
+    }
+    SUBCASE("threads")
+    {
+        xg::guid_pool_options options;
+        options.capacity = 256;
+        options.low_watermark = 128;
+        options.high_watermark = 256;
+        xg::guid_pool pool{options};
+
+        std::vector<std::vector<xg::guid>> taken(4);
+        std::vector<std::thread> threads;
+        for (auto& t : taken) {
+            threads.emplace_back([&pool, &t] {
+                for (int i = 0; i < 20000; ++i) {
+                    t.push_back(pool.get());
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+
+        std::vector<xg::guid> all;
+        for (const auto& t : taken) {
+            all.insert(all.end(), t.begin(), t.end());
+        }
+        std::sort(all.begin(), all.end());
+        CHECK(std::adjacent_find(all.begin(), all.end()) == all.end());
+        CHECK(std::find(all.begin(), all.end(), xg::guid{}) == all.end());
+        const auto stats = pool.stats();
+        CHECK(stats.hits + stats.misses == all.size());
+    }
+#ifndef _WIN32
+    SUBCASE("fork")
+    {
+        // The child must not hand out the GUIDs buffered in the parent
+        std::unique_ptr<xg::guid_pool> pool{new xg::guid_pool};
+        REQUIRE(wait_for_size(*pool, 4096));
+
+        int fds[2];
+        REQUIRE(::pipe(fds) == 0);
+        const pid_t pid = ::fork();
+        REQUIRE(pid >= 0);
+        if (pid == 0) {
+            ::close(fds[0]);
+            xg::guid g;
+            bool ok = !pool->try_get(g);
+            std::vector<xg::guid> taken(1000);
+            for (auto& t : taken) {
+                t = pool->get();
+            }
+            // Mustn't join the parent's refill thread, or hang on its mutex
+            pool.reset();
+            const auto size = taken.size() * sizeof(xg::guid);
+            ok = ok && ::write(fds[1], taken.data(), size) ==
+                           static_cast<ssize_t>(size);
+            ::_exit(ok ? 0 : 1);
+        }
+        ::close(fds[1]);
+        std::vector<xg::guid> child(1000);
+        auto* p = reinterpret_cast<char*>(child.data());
+        std::size_t left = child.size() * sizeof(xg::guid);
+        while (left > 0) {
+            const auto r = ::read(fds[0], p, left);
+            if (r <= 0) {
+                break;
+            }
+            p += r;
+            left -= static_cast<std::size_t>(r);
+        }
+        ::close(fds[0]);
+        int status = 0;
+        REQUIRE(::waitpid(pid, &status, 0) == pid);
+        CHECK(WIFEXITED(status));
+        CHECK(WEXITSTATUS(status) == 0);
+        REQUIRE(left == 0);
+
+        std::vector<xg::guid> parent(1000);
+        for (auto& g : parent) {
+            g = pool->get();
+        }
+        std::sort(child.begin(), child.end());
+        std::sort(parent.begin(), parent.end());
+        std::vector<xg::guid> both;
+        std::set_intersection(child.begin(), child.end(), parent.begin(),
+                              parent.end(), std::back_inserter(both));
+        CHECK(both.empty());
+        CHECK(pool->stats().hits >= parent.size());
+    }
+#endif
+}
+
+TEST_CASE("concurrent_guid_map")
+{
+    SUBCASE("single thread")
+    {
+        xg::concurrent_guid_map<std::string> m;
+        CHECK(m.empty());
+        CHECK(m.bucket_count() >= 1);
+
+        const auto a = xg::make_guid();
+        const auto b = xg::make_guid();
+        CHECK(m.insert(a, "a"));
+        CHECK(!m.insert(a, "other"));
+        CHECK(m.insert(b, std::string("b")));
+        CHECK(m.size() == 2);
+
+        std::string value;
+        CHECK(m.find(a, value));
+        CHECK(value == "a");
+        CHECK(m.contains(b));
+        CHECK(!m.contains(xg::make_guid()));
+        CHECK(!m.find(xg::guid{}, value));
+        CHECK(value == "a");
+
+        CHECK(!m.insert_or_assign(a, "A"));
+        CHECK(m.visit(a, [](const std::string& v) { CHECK(v == "A"); }));
+        CHECK(m.size() == 2);
+
+        CHECK(m.erase(a));
+        CHECK(!m.erase(a));
+        CHECK(!m.contains(a));
+        CHECK(m.insert_or_assign(a, "again"));
+        CHECK(m.size() == 2);
+
+        int calls = 0;
+        const auto make = [&calls] {
+            ++calls;
+            return std::string("made");
+        };
+        CHECK(m.find_or_insert(b, make) == "b");
+        const auto c = xg::make_guid();
+        CHECK(m.find_or_insert(c, make) == "made");
+        CHECK(m.find_or_insert(c, make) == "made");
+        CHECK(calls == 1);
+        CHECK(m.size() == 3);
+    }
+    SUBCASE("growth")
+    {
+        xg::concurrent_guid_map<int, xg::mix_hash> m;
+        const auto initial = m.bucket_count();
+        std::vector<xg::guid> keys(100000);
+        xg::make_guids(keys.data(), keys.size());
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            REQUIRE(m.insert(keys[i], static_cast<int>(i)));
+        }
+        CHECK(m.size() == keys.size());
+        CHECK(m.bucket_count() > initial);
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            int value = -1;
+            REQUIRE(m.find(keys[i], value));
+            REQUIRE(value == static_cast<int>(i));
+        }
+        for (std::size_t i = 0; i < keys.size(); i += 2) {
+            REQUIRE(m.erase(keys[i]));
+        }
+        CHECK(m.size() == keys.size() / 2);
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            REQUIRE(m.contains(keys[i]) == (i % 2 == 1));
+        }
+    }
+    SUBCASE("threads")
+    {
+        // Readers check that every key they see has the value of its
+        // writer, while writers insert, assign and erase their own keys
+        // and the map grows
+        xg::concurrent_guid_map<std::vector<int>> m;
+        const std::size_t writers = 4;
+        const std::size_t per_writer = 20000;
+        std::vector<xg::guid> keys(writers * per_writer);
+        xg::make_guids(keys.data(), keys.size());
+
+        std::atomic<bool> done{false};
+        std::atomic<std::size_t> bad{0};
+        std::vector<std::thread> threads;
+        for (std::size_t w = 0; w < writers; ++w) {
+            threads.emplace_back([&, w] {
+                const int tag = static_cast<int>(w);
+                for (std::size_t i = w * per_writer; i < (w + 1) * per_writer;
+                     ++i) {
+                    if (!m.insert(keys[i], std::vector<int>(4, tag))) {
+                        ++bad;
+                    }
+                    if (i % 3 == 0 &&
+                        m.insert_or_assign(keys[i], std::vector<int>(8, tag))) {
+                        ++bad;
+                    }
+                    if (i % 5 == 0 && !m.erase(keys[i])) {
+                        ++bad;
+                    }
+                }
+            });
+        }
+        for (int r = 0; r < 2; ++r) {
+            threads.emplace_back([&] {
+                while (!done.load()) {
+                    for (std::size_t i = 0; i < keys.size(); i += 7) {
+                        const int tag = static_cast<int>(i / per_writer);
+                        m.visit(keys[i], [&](const std::vector<int>& v) {
+                            if (v.size() < 4 ||
+                                std::count(v.begin(), v.end(), tag) !=
+                                    static_cast<std::ptrdiff_t>(v.size())) {
+                                ++bad;
+                            }
+                        });
+                    }
+                }
+            });
+        }
+        for (std::size_t w = 0; w < writers; ++w) {
+            threads[w].join();
+        }
+        done = true;
+        for (std::size_t t = writers; t < threads.size(); ++t) {
+            threads[t].join();
+        }
+
+        CHECK(bad == 0);
+        std::size_t expected = 0;
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            std::vector<int> v;
+            const bool found = m.find(keys[i], v);
+            REQUIRE(found == (i % 5 != 0));
+            if (found) {
+                expected++;
+                REQUIRE(v.size() == (i % 3 == 0 ? 8u : 4u));
+            }
+        }
+        CHECK(m.size() == expected);
+    }
+}
+
 TEST_CASE("errors")
 {
     xg::guid empty{};
@@ -184,4 +2525,206 @@ TEST_CASE("errors")
         CHECK(bad_string == empty);
         CHECK(!bad_string);
     }
+    SUBCASE("bad character")
+    {
+        const std::string str = "7bcd757f-5b10-4f9b-af69-1a1f226f3b3e";
+        for (std::size_t i = 0; i < str.size(); ++i) {
+            for (char ch : {'g', 'G', '/', ':', '@', '`', ' ', '\x80'}) {
+                auto bad = str;
+                bad[i] = ch;
+                CHECK(xg::guid{bad.c_str()} == empty);
+            }
+        }
+    }
+    SUBCASE("misplaced hyphen")
+    {
+        xg::guid g("7bcd757f5-b10-4f9b-af69-1a1f226f3b3e");
+        CHECK(g == xg::guid{"7bcd757f-5b10-4f9b-af69-1a1f226f3b3e"});
+        xg::guid bad("7bcd757f--b10-4f9b-af69-1a1f226f3b3e");
+        CHECK(bad == empty);
+    }
+}
+
+TEST_CASE("parse")
+{
+    const xg::guid expected{"7bcd757f-5b10-4f9b-af69-1a1f226f3b3e"};
+    auto parse = [](const std::string& s, xg::parse_mode mode) {
+        return xg::parse(s.data(), s.data() + s.size(), mode);
+    };
+    auto check_ok = [&](const std::string& s, xg::parse_mode mode,
+                        std::size_t consumed) {
+        const auto r = parse(s, mode);
+        CHECK(r);
+        CHECK(r.ec == std::errc{});
+        CHECK(r.value == expected);
+        CHECK(r.ptr == s.data() + consumed);
+    };
+    auto check_error = [&](const std::string& s, xg::parse_mode mode) {
+        const auto r = parse(s, mode);
+        CHECK_FALSE(r);
+        CHECK(r.ec == std::errc::invalid_argument);
+        CHECK(r.ptr == s.data());
+        CHECK_FALSE(r.value);
+    };
+
+    SUBCASE("strict")
+    {
+        const auto m = xg::parse_mode::strict;
+        check_ok("7bcd757f-5b10-4f9b-af69-1a1f226f3b3e", m, 36);
+        check_ok("7BCD757F-5B10-4F9B-AF69-1A1F226F3B3E", m, 36);
+        check_ok("7bcd757f-5b10-4f9b-af69-1a1f226f3b3e trailing", m, 36);
+        check_error("7bcd757f-5b10-4f9b-af69-1a1f226f3b3", m);
+        check_error("7bcd757f5b104f9baf691a1f226f3b3e", m);
+        check_error("{7bcd757f-5b10-4f9b-af69-1a1f226f3b3e}", m);
+        check_error("", m);
+    }
+    SUBCASE("braced")
+    {
+        const auto m = xg::parse_mode::braced;
+        check_ok("{7bcd757f-5b10-4f9b-af69-1a1f226f3b3e}", m, 38);
+        check_ok("{7bcd757f-5b10-4f9b-af69-1a1f226f3b3e},", m, 38);
+        check_error("{7bcd757f-5b10-4f9b-af69-1a1f226f3b3e", m);
+        check_error("7bcd757f-5b10-4f9b-af69-1a1f226f3b3e}", m);
+        check_error("{7bcd757f-5b10-4f9b-af69-1a1f226f3b3e)", m);
+    }
+    SUBCASE("urn")
+    {
+        const auto m = xg::parse_mode::urn;
+        check_ok("urn:uuid:7bcd757f-5b10-4f9b-af69-1a1f226f3b3e", m, 45);
+        check_ok("URN:UUID:7bcd757f-5b10-4f9b-af69-1a1f226f3b3e", m, 45);
+        check_error("urn:uid:7bcd757f-5b10-4f9b-af69-1a1f226f3b3e", m);
+        check_error("urn:uuid:", m);
+        check_error(
+            std::string("urn\x1auuid:7bcd757f-5b10-4f9b-af69-1a1f226f3b3e"), m);
+    }
+    SUBCASE("lenient")
+    {
+        const auto m = xg::parse_mode::lenient;
+        check_ok("7bcd757f-5b10-4f9b-af69-1a1f226f3b3e", m, 36);
+        check_ok("7bcd757f5b104f9baf691a1f226f3b3e", m, 32);
+        check_ok("-7b-cd757f5b104f9baf691a1f226f3b3e--", m, 34);
+        check_ok("{7bcd757f5b104f9baf691a1f226f3b3e}", m, 34);
+        check_ok("urn:uuid:7bcd757f5b104f9baf691a1f226f3b3e", m, 41);
+        check_ok("7bcd757f5b104f9baf691a1f226f3b3e0", m, 32);
+        check_error("7bcd757f5b104f9baf691a1f226f3b3", m);
+        check_error("{7bcd757f5b104f9baf691a1f226f3b3e", m);
+        check_error("7bcd757f 5b104f9baf691a1f226f3b3e", m);
+    }
+    SUBCASE("nil is not an error")
+    {
+        const std::string nil = "00000000-0000-0000-0000-000000000000";
+        const auto r = parse(nil, xg::parse_mode::strict);
+        CHECK(r);
+        CHECK_FALSE(r.value);
+        CHECK(r.ptr == nil.data() + nil.size());
+    }
+    SUBCASE("unterminated buffer")
+    {
+        // Exactly 36 characters on the heap, so that AddressSanitizer
+        // catches any read past them
+        const std::string text = expected.str();
+        std::unique_ptr<char[]> buf{new char[text.size()]};
+        std::copy(text.begin(), text.end(), buf.get());
+        for (auto mode : {xg::parse_mode::strict, xg::parse_mode::lenient}) {
+            const auto r = xg::parse(buf.get(), buf.get() + text.size(), mode);
+            CHECK(r.value == expected);
+            CHECK(r.ptr == buf.get() + text.size());
+        }
+        CHECK_FALSE(
+            xg::parse(buf.get(), buf.get() + text.size() - 1).value);
+    }
+    SUBCASE("strings")
+    {
+        CHECK(xg::parse(expected.str()).value == expected);
+        CHECK(xg::parse(std::string{"{" + expected.str() + "}"},
+                        xg::parse_mode::braced)
+                  .value == expected);
+#if defined(__cpp_lib_string_view)
+        const std::string_view list = "7bcd757f-5b10-4f9b-af69-1a1f226f3b3e,"
+                                      "00000000-0000-0000-0000-000000000000";
+        const auto first = xg::parse(list);
+        CHECK(first.value == expected);
+        CHECK(*first.ptr == ',');
+        CHECK(xg::parse(list.substr(37)));
+#endif
+    }
+}
+
+TEST_CASE("compile-time parsing")
+{
+    using namespace xg::literals;
+
+#if XG_HAS_RELAXED_CONSTEXPR
+    constexpr auto g = "7bcd757f-5b10-4f9b-af69-1a1f226f3b3e"_guid;
+    static_assert(g.bytes()[0] == 0x7b && g.bytes()[15] == 0x3e,
+                  "literal parsed at compile time");
+    static_assert(g.version() == 4, "literal parsed at compile time");
+    static_assert(
+        xg::v7_timestamp("01890A5D-AC96-774B-BCCE-B302099A8057"_guid) ==
+            0x01890a5dac96,
+        "literal parsed at compile time");
+    static_assert(xg::make_guid_from_string("7bcd757f", 8).bytes()[0] == 0,
+                  "malformed input is nil");
+    CHECK(g == xg::guid{"7bcd757f-5b10-4f9b-af69-1a1f226f3b3e"});
+#endif
+
+    SUBCASE("same as runtime parsing")
+    {
+        const std::string inputs[] = {
+            "7bcd757f-5b10-4f9b-af69-1a1f226f3b3e",
+            "7BCD757F-5B10-4F9B-AF69-1A1F226F3B3E",
+            "7bcd757f5b104f9baf691a1f226f3b3e",
+            "-7b-cd757f5b104f9baf691a1f226f3b3e--",
+            "7bcd757f-5b10-4f9b-af69-1a1f226f3b3",
+            "7bcd757f-5b10-4f9b-af69-1a1f226f3b3e0",
+            "7bcd757f-5b10-4f9b-af69-1a1f226f3b3g",
+            "{7bcd757f-5b10-4f9b-af69-1a1f226f3b3e}",
+            ""};
+        for (const auto& s : inputs) {
+            CHECK(xg::make_guid_from_string(s.data(), s.size()) ==
+                  xg::guid{s.c_str()});
+        }
+    }
+}
+
+TEST_CASE("parsing")
+{
+    const auto str = "7bcd757f-5b10-4f9b-af69-1a1f226f3b3e";
+    const auto expected = xg::guid{std::array<unsigned char, 16>{
+        {0x7b, 0xcd, 0x75, 0x7f, 0x5b, 0x10, 0x4f, 0x9b, 0xaf, 0x69, 0x1a,
+         0x1f, 0x22, 0x6f, 0x3b, 0x3e}}};
+
+    SUBCASE("canonical")
+    {
+        CHECK(xg::guid{str} == expected);
+        CHECK(xg::guid{"7BCD757F-5B10-4F9B-AF69-1A1F226F3B3E"} == expected);
+        CHECK(xg::guid{"7bCD757f-5B10-4f9B-Af69-1a1F226f3B3e"} == expected);
+    }
+    SUBCASE("lenient hyphens")
+    {
+        CHECK(xg::guid{"7bcd757f5b104f9baf691a1f226f3b3e"} == expected);
+        CHECK(xg::guid{"-7bcd-757f-5b10-4f9b-af69-1a1f-226f-3b3e-"} ==
+              expected);
+        CHECK(xg::guid{"7bcd757f-5b10-4f9b-af69-1a1f226f3b3e---"} ==
+              expected);
+    }
+    SUBCASE("round trip")
+    {
+        for (int i = 0; i < 1000; ++i) {
+            auto g = xg::make_guid();
+            CHECK(xg::guid{g.str().c_str()} == g);
+        }
+    }
+    SUBCASE("every alignment")
+    {
+        // Exercises both the vectorized path and the fallback used near the
+        // end of a memory page
+        std::vector<char> buffer(3 * 4096, 'x');
+        for (std::size_t i = 0; i < buffer.size() - 37; i += 7) {
+            std::copy(str, str + 36, buffer.data() + i);
+            buffer[i + 36] = '\0';
+            CHECK(xg::guid{buffer.data() + i} == expected);
+            buffer[i + 36] = 'x';
+        }
+    }
 }